@@ -0,0 +1,160 @@
+#include "arena.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#define ARENA_ALIGNMENT 16
+#define ARENA_DEFAULT_BLOCK_SIZE (64 * 1024)
+
+static struct ArenaBlock* new_arena_block(size_t capacity);
+static size_t align_size(size_t size);
+
+static size_t align_size(size_t size) {
+    return (size + ARENA_ALIGNMENT - 1) & ~((size_t)ARENA_ALIGNMENT - 1);
+}
+
+static struct ArenaBlock* new_arena_block(size_t capacity) {
+    struct ArenaBlock* block = (struct ArenaBlock*)malloc(sizeof(struct ArenaBlock) + ARENA_ALIGNMENT + capacity);
+    if (block == NULL) {
+        printf("Out of memory allocating arena block \n");
+        exit(1);
+    }
+
+    uintptr_t data_start = (uintptr_t)(block + 1);
+    data_start = (data_start + ARENA_ALIGNMENT - 1) & ~((uintptr_t)ARENA_ALIGNMENT - 1);
+
+    block->next = NULL;
+    block->capacity = capacity;
+    block->used = 0;
+    block->data = (char*)data_start;
+
+    return block;
+}
+
+struct Arena* new_arena(size_t block_size) {
+    struct Arena* arena = (struct Arena*)malloc(sizeof(struct Arena));
+    if (arena == NULL) {
+        printf("Out of memory allocating arena \n");
+        exit(1);
+    }
+
+    arena->head = NULL;
+    arena->spare = NULL;
+    arena->block_size = block_size != 0 ? block_size : ARENA_DEFAULT_BLOCK_SIZE;
+    arena->last_allocation = NULL;
+
+    return arena;
+}
+
+void* arena_alloc(struct Arena* arena, size_t size) {
+    size = align_size(size);
+
+    struct ArenaBlock* block = arena->head;
+    if (block == NULL || block->capacity - block->used < size) {
+        if (arena->spare != NULL && arena->spare->capacity >= size) {
+            block = arena->spare;
+            arena->spare = block->next;
+        } else {
+            size_t capacity = size > arena->block_size ? size : arena->block_size;
+            block = new_arena_block(capacity);
+        }
+        block->next = arena->head;
+        arena->head = block;
+    }
+
+    void* ptr = block->data + block->used;
+    block->used += size;
+    arena->last_allocation = ptr;
+
+    return ptr;
+}
+
+void* arena_realloc(struct Arena* arena, void* ptr, size_t old_size, size_t new_size) {
+    if (ptr == NULL) {
+        return arena_alloc(arena, new_size);
+    }
+
+    // THE MOST RECENT ALLOCATION CAN GROW IN PLACE WHEN ITS BLOCK HAS ROOM
+    struct ArenaBlock* block = arena->head;
+    if (ptr == arena->last_allocation) {
+        size_t offset = (size_t)((char*)ptr - block->data);
+        size_t aligned_size = align_size(new_size);
+        if (block->capacity - offset >= aligned_size) {
+            block->used = offset + aligned_size;
+            return ptr;
+        }
+    }
+
+    void* new_ptr = arena_alloc(arena, new_size);
+    memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+
+    return new_ptr;
+}
+
+size_t get_arena_used(const struct Arena* arena) {
+    size_t used = 0;
+    for (struct ArenaBlock* block = arena->head;block != NULL;block = block->next) {
+        used += block->used;
+    }
+
+    return used;
+}
+
+// FORGETS EVERY ALLOCATION BUT KEEPS THE BLOCKS, SO A REUSED ARENA STOPS CALLING malloc
+void reset_arena(struct Arena* arena) {
+    struct ArenaBlock* block = arena->head;
+    while (block != NULL) {
+        struct ArenaBlock* next_block = block->next;
+        block->used = 0;
+        block->next = arena->spare;
+        arena->spare = block;
+        block = next_block;
+    }
+
+    arena->head = NULL;
+    arena->last_allocation = NULL;
+}
+
+// MOVES EVERY BLOCK OF other INTO arena, WHICH FREES THEM ALONG WITH ITS OWN, AND FREES other
+void adopt_arena(struct Arena* arena, struct Arena* other) {
+    struct ArenaBlock* block = other->head;
+    while (block != NULL) {
+        struct ArenaBlock* next_block = block->next;
+        // BEHIND THE HEAD SO THE NEXT ALLOCATIONS AND arena_realloc KEEP USING arena's OWN BLOCK
+        if (arena->head == NULL) {
+            block->next = NULL;
+            arena->head = block;
+        } else {
+            block->next = arena->head->next;
+            arena->head->next = block;
+        }
+        block = next_block;
+    }
+
+    block = other->spare;
+    while (block != NULL) {
+        struct ArenaBlock* next_block = block->next;
+        block->next = arena->spare;
+        arena->spare = block;
+        block = next_block;
+    }
+
+    free(other);
+}
+
+void free_arena(struct Arena* arena) {
+    if (arena == NULL) {
+        return;
+    }
+
+    reset_arena(arena);
+    struct ArenaBlock* block = arena->spare;
+    while (block != NULL) {
+        struct ArenaBlock* next_block = block->next;
+        free(block);
+        block = next_block;
+    }
+
+    free(arena);
+}
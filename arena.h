@@ -0,0 +1,29 @@
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <stddef.h>
+
+struct ArenaBlock {
+    struct ArenaBlock* next;
+    size_t capacity;
+    size_t used;
+    char* data;
+};
+
+struct Arena {
+    struct ArenaBlock* head;
+    // BLOCKS KEPT BY reset_arena FOR THE NEXT ALLOCATIONS
+    struct ArenaBlock* spare;
+    size_t block_size;
+    void* last_allocation;
+};
+
+struct Arena* new_arena(size_t block_size);
+void* arena_alloc(struct Arena* arena, size_t size);
+void* arena_realloc(struct Arena* arena, void* ptr, size_t old_size, size_t new_size);
+size_t get_arena_used(const struct Arena* arena);
+void reset_arena(struct Arena* arena);
+void adopt_arena(struct Arena* arena, struct Arena* other);
+void free_arena(struct Arena* arena);
+
+#endif
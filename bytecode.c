@@ -0,0 +1,386 @@
+#include "bytecode.h"
+#include "arena.h"
+#include "numbers.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+static void reserve_code(struct Chunk* chunk, long length);
+static int get_stack_pops(enum OpCode op);
+static int get_stack_pushes(enum OpCode op);
+static long get_jump_target(enum OpCode op, const uint8_t* operands);
+static int verify_stack_depths(const struct Chunk* chunk, const uint8_t* is_instruction_start);
+
+struct Chunk new_chunk(void) {
+    struct Chunk chunk;
+    chunk.code = NULL;
+    chunk.code_length = 0;
+    chunk.code_capacity = 0;
+    chunk.constants = NULL;
+    chunk.constant_count = 0;
+    chunk.constant_capacity = 0;
+    chunk.slot_count = 0;
+    chunk.max_stack_depth = 0;
+    chunk.arena = new_arena(0);
+
+    return chunk;
+}
+
+void free_chunk(struct Chunk* chunk) {
+    free(chunk->code);
+    free(chunk->constants);
+    free_arena(chunk->arena);
+
+    chunk->code = NULL;
+    chunk->code_length = 0;
+    chunk->code_capacity = 0;
+    chunk->constants = NULL;
+    chunk->constant_count = 0;
+    chunk->constant_capacity = 0;
+    chunk->arena = NULL;
+}
+
+static void reserve_code(struct Chunk* chunk, long length) {
+    if (chunk->code_length + length <= chunk->code_capacity) {
+        return;
+    }
+
+    long capacity = chunk->code_capacity == 0 ? 256 : 2 * chunk->code_capacity;
+    while (capacity < chunk->code_length + length) {
+        capacity *= 2;
+    }
+
+    chunk->code = (uint8_t*)realloc(chunk->code, capacity);
+    chunk->code_capacity = capacity;
+}
+
+long emit_op(struct Chunk* chunk, enum OpCode op) {
+    reserve_code(chunk, 1);
+    chunk->code[chunk->code_length] = (uint8_t)op;
+
+    return chunk->code_length++;
+}
+
+long emit_operand(struct Chunk* chunk, int32_t operand) {
+    reserve_code(chunk, sizeof(int32_t));
+    long position = chunk->code_length;
+    memcpy(chunk->code + position, &operand, sizeof(int32_t));
+    chunk->code_length += sizeof(int32_t);
+
+    return position;
+}
+
+void patch_operand(struct Chunk* chunk, long position, int32_t operand) {
+    memcpy(chunk->code + position, &operand, sizeof(int32_t));
+}
+
+int32_t read_operand(const uint8_t* code) {
+    int32_t operand;
+    memcpy(&operand, code, sizeof(int32_t));
+
+    return operand;
+}
+
+int add_constant(struct Chunk* chunk, struct Value value) {
+    if (chunk->constant_count >= chunk->constant_capacity) {
+        int capacity = chunk->constant_capacity == 0 ? 16 : 2 * chunk->constant_capacity;
+        chunk->constants = (struct Value*)realloc(chunk->constants, capacity * sizeof(struct Value));
+        chunk->constant_capacity = capacity;
+    }
+
+    chunk->constants[chunk->constant_count] = value;
+    return chunk->constant_count++;
+}
+
+int get_operand_count(enum OpCode op) {
+    switch (op) {
+        case OP_CONSTANT:
+        case OP_LOAD:
+        case OP_STORE:
+        case OP_JUMP:
+        case OP_JUMP_IF_FALSE:
+        case OP_JUMP_IF_TRUE:
+        case OP_CONVERT:
+            return 1;
+        case OP_FOR_TEST:
+        case OP_FOR_STEP:
+            return 3;
+        default:
+            return 0;
+    }
+}
+
+const char* get_op_code_string(enum OpCode op) {
+    switch (op) {
+        case OP_CONSTANT: return "CONSTANT";
+        case OP_LOAD: return "LOAD";
+        case OP_STORE: return "STORE";
+
+        case OP_ADD: return "ADD";
+        case OP_SUBTRACT: return "SUBTRACT";
+        case OP_MULTIPLY: return "MULTIPLY";
+        case OP_DIVIDE: return "DIVIDE";
+        case OP_NEGATE: return "NEGATE";
+        case OP_NOT: return "NOT";
+        case OP_CONVERT: return "CONVERT";
+
+        case OP_EQUALS: return "EQUALS";
+        case OP_NOT_EQUALS: return "NOT_EQUALS";
+        case OP_GREATER: return "GREATER";
+        case OP_GREATER_EQUALS: return "GREATER_EQUALS";
+        case OP_LESSER: return "LESSER";
+        case OP_LESSER_EQUALS: return "LESSER_EQUALS";
+
+        case OP_JUMP: return "JUMP";
+        case OP_JUMP_IF_FALSE: return "JUMP_IF_FALSE";
+        case OP_JUMP_IF_TRUE: return "JUMP_IF_TRUE";
+
+        case OP_FOR_TEST: return "FOR_TEST";
+        case OP_FOR_STEP: return "FOR_STEP";
+
+        case OP_PRINT: return "PRINT";
+        case OP_PRINT_ZONE: return "PRINT_ZONE";
+        case OP_PRINT_NEW_LINE: return "PRINT_NEW_LINE";
+
+        case OP_HALT: return "HALT";
+    }
+
+    return "UNKNOWN OPCODE";
+}
+
+static int get_stack_pops(enum OpCode op) {
+    switch (op) {
+        case OP_STORE:
+        case OP_NEGATE:
+        case OP_NOT:
+        case OP_CONVERT:
+        case OP_JUMP_IF_FALSE:
+        case OP_JUMP_IF_TRUE:
+        case OP_PRINT:
+            return 1;
+        case OP_ADD:
+        case OP_SUBTRACT:
+        case OP_MULTIPLY:
+        case OP_DIVIDE:
+        case OP_EQUALS:
+        case OP_NOT_EQUALS:
+        case OP_GREATER:
+        case OP_GREATER_EQUALS:
+        case OP_LESSER:
+        case OP_LESSER_EQUALS:
+            return 2;
+        default:
+            return 0;
+    }
+}
+
+static int get_stack_pushes(enum OpCode op) {
+    switch (op) {
+        case OP_CONSTANT:
+        case OP_LOAD:
+        case OP_NEGATE:
+        case OP_NOT:
+        case OP_CONVERT:
+        case OP_ADD:
+        case OP_SUBTRACT:
+        case OP_MULTIPLY:
+        case OP_DIVIDE:
+        case OP_EQUALS:
+        case OP_NOT_EQUALS:
+        case OP_GREATER:
+        case OP_GREATER_EQUALS:
+        case OP_LESSER:
+        case OP_LESSER_EQUALS:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// -1 FOR AN INSTRUCTION THAT NEVER JUMPS
+static long get_jump_target(enum OpCode op, const uint8_t* operands) {
+    switch (op) {
+        case OP_JUMP:
+        case OP_JUMP_IF_FALSE:
+        case OP_JUMP_IF_TRUE:
+            return read_operand(operands);
+        case OP_FOR_TEST:
+        case OP_FOR_STEP:
+            return read_operand(operands + 2 * sizeof(int32_t));
+        default:
+            return -1;
+    }
+}
+
+// FOLLOWS EVERY PATH FROM THE FIRST INSTRUCTION. EACH JUMP MUST LAND ON AN INSTRUCTION, EVERY
+// PATH MUST REACH IT WITH THE SAME DEPTH AND NO PATH MAY GO BELOW ZERO OR ABOVE max_stack_depth,
+// WHICH IS ALL THE VM ALLOCATES
+static int verify_stack_depths(const struct Chunk* chunk, const uint8_t* is_instruction_start) {
+    int* depths = (int*)malloc(chunk->code_length * sizeof(int));
+    long* pending = (long*)malloc(chunk->code_length * sizeof(long));
+    for (long i = 0;i < chunk->code_length;i++) {
+        depths[i] = -1;
+    }
+
+    long pending_count = 0;
+    depths[0] = 0;
+    pending[pending_count++] = 0;
+
+    int valid = 1;
+    while (valid && pending_count > 0) {
+        long position = pending[--pending_count];
+        enum OpCode op = (enum OpCode)chunk->code[position];
+        const uint8_t* operands = chunk->code + position + 1;
+
+        int depth = depths[position];
+        if (depth < get_stack_pops(op)) {
+            valid = 0;
+            break;
+        }
+        depth += get_stack_pushes(op) - get_stack_pops(op);
+        if (depth > chunk->max_stack_depth) {
+            valid = 0;
+            break;
+        }
+
+        long next[2];
+        int next_count = 0;
+        if (op != OP_JUMP && op != OP_FOR_STEP && op != OP_HALT) {
+            next[next_count++] = position + 1 + get_operand_count(op) * (long)sizeof(int32_t);
+        }
+        if (get_jump_target(op, operands) >= 0) {
+            next[next_count++] = get_jump_target(op, operands);
+        }
+
+        for (int i = 0;i < next_count;i++) {
+            if (next[i] >= chunk->code_length || !is_instruction_start[next[i]]) {
+                valid = 0;
+            } else if (depths[next[i]] < 0) {
+                depths[next[i]] = depth;
+                pending[pending_count++] = next[i];
+            } else if (depths[next[i]] != depth) {
+                valid = 0;
+            }
+        }
+    }
+
+    free(depths);
+    free(pending);
+    return valid;
+}
+
+// CHECKS EVERY OPCODE, SLOT, CONSTANT, JUMP TARGET AND THE STACK DEPTH ON EVERY PATH SO THE VM
+// CAN RUN WITHOUT BOUNDS CHECKS
+int verify_chunk(const struct Chunk* chunk) {
+    if (chunk->code_length <= 0 || chunk->max_stack_depth < 0) {
+        return 0;
+    }
+
+    uint8_t* is_instruction_start = (uint8_t*)calloc(chunk->code_length, 1);
+    int valid = 1;
+    long position = 0;
+    enum OpCode op = OP_CONSTANT;
+    while (valid && position < chunk->code_length) {
+        op = (enum OpCode)chunk->code[position];
+        if (op > OP_HALT) {
+            valid = 0;
+            break;
+        }
+        is_instruction_start[position] = 1;
+
+        int operand_count = get_operand_count(op);
+        if (position + 1 + operand_count * (long)sizeof(int32_t) > chunk->code_length) {
+            valid = 0;
+            break;
+        }
+
+        const uint8_t* operands = chunk->code + position + 1;
+        switch (op) {
+            case OP_CONSTANT:
+                if (read_operand(operands) < 0 || read_operand(operands) >= chunk->constant_count) {
+                    valid = 0;
+                }
+                break;
+            case OP_LOAD:
+            case OP_STORE:
+                if (read_operand(operands) < 0 || read_operand(operands) >= chunk->slot_count) {
+                    valid = 0;
+                }
+                break;
+            case OP_JUMP:
+            case OP_JUMP_IF_FALSE:
+            case OP_JUMP_IF_TRUE:
+                if (read_operand(operands) < 0 || read_operand(operands) >= chunk->code_length) {
+                    valid = 0;
+                }
+                break;
+            case OP_CONVERT:
+                if (read_operand(operands) < INTEGER_NUMBER || read_operand(operands) > DOUBLE_NUMBER) {
+                    valid = 0;
+                }
+                break;
+            case OP_FOR_TEST:
+            case OP_FOR_STEP:
+                for (int i = 0;i < 2;i++) {
+                    int32_t slot = read_operand(operands + i * sizeof(int32_t));
+                    // THE STEP OF FOR_TEST IS THE SLOT AFTER end, COMPARED WITHOUT slot + 1 OVERFLOWING
+                    int32_t slots_after = op == OP_FOR_TEST && i == 1 ? 1 : 0;
+                    if (slot < 0 || slot >= chunk->slot_count - slots_after) {
+                        valid = 0;
+                    }
+                }
+
+                if (read_operand(operands + 2 * sizeof(int32_t)) < 0 || read_operand(operands + 2 * sizeof(int32_t)) >= chunk->code_length) {
+                    valid = 0;
+                }
+                break;
+            default:
+                break;
+        }
+
+        position += 1 + operand_count * sizeof(int32_t);
+    }
+
+    valid = valid && op == OP_HALT && verify_stack_depths(chunk, is_instruction_start);
+    free(is_instruction_start);
+    return valid;
+}
+
+void print_value(const struct Value* value) {
+    if (value->type == STRING_VALUE) {
+        printf("\"%.*s\"", (int)value->string.length, value->string.chars);
+    } else {
+        printf("%.15g", value->number);
+    }
+}
+
+void disassemble_chunk(const struct Chunk* chunk) {
+    printf(
+        "chunk: %ld bytes, %d constants, %d slots, stack depth %d \n",
+        chunk->code_length,
+        chunk->constant_count,
+        chunk->slot_count,
+        chunk->max_stack_depth
+    );
+
+    long position = 0;
+    while (position < chunk->code_length) {
+        enum OpCode op = (enum OpCode)chunk->code[position];
+        printf("%6ld %-16s", position, get_op_code_string(op));
+
+        int operand_count = get_operand_count(op);
+        for (int i = 0;i < operand_count;i++) {
+            printf(" %d", read_operand(chunk->code + position + 1 + i * sizeof(int32_t)));
+        }
+
+        if (op == OP_CONSTANT) {
+            printf("    ");
+            print_value(&chunk->constants[read_operand(chunk->code + position + 1)]);
+        } else if (op == OP_CONVERT) {
+            printf("    %s", get_number_type_string((enum NumberType)read_operand(chunk->code + position + 1)));
+        }
+
+        printf("\n");
+        position += 1 + operand_count * sizeof(int32_t);
+    }
+}
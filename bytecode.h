@@ -0,0 +1,91 @@
+#ifndef BYTECODE_H_
+#define BYTECODE_H_
+
+#include <stdint.h>
+
+// BUMPED WITH ANY CHANGE TO THE OPCODES OR TO THE CODE THE COMPILER EMITS FOR A PROGRAM
+#define BYTECODE_VERSION 2
+
+enum OpCode {
+    OP_CONSTANT,
+    OP_LOAD,
+    OP_STORE,
+
+    OP_ADD,
+    OP_SUBTRACT,
+    OP_MULTIPLY,
+    OP_DIVIDE,
+    OP_NEGATE,
+    OP_NOT,
+    // CONVERT type ROUNDS THE TOP OF THE STACK TO A NumberType BEFORE IT IS STORED
+    OP_CONVERT,
+
+    OP_EQUALS,
+    OP_NOT_EQUALS,
+    OP_GREATER,
+    OP_GREATER_EQUALS,
+    OP_LESSER,
+    OP_LESSER_EQUALS,
+
+    OP_JUMP,
+    OP_JUMP_IF_FALSE,
+    OP_JUMP_IF_TRUE,
+
+    // FOR_TEST control, end, exit READS THE STEP FROM THE SLOT AFTER end
+    OP_FOR_TEST,
+    OP_FOR_STEP,
+
+    OP_PRINT,
+    OP_PRINT_ZONE,
+    OP_PRINT_NEW_LINE,
+
+    OP_HALT,
+};
+
+enum ValueType {
+    NUMBER_VALUE,
+    STRING_VALUE,
+};
+
+struct Value {
+    enum ValueType type;
+    union {
+        double number;
+        struct {
+            const char* chars;
+            long length;
+        } string;
+    };
+};
+
+// INSTRUCTIONS ARE ONE OPCODE BYTE FOLLOWED BY ZERO TO THREE 32-BIT OPERANDS
+struct Chunk {
+    uint8_t* code;
+    long code_length;
+    long code_capacity;
+
+    struct Value* constants;
+    int constant_count;
+    int constant_capacity;
+
+    int slot_count;
+    int max_stack_depth;
+    struct Arena* arena;
+};
+
+struct Chunk new_chunk(void);
+void free_chunk(struct Chunk* chunk);
+
+long emit_op(struct Chunk* chunk, enum OpCode op);
+long emit_operand(struct Chunk* chunk, int32_t operand);
+void patch_operand(struct Chunk* chunk, long position, int32_t operand);
+int32_t read_operand(const uint8_t* code);
+int add_constant(struct Chunk* chunk, struct Value value);
+
+int get_operand_count(enum OpCode op);
+const char* get_op_code_string(enum OpCode op);
+int verify_chunk(const struct Chunk* chunk);
+void disassemble_chunk(const struct Chunk* chunk);
+void print_value(const struct Value* value);
+
+#endif
@@ -0,0 +1,287 @@
+#define _DEFAULT_SOURCE
+
+#include "cache.h"
+#include "arena.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// BUMPED WHENEVER THE ENTRY LAYOUT CHANGES
+#define CACHE_FORMAT_VERSION 1
+#define CACHE_PATH_SIZE 4096
+
+// THE MAKEFILE SETS QB_COMPILER_VERSION TO A CHECKSUM OF ALL THE SOURCES, SO ANY CHANGE TO THE
+// COMPILER OR OPTIMIZER MISSES. A BUILD WITHOUT IT ONLY HAS BYTECODE_VERSION TO TELL THEM APART
+#ifndef QB_COMPILER_VERSION
+#define QB_COMPILER_VERSION "unversioned"
+#endif
+
+static const char compiler_version[] = QB_COMPILER_VERSION;
+
+struct CacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    int64_t source_size;
+    int64_t code_length;
+    int32_t constant_count;
+    int32_t slot_count;
+    int32_t max_stack_depth;
+    int32_t reserved;
+};
+
+// AN ENTRY BEING BUILT FOR WRITING OR READ BACK, position IS ONLY USED WHILE READING
+struct CacheBuffer {
+    char* data;
+    long length;
+    long capacity;
+    long position;
+};
+
+static uint64_t hash_bytes(uint64_t hash, const void* bytes, long length);
+static void get_entry_path(const struct CompilationCache* cache, uint64_t key, char* path);
+static void append_bytes(struct CacheBuffer* buffer, const void* bytes, long length);
+static int take_bytes(struct CacheBuffer* buffer, void* bytes, long length);
+static int read_entry_file(const char* path, struct CacheBuffer* buffer);
+static int decode_chunk(struct CacheBuffer* buffer, uint64_t key, long source_size, struct Chunk* chunk);
+
+// 64-BIT FNV-1a
+static uint64_t hash_bytes(uint64_t hash, const void* bytes, long length) {
+    const unsigned char* data = (const unsigned char*)bytes;
+    for (long i = 0;i < length;i++) {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+uint64_t get_cache_key(const char* source, long size, int optimize) {
+    uint32_t version = CACHE_FORMAT_VERSION;
+    uint32_t bytecode_version = BYTECODE_VERSION;
+    unsigned char optimized = optimize != 0;
+
+    uint64_t hash = 14695981039346656037ull;
+    hash = hash_bytes(hash, &version, sizeof(version));
+    hash = hash_bytes(hash, &bytecode_version, sizeof(bytecode_version));
+    hash = hash_bytes(hash, compiler_version, sizeof(compiler_version));
+    hash = hash_bytes(hash, &optimized, sizeof(optimized));
+    return hash_bytes(hash, source, size);
+}
+
+static void get_entry_path(const struct CompilationCache* cache, uint64_t key, char* path) {
+    snprintf(path, CACHE_PATH_SIZE, "%s/%016llx.qbc", cache->directory, (unsigned long long)key);
+}
+
+static void append_bytes(struct CacheBuffer* buffer, const void* bytes, long length) {
+    if (buffer->length + length > buffer->capacity) {
+        buffer->capacity = (buffer->length + length) * 2;
+        buffer->data = (char*)realloc(buffer->data, buffer->capacity);
+        if (buffer->data == NULL) {
+            printf("Out of memory writing a cache entry \n");
+            exit(1);
+        }
+    }
+
+    memcpy(buffer->data + buffer->length, bytes, length);
+    buffer->length += length;
+}
+
+static int take_bytes(struct CacheBuffer* buffer, void* bytes, long length) {
+    if (length < 0 || length > buffer->length - buffer->position) {
+        return 0;
+    }
+
+    memcpy(bytes, buffer->data + buffer->position, length);
+    buffer->position += length;
+    return 1;
+}
+
+static int read_entry_file(const char* path, struct CacheBuffer* buffer) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return 0;
+    }
+
+    long size = -1;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        size = ftell(file);
+    }
+
+    if (size < (long)sizeof(struct CacheHeader) || fseek(file, 0, SEEK_SET) != 0) {
+        fclose(file);
+        return 0;
+    }
+
+    buffer->data = (char*)malloc(size);
+    buffer->length = (long)fread(buffer->data, 1, size, file);
+    buffer->capacity = size;
+    buffer->position = 0;
+    fclose(file);
+
+    return buffer->length == size;
+}
+
+// EVERY LENGTH IS CHECKED AGAINST THE FILE, THEN THE BYTECODE ITSELF AGAINST verify_chunk. EVERY
+// PUSH TAKES AN INSTRUCTION AND EVERY SLOT IS NAMED BY ONE, SO A DEPTH OR SLOT COUNT ABOVE THE
+// CODE LENGTH IS DAMAGE, NOT MEMORY TO ALLOCATE
+static int decode_chunk(struct CacheBuffer* buffer, uint64_t key, long source_size, struct Chunk* chunk) {
+    struct CacheHeader header;
+    if (!take_bytes(buffer, &header, sizeof(header)) || memcmp(header.magic, "QBC", 4) != 0 ||
+        header.version != CACHE_FORMAT_VERSION || header.key != key || header.source_size != source_size ||
+        header.code_length <= 0 || header.code_length > buffer->length || header.constant_count < 0 ||
+        header.constant_count > buffer->length || header.slot_count < 0 || header.slot_count > header.code_length ||
+        header.max_stack_depth < 0 || header.max_stack_depth > header.code_length) {
+        return 0;
+    }
+
+    chunk->code = (uint8_t*)malloc(header.code_length);
+    chunk->code_length = header.code_length;
+    chunk->code_capacity = header.code_length;
+    if (!take_bytes(buffer, chunk->code, header.code_length)) {
+        return 0;
+    }
+
+    chunk->constants = (struct Value*)malloc((header.constant_count + 1) * sizeof(struct Value));
+    chunk->constant_capacity = header.constant_count + 1;
+    for (int i = 0;i < header.constant_count;i++) {
+        unsigned char type;
+        struct Value* value = &chunk->constants[i];
+        if (!take_bytes(buffer, &type, sizeof(type))) {
+            return 0;
+        }
+
+        if (type == NUMBER_VALUE) {
+            value->type = NUMBER_VALUE;
+            if (!take_bytes(buffer, &value->number, sizeof(value->number))) {
+                return 0;
+            }
+        } else if (type == STRING_VALUE) {
+            int64_t length;
+            if (!take_bytes(buffer, &length, sizeof(length)) || length < 0 || length > buffer->length) {
+                return 0;
+            }
+
+            char* chars = (char*)arena_alloc(chunk->arena, length + 1);
+            if (!take_bytes(buffer, chars, length)) {
+                return 0;
+            }
+            chars[length] = 0;
+
+            value->type = STRING_VALUE;
+            value->string.chars = chars;
+            value->string.length = length;
+        } else {
+            return 0;
+        }
+
+        chunk->constant_count = i + 1;
+    }
+
+    chunk->slot_count = header.slot_count;
+    chunk->max_stack_depth = header.max_stack_depth;
+    return buffer->position == buffer->length && verify_chunk(chunk);
+}
+
+int load_cached_chunk(struct CompilationCache* cache, uint64_t key, long source_size, struct Chunk* chunk) {
+    char path[CACHE_PATH_SIZE];
+    get_entry_path(cache, key, path);
+
+    struct CacheBuffer buffer = {0};
+    *chunk = new_chunk();
+    int hit = read_entry_file(path, &buffer) && decode_chunk(&buffer, key, source_size, chunk);
+    free(buffer.data);
+
+    if (!hit) {
+        free_chunk(chunk);
+        __atomic_fetch_add(&cache->misses, 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+
+    __atomic_fetch_add(&cache->hits, 1, __ATOMIC_RELAXED);
+    return 1;
+}
+
+int store_cached_chunk(struct CompilationCache* cache, uint64_t key, long source_size, const struct Chunk* chunk) {
+    struct CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "QBC", 4);
+    header.version = CACHE_FORMAT_VERSION;
+    header.key = key;
+    header.source_size = source_size;
+    header.code_length = chunk->code_length;
+    header.constant_count = chunk->constant_count;
+    header.slot_count = chunk->slot_count;
+    header.max_stack_depth = chunk->max_stack_depth;
+
+    struct CacheBuffer buffer = {0};
+    append_bytes(&buffer, &header, sizeof(header));
+    append_bytes(&buffer, chunk->code, chunk->code_length);
+    for (int i = 0;i < chunk->constant_count;i++) {
+        const struct Value* value = &chunk->constants[i];
+        unsigned char type = (unsigned char)value->type;
+        append_bytes(&buffer, &type, sizeof(type));
+        if (value->type == NUMBER_VALUE) {
+            append_bytes(&buffer, &value->number, sizeof(value->number));
+        } else {
+            int64_t length = value->string.length;
+            append_bytes(&buffer, &length, sizeof(length));
+            append_bytes(&buffer, value->string.chars, length);
+        }
+    }
+
+    if (mkdir(cache->directory, 0777) != 0 && errno != EEXIST) {
+        perror(cache->directory);
+        free(buffer.data);
+        return 1;
+    }
+
+    // THE TEMPORARY FILE IS IN THE SAME DIRECTORY SO THE RENAME NEVER CROSSES FILE SYSTEMS
+    char path[CACHE_PATH_SIZE];
+    char temporary_path[CACHE_PATH_SIZE + 8];
+    get_entry_path(cache, key, path);
+    snprintf(temporary_path, sizeof(temporary_path), "%s.XXXXXX", path);
+
+    int fd = mkstemp(temporary_path);
+    if (fd < 0) {
+        perror(temporary_path);
+        free(buffer.data);
+        return 1;
+    }
+
+    long written = 0;
+    while (written < buffer.length) {
+        ssize_t count = write(fd, buffer.data + written, buffer.length - written);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            break;
+        }
+        written += count;
+    }
+    free(buffer.data);
+
+    // mkstemp MAKES THE FILE 0600, BUT A SHARED CACHE DIRECTORY NEEDS ENTRIES OTHER USERS CAN READ.
+    // THE DESCRIPTOR IS CLOSED WHETHER OR NOT THE WRITE AND fsync WORKED
+    int saved = written == buffer.length && fchmod(fd, 0644) == 0 && fsync(fd) == 0;
+    if (close(fd) != 0) {
+        saved = 0;
+    }
+
+    if (!saved || rename(temporary_path, path) != 0) {
+        perror(path);
+        unlink(temporary_path);
+        return 1;
+    }
+
+    __atomic_fetch_add(&cache->stores, 1, __ATOMIC_RELAXED);
+    return 0;
+}
+
+void print_cache_statistics(const struct CompilationCache* cache) {
+    printf("cache: %d hits, %d misses, %d stored \n", cache->hits, cache->misses, cache->stores);
+}
@@ -0,0 +1,24 @@
+#ifndef CACHE_H_
+#define CACHE_H_
+
+#include <stdint.h>
+#include "bytecode.h"
+
+// COMPILED CHUNKS KEPT IN A DIRECTORY, ONE FILE PER KEY. THE KEY HASHES THE SOURCE WITH THE
+// COMPILER BUILD AND THE OPTIONS THAT CHANGE THE BYTECODE, SO A HIT NEEDS NO LEXING OR PARSING
+struct CompilationCache {
+    const char* directory;
+    // COUNTED FROM ANY WORKER
+    int hits;
+    int misses;
+    int stores;
+};
+
+uint64_t get_cache_key(const char* source, long size, int optimize);
+// RETURNS 1 WITH A CHUNK THAT PASSED verify_chunk, A MISSING, STALE OR DAMAGED ENTRY IS A MISS
+int load_cached_chunk(struct CompilationCache* cache, uint64_t key, long source_size, struct Chunk* chunk);
+// WRITES A TEMPORARY FILE AND RENAMES IT, SO READERS SEE A WHOLE ENTRY OR NONE
+int store_cached_chunk(struct CompilationCache* cache, uint64_t key, long source_size, const struct Chunk* chunk);
+void print_cache_statistics(const struct CompilationCache* cache);
+
+#endif
@@ -0,0 +1,217 @@
+#include "charclass.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define CHARCLASS_X86 1
+#include <immintrin.h>
+#endif
+
+// EACH SCANNER RETURNS HOW MANY LEADING BYTES OF text BELONG TO ITS CLASS:
+// WHITESPACE IS ' ', '\t' AND '\r', ALPHA IS ASCII LETTERS, NUMBER IS DIGITS AND '.'
+
+struct CharclassImplementation {
+    const char* name;
+    long (*whitespace_run)(const char* text, long length);
+    long (*alpha_run)(const char* text, long length);
+    long (*number_run)(const char* text, long length);
+};
+
+static long scalar_whitespace_run(const char* text, long length);
+static long scalar_alpha_run(const char* text, long length);
+static long scalar_number_run(const char* text, long length);
+static const struct CharclassImplementation* select_implementation(void);
+
+static const struct CharclassImplementation scalar_implementation = {
+    "scalar", scalar_whitespace_run, scalar_alpha_run, scalar_number_run
+};
+
+// READ AND WRITTEN ATOMICALLY, LEXER THREADS MAY ALL SELECT AT ONCE
+static const struct CharclassImplementation* implementation = NULL;
+
+static int is_whitespace_char(unsigned char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\r';
+}
+
+static int is_alpha_char(unsigned char ch) {
+    return (unsigned char)((ch | 0x20) - 'a') < 26;
+}
+
+static int is_number_char(unsigned char ch) {
+    return (unsigned char)(ch - '0') < 10 || ch == '.';
+}
+
+static long scalar_whitespace_run(const char* text, long length) {
+    long i = 0;
+    while (i < length && is_whitespace_char((unsigned char)text[i])) {
+        i++;
+    }
+
+    return i;
+}
+
+static long scalar_alpha_run(const char* text, long length) {
+    long i = 0;
+    while (i < length && is_alpha_char((unsigned char)text[i])) {
+        i++;
+    }
+
+    return i;
+}
+
+static long scalar_number_run(const char* text, long length) {
+    long i = 0;
+    while (i < length && is_number_char((unsigned char)text[i])) {
+        i++;
+    }
+
+    return i;
+}
+
+#ifdef CHARCLASS_X86
+
+// THE MASKS HAVE A BIT SET FOR EVERY BYTE INSIDE THE CLASS, THE RUN ENDS AT
+// THE FIRST CLEAR BIT
+
+static __m128i sse2_whitespace_mask(__m128i chunk) {
+    return _mm_or_si128(
+        _mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')),
+        _mm_or_si128(
+            _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t')),
+            _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r'))
+        )
+    );
+}
+
+static __m128i sse2_alpha_mask(__m128i chunk) {
+    __m128i offset = _mm_sub_epi8(_mm_or_si128(chunk, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    return _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8(25)), offset);
+}
+
+static __m128i sse2_number_mask(__m128i chunk) {
+    __m128i offset = _mm_sub_epi8(chunk, _mm_set1_epi8('0'));
+    return _mm_or_si128(
+        _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8(9)), offset),
+        _mm_cmpeq_epi8(chunk, _mm_set1_epi8('.'))
+    );
+}
+
+#define DEFINE_SSE2_RUN(class_name)                                                     \
+    static long sse2_##class_name##_run(const char* text, long length) {                \
+        long i = 0;                                                                     \
+        while (i + 16 <= length) {                                                      \
+            __m128i chunk = _mm_loadu_si128((const __m128i*)(text + i));                \
+            unsigned int mask = (unsigned int)_mm_movemask_epi8(sse2_##class_name##_mask(chunk)); \
+            if (mask != 0xFFFF) {                                                       \
+                return i + __builtin_ctz(~mask);                                        \
+            }                                                                           \
+            i += 16;                                                                    \
+        }                                                                               \
+        return i + scalar_##class_name##_run(text + i, length - i);                     \
+    }
+
+DEFINE_SSE2_RUN(whitespace)
+DEFINE_SSE2_RUN(alpha)
+DEFINE_SSE2_RUN(number)
+
+__attribute__((target("avx2")))
+static __m256i avx2_whitespace_mask(__m256i chunk) {
+    return _mm256_or_si256(
+        _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')),
+        _mm256_or_si256(
+            _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t')),
+            _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r'))
+        )
+    );
+}
+
+__attribute__((target("avx2")))
+static __m256i avx2_alpha_mask(__m256i chunk) {
+    __m256i offset = _mm256_sub_epi8(_mm256_or_si256(chunk, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(offset, _mm256_set1_epi8(25)), offset);
+}
+
+__attribute__((target("avx2")))
+static __m256i avx2_number_mask(__m256i chunk) {
+    __m256i offset = _mm256_sub_epi8(chunk, _mm256_set1_epi8('0'));
+    return _mm256_or_si256(
+        _mm256_cmpeq_epi8(_mm256_min_epu8(offset, _mm256_set1_epi8(9)), offset),
+        _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('.'))
+    );
+}
+
+#define DEFINE_AVX2_RUN(class_name)                                                     \
+    __attribute__((target("avx2")))                                                     \
+    static long avx2_##class_name##_run(const char* text, long length) {                \
+        long i = 0;                                                                     \
+        while (i + 32 <= length) {                                                      \
+            __m256i chunk = _mm256_loadu_si256((const __m256i*)(text + i));             \
+            unsigned int mask = (unsigned int)_mm256_movemask_epi8(avx2_##class_name##_mask(chunk)); \
+            if (mask != 0xFFFFFFFFu) {                                                  \
+                return i + __builtin_ctz(~mask);                                        \
+            }                                                                           \
+            i += 32;                                                                    \
+        }                                                                               \
+        return i + sse2_##class_name##_run(text + i, length - i);                       \
+    }
+
+DEFINE_AVX2_RUN(whitespace)
+DEFINE_AVX2_RUN(alpha)
+DEFINE_AVX2_RUN(number)
+
+static const struct CharclassImplementation sse2_implementation = {
+    "sse2", sse2_whitespace_run, sse2_alpha_run, sse2_number_run
+};
+
+static const struct CharclassImplementation avx2_implementation = {
+    "avx2", avx2_whitespace_run, avx2_alpha_run, avx2_number_run
+};
+
+#endif
+
+static const struct CharclassImplementation* select_implementation(void) {
+    const struct CharclassImplementation* current = __atomic_load_n(&implementation, __ATOMIC_ACQUIRE);
+    if (current != NULL) {
+        return current;
+    }
+
+    // QB_CHARCLASS=scalar|sse2|avx2 PINS AN IMPLEMENTATION FOR BENCHMARKING. THREADS RACING
+    // THROUGH HERE ALL PICK AND STORE THE SAME ONE
+    const char* requested = getenv("QB_CHARCLASS");
+    const struct CharclassImplementation* selected = &scalar_implementation;
+
+#ifdef CHARCLASS_X86
+    __builtin_cpu_init();
+    int has_avx2 = __builtin_cpu_supports("avx2");
+
+    if (requested == NULL) {
+        selected = has_avx2 ? &avx2_implementation : &sse2_implementation;
+    } else if (strcmp(requested, "sse2") == 0) {
+        selected = &sse2_implementation;
+    } else if (strcmp(requested, "avx2") == 0) {
+        // SSE2 IS PART OF x86-64, SO IT IS THE NEXT BEST WITHOUT AVX2
+        selected = has_avx2 ? &avx2_implementation : &sse2_implementation;
+    }
+#else
+    (void)requested;
+#endif
+
+    __atomic_store_n(&implementation, selected, __ATOMIC_RELEASE);
+    return selected;
+}
+
+long scan_whitespace_run(const char* text, long length) {
+    return select_implementation()->whitespace_run(text, length);
+}
+
+long scan_alpha_run(const char* text, long length) {
+    return select_implementation()->alpha_run(text, length);
+}
+
+long scan_number_run(const char* text, long length) {
+    return select_implementation()->number_run(text, length);
+}
+
+const char* get_charclass_implementation_name(void) {
+    return select_implementation()->name;
+}
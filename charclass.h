@@ -0,0 +1,10 @@
+#ifndef CHARCLASS_H_
+#define CHARCLASS_H_
+
+long scan_whitespace_run(const char* text, long length);
+long scan_alpha_run(const char* text, long length);
+long scan_number_run(const char* text, long length);
+
+const char* get_charclass_implementation_name(void);
+
+#endif
@@ -0,0 +1,573 @@
+#include "codegen_c.h"
+#include "variable_types.h"
+#include "interner.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+struct CGenerator {
+    FILE* out;
+    const char* source;
+    struct VariableTypes types;
+    int depth;
+    int block_count;
+
+    struct ConstStringExpression* string_constants;
+    int string_constant_count;
+    int string_constant_capacity;
+};
+
+static void write_indent(struct CGenerator* generator);
+static void write_number(struct CGenerator* generator, double value);
+static void write_string_bytes(FILE* out, const char* chars, long length);
+static int add_string_constant(struct CGenerator* generator, struct ConstStringExpression* value);
+static const char* get_comparison_operator(struct AstNode* node);
+static void type_error(struct CGenerator* generator, struct AstNode* node);
+static void write_variable(struct CGenerator* generator, int slot);
+static const char* get_variable_c_type(struct CGenerator* generator, int slot);
+
+static void write_expression(struct CGenerator* generator, struct AstNode* node);
+static void write_integer_expression(struct CGenerator* generator, struct AstNode* node);
+static void write_assigned_value(struct CGenerator* generator, int slot, struct AstNode* expression);
+static void write_condition(struct CGenerator* generator, struct AstNode* node);
+
+static void write_statements(struct CGenerator* generator, struct StatementsList* list);
+static void write_statement(struct CGenerator* generator, struct AstNode* node);
+static void write_print_statement(struct CGenerator* generator, struct PrintStatement* statement);
+static void write_if_statement(struct CGenerator* generator, struct AstNode* node);
+static void write_loop_statement(struct CGenerator* generator, struct LoopStatement* statement);
+static void write_for_statement(struct CGenerator* generator, struct ForStatement* statement);
+
+static void write_indent(struct CGenerator* generator) {
+    for (int i = 0;i < generator->depth;i++) {
+        fputs("    ", generator->out);
+    }
+}
+
+static void write_number(struct CGenerator* generator, double value) {
+    if (isnan(value)) {
+        fputs("NAN", generator->out);
+        return;
+    }
+
+    if (isinf(value)) {
+        fputs(value < 0 ? "(-HUGE_VAL)" : "HUGE_VAL", generator->out);
+        return;
+    }
+
+    // %.17g ROUND TRIPS EVERY DOUBLE, THE ".0" KEEPS INTEGRAL VALUES DOUBLE TYPED
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.17g", value);
+    int is_integral = strpbrk(buffer, ".e") == NULL;
+    fprintf(generator->out, value < 0 ? "(%s%s)" : "%s%s", buffer, is_integral ? ".0" : "");
+}
+
+static void write_string_bytes(FILE* out, const char* chars, long length) {
+    fputc('"', out);
+    for (long i = 0;i < length;i++) {
+        unsigned char c = (unsigned char)chars[i];
+        if (c >= 0x20 && c < 0x7f && c != '"' && c != '\\' && c != '?') {
+            fputc(c, out);
+        } else {
+            fprintf(out, "\\%03o", c);
+        }
+    }
+    fputc('"', out);
+}
+
+static int add_string_constant(struct CGenerator* generator, struct ConstStringExpression* value) {
+    if (generator->string_constant_count == generator->string_constant_capacity) {
+        generator->string_constant_capacity = generator->string_constant_capacity == 0 ? 16 : generator->string_constant_capacity * 2;
+        generator->string_constants = (struct ConstStringExpression*)realloc(generator->string_constants,
+            generator->string_constant_capacity * sizeof(struct ConstStringExpression));
+    }
+
+    generator->string_constants[generator->string_constant_count] = *value;
+    return generator->string_constant_count++;
+}
+
+static const char* get_comparison_operator(struct AstNode* node) {
+    if (node->node_type != INFIX_EXPRESSION) {
+        return NULL;
+    }
+
+    switch (node->infix_expression.operator->token_type)
+    {
+    case EQUALS:
+        return "==";
+    case NOT_EQUALS:
+        return "!=";
+    case GREATER_THAN:
+        return ">";
+    case GREATER_EQUALS:
+        return ">=";
+    case LESSER_THAN:
+        return "<";
+    case LESSER_EQUALS:
+        return "<=";
+    default:
+        return NULL;
+    }
+}
+
+static void type_error(struct CGenerator* generator, struct AstNode* node) {
+    struct Token* operator = NULL;
+    if (node->node_type == INFIX_EXPRESSION) {
+        operator = node->infix_expression.operator;
+    } else if (node->node_type == PREFIX_EXPRESSION) {
+        operator = node->prefix_expression.operator;
+    }
+
+    if (operator != NULL) {
+        printf("Type mismatch at row %d \n", get_source_position(generator->source, get_token_start(operator)).row);
+    } else {
+        printf("Type mismatch \n");
+    }
+    exit(602);
+}
+
+static void write_variable(struct CGenerator* generator, int slot) {
+    // TYPE SUFFIXES ARE NOT VALID IN C NAMES, a% BECOMES v_a_i
+    const struct InternedIdentifier* identifier = get_interned_identifier(get_slot_identifier(generator->types.symbols, slot));
+    const char* suffix = "";
+    long length = identifier->length;
+    switch (identifier->name[length - 1])
+    {
+    case '%': suffix = "_i"; length--; break;
+    case '&': suffix = "_l"; length--; break;
+    case '!': suffix = "_s"; length--; break;
+    case '#': suffix = "_d"; length--; break;
+    case '$': suffix = "_str"; length--; break;
+    default: break;
+    }
+
+    fprintf(generator->out, "v_%.*s%s", (int)length, identifier->name, suffix);
+}
+
+static const char* get_variable_c_type(struct CGenerator* generator, int slot) {
+    if (generator->types.types[slot] == STRING_VARIABLE) {
+        return "const struct QbString*";
+    }
+
+    if (generator->types.integer_bits[slot] > 0) {
+        return generator->types.number_types[slot] == INTEGER_NUMBER ? "int32_t" : "int64_t";
+    }
+
+    return "double";
+}
+
+// EVERY INTEGER EXPRESSION STAYS BELOW 2^53, SO 64 BIT ARITHMETIC NEVER OVERFLOWS
+// AND GIVES EXACTLY WHAT THE FLOATING POINT BACKENDS COMPUTE
+static void write_integer_expression(struct CGenerator* generator, struct AstNode* node) {
+    FILE* out = generator->out;
+
+    switch (node->node_type)
+    {
+    case CONST_NUMBER_EXPRESSION:
+        fprintf(out, node->const_number_expression.value.integer < 0 ? "(%lldLL)" : "%lldLL",
+            (long long)node->const_number_expression.value.integer);
+        return;
+    case IDENTIFIER_EXPRESSION:
+        if (generator->types.number_types[node->identifier_expression.slot] == INTEGER_NUMBER) {
+            fputs("(int64_t)", out);
+        }
+        write_variable(generator, node->identifier_expression.slot);
+        return;
+    case PREFIX_EXPRESSION:
+        fputs(node->prefix_expression.operator->token_type == MINUS ? "(-" : "(~", out);
+        write_integer_expression(generator, node->prefix_expression.value);
+        fputc(')', out);
+        return;
+    case INFIX_EXPRESSION:
+        break;
+    default:
+        printf("Node %d is not an expression \n", node->node_type);
+        exit(603);
+    }
+
+    if (get_comparison_operator(node) != NULL) {
+        fputs("(-(int64_t)(", out);
+        write_condition(generator, node);
+        fputs("))", out);
+        return;
+    }
+
+    enum TokenType operator = node->infix_expression.operator->token_type;
+    fputc('(', out);
+    write_integer_expression(generator, node->infix_expression.left);
+    fputs(operator == PLUS ? " + " : operator == MINUS ? " - " : " * ", out);
+    write_integer_expression(generator, node->infix_expression.right);
+    fputc(')', out);
+}
+
+static void write_expression(struct CGenerator* generator, struct AstNode* node) {
+    FILE* out = generator->out;
+
+    // INTEGER ARITHMETIC IS LOWERED TO int64_t AND CONVERTED ONCE WHERE A DOUBLE IS NEEDED
+    if ((node->node_type == PREFIX_EXPRESSION || node->node_type == IDENTIFIER_EXPRESSION ||
+        (node->node_type == INFIX_EXPRESSION && get_comparison_operator(node) == NULL)) &&
+        get_integer_bits(&generator->types, node) > 0) {
+        fputs("(double)", out);
+        write_integer_expression(generator, node);
+        return;
+    }
+
+    switch (node->node_type)
+    {
+    case CONST_NUMBER_EXPRESSION:
+        write_number(generator, get_number_as_double(node->const_number_expression.value));
+        return;
+    case CONST_STRING_EXPRESSION:
+        fprintf(out, "QB_STRING(qb_string_%d)", add_string_constant(generator, &node->const_string_expression));
+        return;
+    case IDENTIFIER_EXPRESSION:
+        write_variable(generator, node->identifier_expression.slot);
+        return;
+    case PREFIX_EXPRESSION:
+        if (get_expression_type(&generator->types, node->prefix_expression.value) != NUMBER_VARIABLE) {
+            type_error(generator, node);
+        }
+
+        fputs(node->prefix_expression.operator->token_type == MINUS ? "(-" : "((double)~(long long)", out);
+        write_expression(generator, node->prefix_expression.value);
+        fputc(')', out);
+        return;
+    case INFIX_EXPRESSION:
+        break;
+    default:
+        printf("Node %d is not an expression \n", node->node_type);
+        exit(603);
+    }
+
+    struct AstNode* left = node->infix_expression.left;
+    struct AstNode* right = node->infix_expression.right;
+    enum TokenType operator = node->infix_expression.operator->token_type;
+    enum VariableType type = get_expression_type(&generator->types, left);
+    if (type != get_expression_type(&generator->types, right)) {
+        type_error(generator, node);
+    }
+
+    const char* comparison = get_comparison_operator(node);
+    if (comparison != NULL) {
+        fputc('(', out);
+        write_condition(generator, node);
+        fputs(" ? -1.0 : 0.0)", out);
+        return;
+    }
+
+    if (type == STRING_VARIABLE) {
+        if (operator != PLUS) {
+            type_error(generator, node);
+        }
+
+        fputs("qb_concatenate_strings(", out);
+        write_expression(generator, left);
+        fputs(", ", out);
+        write_expression(generator, right);
+        fputc(')', out);
+        return;
+    }
+
+    if (operator == SLASH) {
+        fputs("qb_divide(", out);
+        write_expression(generator, left);
+        fputs(", ", out);
+        write_expression(generator, right);
+        fputc(')', out);
+        return;
+    }
+
+    fputc('(', out);
+    write_expression(generator, left);
+    fputs(operator == PLUS ? " + " : operator == MINUS ? " - " : " * ", out);
+    write_expression(generator, right);
+    fputc(')', out);
+}
+
+static void write_condition(struct CGenerator* generator, struct AstNode* node) {
+    // COMPARISONS STAY PLAIN C COMPARISONS SO GCC SEES THE LOOP BOUNDS
+    FILE* out = generator->out;
+    const char* comparison = get_comparison_operator(node);
+    if (comparison == NULL) {
+        if (get_expression_type(&generator->types, node) != NUMBER_VARIABLE) {
+            type_error(generator, node);
+        }
+
+        write_expression(generator, node);
+        fputs(" != 0", out);
+        return;
+    }
+
+    struct AstNode* left = node->infix_expression.left;
+    struct AstNode* right = node->infix_expression.right;
+    enum VariableType type = get_expression_type(&generator->types, left);
+    if (type != get_expression_type(&generator->types, right)) {
+        type_error(generator, node);
+    }
+
+    if (type == STRING_VARIABLE) {
+        fputs("qb_compare_strings(", out);
+        write_expression(generator, left);
+        fputs(", ", out);
+        write_expression(generator, right);
+        fprintf(out, ") %s 0", comparison);
+        return;
+    }
+
+    if (get_integer_bits(&generator->types, left) > 0 && get_integer_bits(&generator->types, right) > 0) {
+        write_integer_expression(generator, left);
+        fprintf(out, " %s ", comparison);
+        write_integer_expression(generator, right);
+        return;
+    }
+
+    write_expression(generator, left);
+    fprintf(out, " %s ", comparison);
+    write_expression(generator, right);
+}
+
+static void write_assigned_value(struct CGenerator* generator, int slot, struct AstNode* expression) {
+    if (generator->types.integer_bits[slot] == 0) {
+        // A SINGLE IS STORED AS A double LIKE IN THE VM, ONLY ASSIGNMENTS ROUND IT
+        int rounds = needs_number_conversion(&generator->types, slot, expression);
+        fputs(rounds ? "(double)(float)(" : "", generator->out);
+        write_expression(generator, expression);
+        fputs(rounds ? ")" : "", generator->out);
+    } else if (!needs_number_conversion(&generator->types, slot, expression)) {
+        write_integer_expression(generator, expression);
+    } else {
+        fputs(generator->types.number_types[slot] == INTEGER_NUMBER ? "qb_to_integer(" : "qb_to_long(", generator->out);
+        write_expression(generator, expression);
+        fputc(')', generator->out);
+    }
+}
+
+static void write_print_statement(struct CGenerator* generator, struct PrintStatement* statement) {
+    if (statement->expressions.size == 0) {
+        write_indent(generator);
+        fputs("qb_print_new_line();\n", generator->out);
+        return;
+    }
+
+    for (long i = 0;i < statement->expressions.size;i++) {
+        struct AstNode* expression = &statement->expressions.expressions[i];
+        write_indent(generator);
+        fputs(get_expression_type(&generator->types, expression) == STRING_VARIABLE
+            ? "qb_print_string(" : "qb_print_number(", generator->out);
+        write_expression(generator, expression);
+        fputs(");\n", generator->out);
+
+        if (statement->separators[i] == COMMA) {
+            write_indent(generator);
+            fputs("qb_print_zone();\n", generator->out);
+        } else if (statement->separators[i] == NEW_LINE) {
+            write_indent(generator);
+            fputs("qb_print_new_line();\n", generator->out);
+        }
+    }
+}
+
+static void write_if_statement(struct CGenerator* generator, struct AstNode* node) {
+    long branch_count = 1 + (node->if_statement.elses != NULL ? node->if_statement.elses->size : 0);
+
+    write_indent(generator);
+    struct IfStatement* branch = &node->if_statement;
+    for (long i = 0;i < branch_count;i++) {
+        if (i > 0) {
+            branch = &node->if_statement.elses->statements[i - 1].if_statement;
+            fputs(" else ", generator->out);
+        }
+
+        if (branch->condition_expression != NULL) {
+            fputs("if (", generator->out);
+            write_condition(generator, branch->condition_expression);
+            fputs(") ", generator->out);
+        }
+        fputs("{\n", generator->out);
+
+        generator->depth++;
+        write_statements(generator, branch->body);
+        generator->depth--;
+
+        write_indent(generator);
+        fputc('}', generator->out);
+    }
+    fputc('\n', generator->out);
+}
+
+static void write_loop_statement(struct CGenerator* generator, struct LoopStatement* statement) {
+    int is_until = statement->loop_type_token->token_type == UNTIL_KEYWORD;
+
+    write_indent(generator);
+    fputs(is_until ? "while (!(" : "while (", generator->out);
+    write_condition(generator, statement->condition_expression);
+    fputs(is_until ? ")) {\n" : ") {\n", generator->out);
+
+    generator->depth++;
+    write_statements(generator, statement->body);
+    generator->depth--;
+
+    write_indent(generator);
+    fputs("}\n", generator->out);
+}
+
+static void write_for_statement(struct CGenerator* generator, struct ForStatement* statement) {
+    int control = statement->control_identifier_expression->identifier_expression.slot;
+    struct AstNode* end = statement->end_value_expression;
+    struct AstNode* step = statement->step_expression;
+    int block = generator->block_count++;
+    // AN INTEGER CONTROL VARIABLE COUNTS WITH INTEGER BOUNDS, THE TYPE PASS GUARANTEES THEY ARE INTEGERS
+    const char* bound_type = generator->types.integer_bits[control] > 0 ? "int64_t" : "double";
+
+    write_indent(generator);
+    write_variable(generator, control);
+    fputs(" = ", generator->out);
+    write_assigned_value(generator, control, statement->initial_expression);
+    fputs(";\n", generator->out);
+
+    // THE END AND STEP ARE EVALUATED ONCE BEFORE THE FIRST ITERATION
+    write_indent(generator);
+    fputs("{\n", generator->out);
+    generator->depth++;
+
+    write_indent(generator);
+    fprintf(generator->out, "const %s end_%d = ", bound_type, block);
+    write_assigned_value(generator, control, end);
+    fputs(";\n", generator->out);
+
+    write_indent(generator);
+    fprintf(generator->out, "const %s step_%d = ", bound_type, block);
+    if (step != NULL) {
+        write_assigned_value(generator, control, step);
+    } else if (generator->types.integer_bits[control] > 0) {
+        fputs("1", generator->out);
+    } else {
+        write_number(generator, 1);
+    }
+    fputs(";\n", generator->out);
+
+    write_indent(generator);
+    fputs("for (; ", generator->out);
+    if (step == NULL || (step->node_type == CONST_NUMBER_EXPRESSION && get_number_as_double(step->const_number_expression.value) >= 0)) {
+        fputs("!(", generator->out);
+        write_variable(generator, control);
+        fprintf(generator->out, " > end_%d)", block);
+    } else if (step->node_type == CONST_NUMBER_EXPRESSION) {
+        fputs("!(", generator->out);
+        write_variable(generator, control);
+        fprintf(generator->out, " < end_%d)", block);
+    } else {
+        fprintf(generator->out, "(step_%d >= 0 ? !(", block);
+        write_variable(generator, control);
+        fprintf(generator->out, " > end_%d) : !(", block);
+        write_variable(generator, control);
+        fprintf(generator->out, " < end_%d))", block);
+    }
+    fputs("; ", generator->out);
+    write_variable(generator, control);
+    fprintf(generator->out, " += step_%d) {\n", block);
+
+    generator->depth++;
+    write_statements(generator, statement->body);
+    generator->depth--;
+
+    write_indent(generator);
+    fputs("}\n", generator->out);
+
+    generator->depth--;
+    write_indent(generator);
+    fputs("}\n", generator->out);
+}
+
+static void write_statement(struct CGenerator* generator, struct AstNode* node) {
+    switch (node->node_type) {
+        case ASSIGN_STATEMENT: {
+            int slot = node->assign_statement.identifier->identifier_expression.slot;
+            write_indent(generator);
+            write_variable(generator, slot);
+            fputs(" = ", generator->out);
+            write_assigned_value(generator, slot, node->assign_statement.expression);
+            fputs(";\n", generator->out);
+            return;
+        }
+        case PRINT_STATEMENT:
+            write_print_statement(generator, &node->print_statement);
+            return;
+        case IF_STATEMENT:
+            write_if_statement(generator, node);
+            return;
+        case LOOP_STATEMENT:
+            write_loop_statement(generator, &node->loop_statement);
+            return;
+        case FOR_STATEMENT:
+            write_for_statement(generator, &node->for_statement);
+            return;
+        case DEF_TYPE_STATEMENT:
+            return;
+        default:
+            printf("Node %d is not a statement \n", node->node_type);
+            exit(604);
+    }
+}
+
+static void write_statements(struct CGenerator* generator, struct StatementsList* list) {
+    if (list == NULL) {
+        return;
+    }
+
+    for (long i = 0;i < list->size;i++) {
+        write_statement(generator, &list->statements[i]);
+    }
+}
+
+void generate_c_source(struct Program* program, FILE* out) {
+    // THE BODY GOES TO A TEMPORARY FILE FIRST, THE STRING CONSTANTS IT USES ARE DECLARED ABOVE IT
+    FILE* body = tmpfile();
+    if (body == NULL) {
+        perror("tmpfile");
+        exit(601);
+    }
+
+    struct CGenerator generator;
+    memset(&generator, 0, sizeof(generator));
+    generator.out = body;
+    generator.source = program->source;
+    generator.types = infer_variable_types(program);
+    generator.depth = 1;
+
+    write_statements(&generator, program->list);
+
+    fputs("#include <math.h>\n#include \"runtime.h\"\n\n", out);
+    fputs("#define QB_STRING(constant) ((const struct QbString*)&(constant))\n\n", out);
+    for (int i = 0;i < generator.string_constant_count;i++) {
+        struct ConstStringExpression* value = &generator.string_constants[i];
+        fprintf(out, "static const struct { long length; char chars[%ld]; } qb_string_%d = { %ld, ",
+            value->length + 1, i, value->length);
+        write_string_bytes(out, value->value, value->length);
+        fputs(" };\n", out);
+    }
+
+    // LOCALS RATHER THAN GLOBALS, SO GCC CAN KEEP THEM IN REGISTERS ACROSS THE RUNTIME CALLS
+    fputs("\nvoid qb_program(void) {\n", out);
+    generator.out = out;
+    for (int i = 0;i < generator.types.count;i++) {
+        fprintf(out, "    %s ", get_variable_c_type(&generator, i));
+        write_variable(&generator, i);
+        fputs(generator.types.types[i] == STRING_VARIABLE ? " = &qb_empty_string;\n" : " = 0;\n", out);
+    }
+    fputc('\n', out);
+
+    rewind(body);
+    char buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), body)) > 0) {
+        fwrite(buffer, 1, read, out);
+    }
+    fclose(body);
+
+    fputs("}\n", out);
+
+    free_variable_types(&generator.types);
+    free(generator.string_constants);
+}
@@ -0,0 +1,10 @@
+#ifndef CODEGEN_C_H_
+#define CODEGEN_C_H_
+
+#include <stdio.h>
+#include "parser.h"
+
+// WRITES C11 DEFINING qb_program(), COMPILE IT TOGETHER WITH runtime.c
+void generate_c_source(struct Program* program, FILE* out);
+
+#endif
@@ -0,0 +1,1027 @@
+#include "codegen_x86.h"
+#include "variable_types.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+
+// %xmm0..%xmm13 HOLD EXPRESSION TEMPORARIES BY DEPTH, %xmm14 AND %xmm15 ARE SCRATCH
+#define NUMBER_REGISTER_COUNT 14
+#define LOOP_REGISTER_COUNT 5
+#define LOOP_BODY_WEIGHT 8
+
+// CALLEE SAVED, SO LOOP VARIABLES SURVIVE THE RUNTIME CALLS MADE BY PRINT
+static const char* loop_register_names[LOOP_REGISTER_COUNT] = { "%rbx", "%r12", "%r13", "%r14", "%r15" };
+
+struct X86Generator {
+    FILE* out;
+    const char* source;
+    int label_count;
+
+    struct VariableTypes types;
+    int* variable_registers;
+    int variable_count;
+    int register_owners[LOOP_REGISTER_COUNT];
+
+    uint64_t* number_constants;
+    int number_constant_count;
+    int number_constant_capacity;
+
+    struct ConstStringExpression* string_constants;
+    int string_constant_count;
+    int string_constant_capacity;
+
+    int hidden_slot_count;
+};
+
+struct LoopRegisters {
+    int slots[LOOP_REGISTER_COUNT];
+    int count;
+};
+
+static void emit(struct X86Generator* generator, const char* format, ...) __attribute__((format(printf, 2, 3)));
+static void emit_label(struct X86Generator* generator, int label);
+static int new_label(struct X86Generator* generator);
+static int add_number_constant(struct X86Generator* generator, double value);
+static int add_string_constant(struct X86Generator* generator, struct ConstStringExpression* value);
+static void type_error(struct X86Generator* generator, struct AstNode* node, const char* message);
+
+static void count_expression(struct AstNode* node, long* counts, long weight);
+static void count_statements(struct StatementsList* list, long* counts, long weight);
+static struct LoopRegisters enter_loop(struct X86Generator* generator, struct StatementsList* body,
+    struct AstNode* condition, int control_slot);
+static void leave_loop(struct X86Generator* generator, struct LoopRegisters* loop_registers);
+
+static void load_variable(struct X86Generator* generator, int slot, int reg);
+static void store_variable(struct X86Generator* generator, int slot, int reg);
+static void store_integer_variable(struct X86Generator* generator, int slot);
+static int is_relational_operator(enum TokenType type);
+static void compile_number_operands(struct X86Generator* generator, struct AstNode* left, struct AstNode* right,
+    int reg, char* right_operand, size_t right_operand_size);
+static void compile_division_check(struct X86Generator* generator, struct AstNode* right, char* right_operand,
+    size_t right_operand_size);
+static void compile_string_comparison(struct X86Generator* generator, struct AstNode* node, int reg);
+static void compile_number(struct X86Generator* generator, struct AstNode* node, int reg);
+static void compile_string(struct X86Generator* generator, struct AstNode* node);
+static void compile_branch(struct X86Generator* generator, struct AstNode* node, int jump_when_true, int label);
+static void compile_converted_number(struct X86Generator* generator, int slot, struct AstNode* expression);
+static void compile_integer_value(struct X86Generator* generator, int slot, struct AstNode* expression);
+static int compile_integer_operand(struct X86Generator* generator, int slot, struct AstNode* expression,
+    char* operand, size_t operand_size);
+static void compile_assigned_value(struct X86Generator* generator, int slot, struct AstNode* expression);
+
+static void compile_statements(struct X86Generator* generator, struct StatementsList* list);
+static void compile_statement(struct X86Generator* generator, struct AstNode* node);
+static void compile_print_statement(struct X86Generator* generator, struct PrintStatement* statement);
+static void compile_if_statement(struct X86Generator* generator, struct AstNode* node);
+static void compile_loop_statement(struct X86Generator* generator, struct LoopStatement* statement);
+static void compile_for_statement(struct X86Generator* generator, struct ForStatement* statement);
+static void compile_integer_for_statement(struct X86Generator* generator, struct ForStatement* statement);
+static void write_data_sections(struct X86Generator* generator);
+
+static void emit(struct X86Generator* generator, const char* format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    fputs("    ", generator->out);
+    vfprintf(generator->out, format, arguments);
+    fputc('\n', generator->out);
+    va_end(arguments);
+}
+
+static void emit_label(struct X86Generator* generator, int label) {
+    fprintf(generator->out, ".L%d:\n", label);
+}
+
+static int new_label(struct X86Generator* generator) {
+    return generator->label_count++;
+}
+
+static int add_number_constant(struct X86Generator* generator, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    for (int i = 0;i < generator->number_constant_count;i++) {
+        if (generator->number_constants[i] == bits) {
+            return i;
+        }
+    }
+
+    if (generator->number_constant_count == generator->number_constant_capacity) {
+        generator->number_constant_capacity = generator->number_constant_capacity == 0 ? 16 : generator->number_constant_capacity * 2;
+        generator->number_constants = (uint64_t*)realloc(generator->number_constants,
+            generator->number_constant_capacity * sizeof(uint64_t));
+    }
+
+    generator->number_constants[generator->number_constant_count] = bits;
+    return generator->number_constant_count++;
+}
+
+static int add_string_constant(struct X86Generator* generator, struct ConstStringExpression* value) {
+    if (generator->string_constant_count == generator->string_constant_capacity) {
+        generator->string_constant_capacity = generator->string_constant_capacity == 0 ? 16 : generator->string_constant_capacity * 2;
+        generator->string_constants = (struct ConstStringExpression*)realloc(generator->string_constants,
+            generator->string_constant_capacity * sizeof(struct ConstStringExpression));
+    }
+
+    generator->string_constants[generator->string_constant_count] = *value;
+    return generator->string_constant_count++;
+}
+
+static void type_error(struct X86Generator* generator, struct AstNode* node, const char* message) {
+    struct Token* token = NULL;
+    if (node->node_type == INFIX_EXPRESSION) {
+        token = node->infix_expression.operator;
+    } else if (node->node_type == PREFIX_EXPRESSION) {
+        token = node->prefix_expression.operator;
+    } else if (node->node_type == IDENTIFIER_EXPRESSION) {
+        token = node->identifier_expression.token;
+    }
+
+    if (token != NULL) {
+        printf("%s at row %d \n", message, get_source_position(generator->source, get_token_start(token)).row);
+    } else {
+        printf("%s \n", message);
+    }
+    exit(502);
+}
+
+static void count_expression(struct AstNode* node, long* counts, long weight) {
+    if (node == NULL) {
+        return;
+    }
+
+    switch (node->node_type)
+    {
+    case IDENTIFIER_EXPRESSION:
+        counts[node->identifier_expression.slot] += weight;
+        break;
+    case PREFIX_EXPRESSION:
+        count_expression(node->prefix_expression.value, counts, weight);
+        break;
+    case INFIX_EXPRESSION:
+        count_expression(node->infix_expression.left, counts, weight);
+        count_expression(node->infix_expression.right, counts, weight);
+        break;
+    default:
+        break;
+    }
+}
+
+static void count_statements(struct StatementsList* list, long* counts, long weight) {
+    if (list == NULL) {
+        return;
+    }
+
+    for (long i = 0;i < list->size;i++) {
+        struct AstNode* node = &list->statements[i];
+        switch (node->node_type)
+        {
+        case ASSIGN_STATEMENT:
+            count_expression(node->assign_statement.identifier, counts, weight);
+            count_expression(node->assign_statement.expression, counts, weight);
+            break;
+        case PRINT_STATEMENT:
+            for (long j = 0;j < node->print_statement.expressions.size;j++) {
+                count_expression(&node->print_statement.expressions.expressions[j], counts, weight);
+            }
+            break;
+        case IF_STATEMENT:
+            count_expression(node->if_statement.condition_expression, counts, weight);
+            count_statements(node->if_statement.body, counts, weight);
+            count_statements(node->if_statement.elses, counts, weight);
+            break;
+        case LOOP_STATEMENT:
+            count_expression(node->loop_statement.condition_expression, counts, weight * LOOP_BODY_WEIGHT);
+            count_statements(node->loop_statement.body, counts, weight * LOOP_BODY_WEIGHT);
+            break;
+        case FOR_STATEMENT:
+            count_expression(node->for_statement.control_identifier_expression, counts, weight * LOOP_BODY_WEIGHT);
+            count_expression(node->for_statement.initial_expression, counts, weight);
+            count_expression(node->for_statement.end_value_expression, counts, weight);
+            count_expression(node->for_statement.step_expression, counts, weight);
+            count_statements(node->for_statement.body, counts, weight * LOOP_BODY_WEIGHT);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+static struct LoopRegisters enter_loop(struct X86Generator* generator, struct StatementsList* body,
+    struct AstNode* condition, int control_slot) {
+    // THE MOST USED NUMBER VARIABLES OF THE LOOP MOVE INTO FREE CALLEE SAVED REGISTERS
+    // UNTIL IT EXITS, THE CONTROL VARIABLE OF A FOR LOOP ALWAYS GOES FIRST
+    struct LoopRegisters loop_registers;
+    loop_registers.count = 0;
+
+    long* counts = (long*)calloc(generator->variable_count + 1, sizeof(long));
+    count_statements(body, counts, 1);
+    count_expression(condition, counts, 1);
+    if (control_slot >= 0) {
+        counts[control_slot] = LONG_MAX;
+    }
+
+    for (int reg = 0;reg < LOOP_REGISTER_COUNT;reg++) {
+        if (generator->register_owners[reg] != -1) {
+            continue;
+        }
+
+        int best = -1;
+        for (int i = 0;i < generator->variable_count;i++) {
+            if (counts[i] == 0 || generator->variable_registers[i] != -1 ||
+                generator->types.types[i] != NUMBER_VARIABLE) {
+                continue;
+            }
+
+            if (best == -1 || counts[i] > counts[best]) {
+                best = i;
+            }
+        }
+
+        if (best == -1) {
+            break;
+        }
+
+        counts[best] = 0;
+        generator->register_owners[reg] = best;
+        generator->variable_registers[best] = reg;
+        loop_registers.slots[loop_registers.count++] = best;
+        emit(generator, "movq .Lvar_%d(%%rip), %s", best, loop_register_names[reg]);
+    }
+
+    free(counts);
+    return loop_registers;
+}
+
+static void leave_loop(struct X86Generator* generator, struct LoopRegisters* loop_registers) {
+    for (int i = 0;i < loop_registers->count;i++) {
+        int slot = loop_registers->slots[i];
+        int reg = generator->variable_registers[slot];
+        emit(generator, "movq %s, .Lvar_%d(%%rip)", loop_register_names[reg], slot);
+
+        generator->register_owners[reg] = -1;
+        generator->variable_registers[slot] = -1;
+    }
+}
+
+static void load_variable(struct X86Generator* generator, int slot, int reg) {
+    // VARIABLES THAT ONLY HOLD INTEGERS ARE KEPT AS int64_t
+    int loop_register = generator->variable_registers[slot];
+    if (generator->types.integer_bits[slot] > 0) {
+        if (loop_register != -1) {
+            emit(generator, "cvtsi2sdq %s, %%xmm%d", loop_register_names[loop_register], reg);
+        } else {
+            emit(generator, "cvtsi2sdq .Lvar_%d(%%rip), %%xmm%d", slot, reg);
+        }
+    } else if (loop_register != -1) {
+        emit(generator, "movq %s, %%xmm%d", loop_register_names[loop_register], reg);
+    } else {
+        emit(generator, "movsd .Lvar_%d(%%rip), %%xmm%d", slot, reg);
+    }
+}
+
+static void store_variable(struct X86Generator* generator, int slot, int reg) {
+    int loop_register = generator->variable_registers[slot];
+    if (loop_register != -1) {
+        emit(generator, "movq %%xmm%d, %s", reg, loop_register_names[loop_register]);
+    } else {
+        emit(generator, "movsd %%xmm%d, .Lvar_%d(%%rip)", reg, slot);
+    }
+}
+
+static void store_integer_variable(struct X86Generator* generator, int slot) {
+    int loop_register = generator->variable_registers[slot];
+    if (loop_register != -1) {
+        emit(generator, "movq %%rax, %s", loop_register_names[loop_register]);
+    } else {
+        emit(generator, "movq %%rax, .Lvar_%d(%%rip)", slot);
+    }
+}
+
+static int is_relational_operator(enum TokenType type) {
+    return type >= EQUALS && type <= LESSER_EQUALS;
+}
+
+static void compile_number_operands(struct X86Generator* generator, struct AstNode* left, struct AstNode* right,
+    int reg, char* right_operand, size_t right_operand_size) {
+    // LEAVES THE LEFT OPERAND IN %xmm<reg> AND NAMES THE RIGHT ONE IN right_operand,
+    // CONSTANTS AND VARIABLES IN MEMORY ARE USED AS MEMORY OPERANDS DIRECTLY
+    compile_number(generator, left, reg);
+
+    if (right->node_type == CONST_NUMBER_EXPRESSION) {
+        snprintf(right_operand, right_operand_size, ".LN%d(%%rip)",
+            add_number_constant(generator, get_number_as_double(right->const_number_expression.value)));
+        return;
+    }
+
+    if (right->node_type == IDENTIFIER_EXPRESSION) {
+        int slot = right->identifier_expression.slot;
+        if (generator->variable_registers[slot] == -1 && generator->types.integer_bits[slot] == 0) {
+            snprintf(right_operand, right_operand_size, ".Lvar_%d(%%rip)", slot);
+        } else {
+            load_variable(generator, slot, 15);
+            snprintf(right_operand, right_operand_size, "%%xmm15");
+        }
+        return;
+    }
+
+    if (reg + 1 < NUMBER_REGISTER_COUNT) {
+        compile_number(generator, right, reg + 1);
+        snprintf(right_operand, right_operand_size, "%%xmm%d", reg + 1);
+        return;
+    }
+
+    // OUT OF TEMPORARIES, THE LEFT OPERAND WAITS ON THE STACK
+    emit(generator, "subq $16, %%rsp");
+    emit(generator, "movsd %%xmm%d, (%%rsp)", reg);
+    compile_number(generator, right, reg);
+    emit(generator, "movapd %%xmm%d, %%xmm15", reg);
+    emit(generator, "movsd (%%rsp), %%xmm%d", reg);
+    emit(generator, "addq $16, %%rsp");
+    snprintf(right_operand, right_operand_size, "%%xmm15");
+}
+
+static void compile_division_check(struct X86Generator* generator, struct AstNode* right, char* right_operand,
+    size_t right_operand_size) {
+    if (right->node_type == CONST_NUMBER_EXPRESSION && get_number_as_double(right->const_number_expression.value) != 0) {
+        return;
+    }
+
+    if (right_operand[0] != '%') {
+        emit(generator, "movsd %s, %%xmm15", right_operand);
+        snprintf(right_operand, right_operand_size, "%%xmm15");
+    }
+
+    emit(generator, "xorpd %%xmm14, %%xmm14");
+    emit(generator, "ucomisd %%xmm14, %s", right_operand);
+    emit(generator, "jp 1f");
+    emit(generator, "je .Ldivision_by_zero");
+    fputs("1:\n", generator->out);
+}
+
+static void compile_string_comparison(struct X86Generator* generator, struct AstNode* node, int reg) {
+    // THE RUNTIME CALL CLOBBERS EVERY %xmm REGISTER, SAVE THE LIVE TEMPORARIES BELOW reg
+    int save_size = (reg * 8 + 15) & ~15;
+    if (save_size > 0) {
+        emit(generator, "subq $%d, %%rsp", save_size);
+        for (int i = 0;i < reg;i++) {
+            emit(generator, "movsd %%xmm%d, %d(%%rsp)", i, i * 8);
+        }
+    }
+
+    compile_string(generator, node->infix_expression.left);
+    emit(generator, "subq $16, %%rsp");
+    emit(generator, "movq %%rax, (%%rsp)");
+    compile_string(generator, node->infix_expression.right);
+    emit(generator, "movq %%rax, %%rsi");
+    emit(generator, "movq (%%rsp), %%rdi");
+    emit(generator, "addq $16, %%rsp");
+    emit(generator, "call qb_compare_strings@PLT");
+
+    const char* condition = "e";
+    switch (node->infix_expression.operator->token_type)
+    {
+    case EQUALS:
+        condition = "e";
+        break;
+    case NOT_EQUALS:
+        condition = "ne";
+        break;
+    case GREATER_THAN:
+        condition = "g";
+        break;
+    case GREATER_EQUALS:
+        condition = "ge";
+        break;
+    case LESSER_THAN:
+        condition = "l";
+        break;
+    case LESSER_EQUALS:
+        condition = "le";
+        break;
+    default:
+        type_error(generator, node, "Type mismatch");
+    }
+
+    emit(generator, "cmpl $0, %%eax");
+    emit(generator, "set%s %%al", condition);
+    emit(generator, "movzbl %%al, %%eax");
+    emit(generator, "negq %%rax");
+    emit(generator, "cvtsi2sdq %%rax, %%xmm%d", reg);
+
+    if (save_size > 0) {
+        for (int i = 0;i < reg;i++) {
+            emit(generator, "movsd %d(%%rsp), %%xmm%d", i * 8, i);
+        }
+        emit(generator, "addq $%d, %%rsp", save_size);
+    }
+}
+
+static void compile_number(struct X86Generator* generator, struct AstNode* node, int reg) {
+    switch (node->node_type)
+    {
+    case CONST_NUMBER_EXPRESSION:
+        emit(generator, "movsd .LN%d(%%rip), %%xmm%d", add_number_constant(generator, get_number_as_double(node->const_number_expression.value)), reg);
+        return;
+    case IDENTIFIER_EXPRESSION:
+        if (get_expression_type(&generator->types, node) != NUMBER_VARIABLE) {
+            type_error(generator, node, "Type mismatch");
+        }
+        load_variable(generator, node->identifier_expression.slot, reg);
+        return;
+    case PREFIX_EXPRESSION:
+        compile_number(generator, node->prefix_expression.value, reg);
+        if (node->prefix_expression.operator->token_type == MINUS) {
+            emit(generator, "xorpd .Lsign_mask(%%rip), %%xmm%d", reg);
+        } else {
+            emit(generator, "cvttsd2si %%xmm%d, %%rax", reg);
+            emit(generator, "notq %%rax");
+            emit(generator, "cvtsi2sdq %%rax, %%xmm%d", reg);
+        }
+        return;
+    case INFIX_EXPRESSION:
+        break;
+    default:
+        type_error(generator, node, "Type mismatch");
+    }
+
+    struct AstNode* left = node->infix_expression.left;
+    struct AstNode* right = node->infix_expression.right;
+    enum TokenType operator = node->infix_expression.operator->token_type;
+    enum VariableType left_type = get_expression_type(&generator->types, left);
+    if (left_type != get_expression_type(&generator->types, right)) {
+        type_error(generator, node, "Type mismatch");
+    }
+
+    if (left_type == STRING_VARIABLE) {
+        if (!is_relational_operator(operator)) {
+            type_error(generator, node, "Type mismatch");
+        }
+        compile_string_comparison(generator, node, reg);
+        return;
+    }
+
+    char right_operand[32];
+    compile_number_operands(generator, left, right, reg, right_operand, sizeof(right_operand));
+
+    switch (operator)
+    {
+    case PLUS:
+        emit(generator, "addsd %s, %%xmm%d", right_operand, reg);
+        return;
+    case MINUS:
+        emit(generator, "subsd %s, %%xmm%d", right_operand, reg);
+        return;
+    case ASTERISK:
+        emit(generator, "mulsd %s, %%xmm%d", right_operand, reg);
+        return;
+    case SLASH:
+        compile_division_check(generator, right, right_operand, sizeof(right_operand));
+        emit(generator, "divsd %s, %%xmm%d", right_operand, reg);
+        return;
+    case EQUALS:
+        emit(generator, "cmpeqsd %s, %%xmm%d", right_operand, reg);
+        break;
+    case NOT_EQUALS:
+        emit(generator, "cmpneqsd %s, %%xmm%d", right_operand, reg);
+        break;
+    case LESSER_THAN:
+        emit(generator, "cmpltsd %s, %%xmm%d", right_operand, reg);
+        break;
+    case LESSER_EQUALS:
+        emit(generator, "cmplesd %s, %%xmm%d", right_operand, reg);
+        break;
+    case GREATER_THAN:
+    case GREATER_EQUALS:
+        // a > b IS b < a, THE COMPARE WRITES ITS MASK INTO THE RIGHT OPERAND
+        emit(generator, "movsd %s, %%xmm14", right_operand);
+        emit(generator, "%s %%xmm%d, %%xmm14", operator == GREATER_THAN ? "cmpltsd" : "cmplesd", reg);
+        emit(generator, "movapd %%xmm14, %%xmm%d", reg);
+        break;
+    default:
+        type_error(generator, node, "Unsupported operator");
+    }
+
+    // ALL ONES BECOMES -1, ALL ZEROS STAYS 0
+    emit(generator, "andpd .Lminus_one(%%rip), %%xmm%d", reg);
+}
+
+static void compile_string(struct X86Generator* generator, struct AstNode* node) {
+    switch (node->node_type)
+    {
+    case CONST_STRING_EXPRESSION:
+        emit(generator, "leaq .LS%d(%%rip), %%rax", add_string_constant(generator, &node->const_string_expression));
+        return;
+    case IDENTIFIER_EXPRESSION:
+        if (get_expression_type(&generator->types, node) != STRING_VARIABLE) {
+            type_error(generator, node, "Type mismatch");
+        }
+        emit(generator, "movq .Lvar_%d(%%rip), %%rax", node->identifier_expression.slot);
+        return;
+    case INFIX_EXPRESSION:
+        if (node->infix_expression.operator->token_type == PLUS) {
+            break;
+        }
+        type_error(generator, node, "Type mismatch");
+        return;
+    default:
+        type_error(generator, node, "Type mismatch");
+        return;
+    }
+
+    struct AstNode* left = node->infix_expression.left;
+    struct AstNode* right = node->infix_expression.right;
+    if (get_expression_type(&generator->types, left) != STRING_VARIABLE || get_expression_type(&generator->types, right) != STRING_VARIABLE) {
+        type_error(generator, node, "Type mismatch");
+    }
+
+    compile_string(generator, left);
+    if (right->node_type == CONST_STRING_EXPRESSION || right->node_type == IDENTIFIER_EXPRESSION) {
+        emit(generator, "movq %%rax, %%rdi");
+        if (right->node_type == CONST_STRING_EXPRESSION) {
+            emit(generator, "leaq .LS%d(%%rip), %%rsi", add_string_constant(generator, &right->const_string_expression));
+        } else {
+            emit(generator, "movq .Lvar_%d(%%rip), %%rsi", right->identifier_expression.slot);
+        }
+    } else {
+        emit(generator, "subq $16, %%rsp");
+        emit(generator, "movq %%rax, (%%rsp)");
+        compile_string(generator, right);
+        emit(generator, "movq %%rax, %%rsi");
+        emit(generator, "movq (%%rsp), %%rdi");
+        emit(generator, "addq $16, %%rsp");
+    }
+    emit(generator, "call qb_concatenate_strings@PLT");
+}
+
+static void compile_branch(struct X86Generator* generator, struct AstNode* node, int jump_when_true, int label) {
+    // NUMERIC COMPARISONS JUMP STRAIGHT ON THE FLAGS INSTEAD OF BUILDING -1 OR 0,
+    // UNORDERED (NAN) OPERANDS COMPARE FALSE EXCEPT FOR <>
+    if (get_expression_type(&generator->types, node) != NUMBER_VARIABLE) {
+        type_error(generator, node, "Type mismatch");
+    }
+
+    enum TokenType operator = NEW_LINE;
+    if (node->node_type == INFIX_EXPRESSION && is_relational_operator(node->infix_expression.operator->token_type) &&
+        get_expression_type(&generator->types, node->infix_expression.left) == NUMBER_VARIABLE &&
+        get_expression_type(&generator->types, node->infix_expression.right) == NUMBER_VARIABLE) {
+        operator = node->infix_expression.operator->token_type;
+
+        char right_operand[32];
+        compile_number_operands(generator, node->infix_expression.left, node->infix_expression.right,
+            0, right_operand, sizeof(right_operand));
+
+        if (operator == LESSER_THAN || operator == LESSER_EQUALS) {
+            // a < b IS b > a
+            if (strcmp(right_operand, "%xmm15") != 0) {
+                emit(generator, "movsd %s, %%xmm15", right_operand);
+            }
+            emit(generator, "ucomisd %%xmm0, %%xmm15");
+            operator = operator == LESSER_THAN ? GREATER_THAN : GREATER_EQUALS;
+        } else {
+            emit(generator, "ucomisd %s, %%xmm0", right_operand);
+        }
+    } else {
+        compile_number(generator, node, 0);
+        emit(generator, "xorpd %%xmm15, %%xmm15");
+        emit(generator, "ucomisd %%xmm15, %%xmm0");
+        operator = NOT_EQUALS;
+    }
+
+    switch (operator)
+    {
+    case GREATER_THAN:
+        emit(generator, "%s .L%d", jump_when_true ? "ja" : "jbe", label);
+        return;
+    case GREATER_EQUALS:
+        emit(generator, "%s .L%d", jump_when_true ? "jae" : "jb", label);
+        return;
+    default:
+        break;
+    }
+
+    int jump_when_equal = (operator == EQUALS) == jump_when_true;
+    if (jump_when_equal) {
+        emit(generator, "jp 1f");
+        emit(generator, "je .L%d", label);
+        fputs("1:\n", generator->out);
+    } else {
+        emit(generator, "jp .L%d", label);
+        emit(generator, "jne .L%d", label);
+    }
+}
+
+static void compile_converted_number(struct X86Generator* generator, int slot, struct AstNode* expression) {
+    // LEAVES THE VALUE IN %xmm0, ROUNDED TO FLOAT FIRST FOR A SINGLE VARIABLE
+    compile_number(generator, expression, 0);
+    if (generator->types.number_types[slot] == SINGLE_NUMBER &&
+        needs_number_conversion(&generator->types, slot, expression)) {
+        emit(generator, "cvtsd2ss %%xmm0, %%xmm0");
+        emit(generator, "cvtss2sd %%xmm0, %%xmm0");
+    }
+}
+
+static void compile_integer_value(struct X86Generator* generator, int slot, struct AstNode* expression) {
+    // LEAVES THE VALUE IN %rax, INTEGER AND LONG VARIABLES ROUND HALF TO EVEN
+    // AND CHECK THAT THE RESULT SIGN EXTENDS BACK FROM 16 OR 32 BITS
+    int converts = needs_number_conversion(&generator->types, slot, expression);
+    if (expression->node_type == CONST_NUMBER_EXPRESSION && !converts) {
+        double value = get_number_as_double(expression->const_number_expression.value);
+        if (value >= INT32_MIN && value <= INT32_MAX && value == (int32_t)value) {
+            emit(generator, "movq $%d, %%rax", (int32_t)value);
+            return;
+        }
+    }
+
+    compile_number(generator, expression, 0);
+    if (!converts) {
+        emit(generator, "cvttsd2si %%xmm0, %%rax");
+        return;
+    }
+
+    emit(generator, "cvtsd2si %%xmm0, %%rax");
+    if (generator->types.number_types[slot] == INTEGER_NUMBER) {
+        emit(generator, "movswq %%ax, %%rcx");
+    } else {
+        emit(generator, "movslq %%eax, %%rcx");
+    }
+    emit(generator, "cmpq %%rax, %%rcx");
+    emit(generator, "jne .Loverflow");
+}
+
+static int compile_integer_operand(struct X86Generator* generator, int slot, struct AstNode* expression,
+    char* operand, size_t operand_size) {
+    // SMALL CONSTANTS BECOME IMMEDIATES AND RETURN 1, ANYTHING ELSE IS EVALUATED ONCE INTO A HIDDEN SLOT
+    if (expression->node_type == CONST_NUMBER_EXPRESSION &&
+        !needs_number_conversion(&generator->types, slot, expression)) {
+        double value = get_number_as_double(expression->const_number_expression.value);
+        if (value >= INT32_MIN && value <= INT32_MAX && value == (int32_t)value) {
+            snprintf(operand, operand_size, "$%d", (int32_t)value);
+            return 1;
+        }
+    }
+
+    compile_integer_value(generator, slot, expression);
+    snprintf(operand, operand_size, ".Lhidden_%d(%%rip)", generator->hidden_slot_count++);
+    emit(generator, "movq %%rax, %s", operand);
+    return 0;
+}
+
+static void compile_assigned_value(struct X86Generator* generator, int slot, struct AstNode* expression) {
+    if (generator->types.integer_bits[slot] > 0) {
+        compile_integer_value(generator, slot, expression);
+        store_integer_variable(generator, slot);
+    } else {
+        compile_converted_number(generator, slot, expression);
+        store_variable(generator, slot, 0);
+    }
+}
+
+static void compile_print_statement(struct X86Generator* generator, struct PrintStatement* statement) {
+    if (statement->expressions.size == 0) {
+        emit(generator, "call qb_print_new_line@PLT");
+        return;
+    }
+
+    for (long i = 0;i < statement->expressions.size;i++) {
+        struct AstNode* expression = &statement->expressions.expressions[i];
+        if (get_expression_type(&generator->types, expression) == STRING_VARIABLE) {
+            compile_string(generator, expression);
+            emit(generator, "movq %%rax, %%rdi");
+            emit(generator, "call qb_print_string@PLT");
+        } else {
+            compile_number(generator, expression, 0);
+            emit(generator, "call qb_print_number@PLT");
+        }
+
+        if (statement->separators[i] == COMMA) {
+            emit(generator, "call qb_print_zone@PLT");
+        } else if (statement->separators[i] == NEW_LINE) {
+            emit(generator, "call qb_print_new_line@PLT");
+        }
+    }
+}
+
+static void compile_if_statement(struct X86Generator* generator, struct AstNode* node) {
+    int end_label = new_label(generator);
+    long branch_count = 1 + (node->if_statement.elses != NULL ? node->if_statement.elses->size : 0);
+
+    struct IfStatement* branch = &node->if_statement;
+    for (long i = 0;i < branch_count;i++) {
+        if (i > 0) {
+            branch = &node->if_statement.elses->statements[i - 1].if_statement;
+        }
+
+        int next_branch_label = -1;
+        if (branch->condition_expression != NULL) {
+            next_branch_label = new_label(generator);
+            compile_branch(generator, branch->condition_expression, 0, next_branch_label);
+        }
+
+        compile_statements(generator, branch->body);
+
+        if (i + 1 < branch_count) {
+            emit(generator, "jmp .L%d", end_label);
+        }
+
+        if (next_branch_label != -1) {
+            emit_label(generator, next_branch_label);
+        }
+    }
+
+    emit_label(generator, end_label);
+}
+
+static void compile_loop_statement(struct X86Generator* generator, struct LoopStatement* statement) {
+    // THE CONDITION IS TESTED AT THE BOTTOM SO EACH ITERATION TAKES ONE BRANCH
+    int body_label = new_label(generator);
+    int test_label = new_label(generator);
+
+    struct LoopRegisters loop_registers = enter_loop(generator, statement->body, statement->condition_expression, -1);
+    emit(generator, "jmp .L%d", test_label);
+    emit_label(generator, body_label);
+
+    compile_statements(generator, statement->body);
+
+    emit_label(generator, test_label);
+    compile_branch(generator, statement->condition_expression,
+        statement->loop_type_token->token_type == WHILE_KEYWORD, body_label);
+
+    leave_loop(generator, &loop_registers);
+}
+
+static void compile_for_statement(struct X86Generator* generator, struct ForStatement* statement) {
+    int control_slot = statement->control_identifier_expression->identifier_expression.slot;
+    if (generator->types.integer_bits[control_slot] > 0) {
+        compile_integer_for_statement(generator, statement);
+        return;
+    }
+
+    char end_operand[32];
+    char step_operand[32];
+
+    compile_assigned_value(generator, control_slot, statement->initial_expression);
+
+    // CONSTANT BOUNDS STAY IN .rodata, ANYTHING ELSE IS EVALUATED ONCE INTO A HIDDEN SLOT
+    if (statement->end_value_expression->node_type == CONST_NUMBER_EXPRESSION &&
+        !needs_number_conversion(&generator->types, control_slot, statement->end_value_expression)) {
+        snprintf(end_operand, sizeof(end_operand), ".LN%d(%%rip)",
+            add_number_constant(generator, get_number_as_double(statement->end_value_expression->const_number_expression.value)));
+    } else {
+        compile_converted_number(generator, control_slot, statement->end_value_expression);
+        snprintf(end_operand, sizeof(end_operand), ".Lhidden_%d(%%rip)", generator->hidden_slot_count++);
+        emit(generator, "movsd %%xmm0, %s", end_operand);
+    }
+
+    // 1 WHEN THE STEP IS A POSITIVE CONSTANT, -1 WHEN IT IS A NEGATIVE ONE, 0 WHEN IT IS ONLY KNOWN AT RUNTIME
+    int step_sign = 1;
+    if (statement->step_expression == NULL) {
+        snprintf(step_operand, sizeof(step_operand), ".LN%d(%%rip)", add_number_constant(generator, 1));
+    } else if (statement->step_expression->node_type == CONST_NUMBER_EXPRESSION &&
+        !needs_number_conversion(&generator->types, control_slot, statement->step_expression)) {
+        double step = get_number_as_double(statement->step_expression->const_number_expression.value);
+        step_sign = step >= 0 ? 1 : -1;
+        snprintf(step_operand, sizeof(step_operand), ".LN%d(%%rip)", add_number_constant(generator, step));
+    } else {
+        step_sign = 0;
+        compile_converted_number(generator, control_slot, statement->step_expression);
+        snprintf(step_operand, sizeof(step_operand), ".Lhidden_%d(%%rip)", generator->hidden_slot_count++);
+        emit(generator, "movsd %%xmm0, %s", step_operand);
+    }
+
+    int body_label = new_label(generator);
+    int test_label = new_label(generator);
+    int exit_label = new_label(generator);
+
+    struct LoopRegisters loop_registers = enter_loop(generator, statement->body, NULL, control_slot);
+    load_variable(generator, control_slot, 0);
+    emit(generator, "jmp .L%d", test_label);
+    emit_label(generator, body_label);
+
+    compile_statements(generator, statement->body);
+
+    load_variable(generator, control_slot, 0);
+    emit(generator, "addsd %s, %%xmm0", step_operand);
+    store_variable(generator, control_slot, 0);
+
+    // %xmm0 HOLDS THE CONTROL VARIABLE HERE, THE LOOP RUNS WHILE IT HAS NOT PASSED THE END
+    emit_label(generator, test_label);
+    if (step_sign == 0) {
+        int negative_label = new_label(generator);
+        emit(generator, "movsd %s, %%xmm1", step_operand);
+        emit(generator, "xorpd %%xmm2, %%xmm2");
+        emit(generator, "ucomisd %%xmm2, %%xmm1");
+        emit(generator, "jb .L%d", negative_label);
+        emit(generator, "ucomisd %s, %%xmm0", end_operand);
+        emit(generator, "jbe .L%d", body_label);
+        emit(generator, "jmp .L%d", exit_label);
+        emit_label(generator, negative_label);
+    }
+
+    if (step_sign > 0) {
+        emit(generator, "ucomisd %s, %%xmm0", end_operand);
+        emit(generator, "jbe .L%d", body_label);
+    } else {
+        emit(generator, "movsd %s, %%xmm1", end_operand);
+        emit(generator, "ucomisd %%xmm0, %%xmm1");
+        emit(generator, "jbe .L%d", body_label);
+    }
+
+    emit_label(generator, exit_label);
+    leave_loop(generator, &loop_registers);
+}
+
+static void compile_integer_for_statement(struct X86Generator* generator, struct ForStatement* statement) {
+    // AN INTEGER CONTROL VARIABLE COUNTS WITH addq AND cmpq, IN %rax WHEN IT DID NOT GET A LOOP REGISTER
+    int control_slot = statement->control_identifier_expression->identifier_expression.slot;
+    char end_operand[32];
+    char step_operand[32];
+    char control_operand[32];
+
+    compile_integer_value(generator, control_slot, statement->initial_expression);
+    store_integer_variable(generator, control_slot);
+    compile_integer_operand(generator, control_slot, statement->end_value_expression, end_operand, sizeof(end_operand));
+
+    int step_sign = 1;
+    if (statement->step_expression == NULL) {
+        snprintf(step_operand, sizeof(step_operand), "$1");
+    } else if (compile_integer_operand(generator, control_slot, statement->step_expression, step_operand, sizeof(step_operand))) {
+        step_sign = get_number_as_double(statement->step_expression->const_number_expression.value) >= 0 ? 1 : -1;
+    } else {
+        step_sign = 0;
+    }
+
+    int body_label = new_label(generator);
+    int test_label = new_label(generator);
+    int exit_label = new_label(generator);
+
+    struct LoopRegisters loop_registers = enter_loop(generator, statement->body, NULL, control_slot);
+    int loop_register = generator->variable_registers[control_slot];
+    if (loop_register != -1) {
+        snprintf(control_operand, sizeof(control_operand), "%s", loop_register_names[loop_register]);
+    } else {
+        snprintf(control_operand, sizeof(control_operand), "%%rax");
+        emit(generator, "movq .Lvar_%d(%%rip), %%rax", control_slot);
+    }
+    emit(generator, "jmp .L%d", test_label);
+    emit_label(generator, body_label);
+
+    compile_statements(generator, statement->body);
+
+    if (loop_register != -1) {
+        emit(generator, "addq %s, %s", step_operand, control_operand);
+    } else {
+        emit(generator, "movq .Lvar_%d(%%rip), %%rax", control_slot);
+        emit(generator, "addq %s, %%rax", step_operand);
+        emit(generator, "movq %%rax, .Lvar_%d(%%rip)", control_slot);
+    }
+
+    emit_label(generator, test_label);
+    if (step_sign == 0) {
+        int negative_label = new_label(generator);
+        emit(generator, "cmpq $0, %s", step_operand);
+        emit(generator, "jl .L%d", negative_label);
+        emit(generator, "cmpq %s, %s", end_operand, control_operand);
+        emit(generator, "jle .L%d", body_label);
+        emit(generator, "jmp .L%d", exit_label);
+        emit_label(generator, negative_label);
+    }
+
+    emit(generator, "cmpq %s, %s", end_operand, control_operand);
+    emit(generator, "%s .L%d", step_sign > 0 ? "jle" : "jge", body_label);
+
+    emit_label(generator, exit_label);
+    leave_loop(generator, &loop_registers);
+}
+
+static void compile_statement(struct X86Generator* generator, struct AstNode* node) {
+    switch (node->node_type) {
+        case ASSIGN_STATEMENT: {
+            int slot = node->assign_statement.identifier->identifier_expression.slot;
+            if (generator->types.types[slot] == STRING_VARIABLE) {
+                compile_string(generator, node->assign_statement.expression);
+                emit(generator, "movq %%rax, .Lvar_%d(%%rip)", slot);
+            } else {
+                compile_assigned_value(generator, slot, node->assign_statement.expression);
+            }
+            return;
+        }
+        case PRINT_STATEMENT:
+            compile_print_statement(generator, &node->print_statement);
+            return;
+        case IF_STATEMENT:
+            compile_if_statement(generator, node);
+            return;
+        case LOOP_STATEMENT:
+            compile_loop_statement(generator, &node->loop_statement);
+            return;
+        case FOR_STATEMENT:
+            compile_for_statement(generator, &node->for_statement);
+            return;
+        case DEF_TYPE_STATEMENT:
+            return;
+        default:
+            printf("Node %d is not a statement \n", node->node_type);
+            exit(504);
+    }
+}
+
+static void compile_statements(struct X86Generator* generator, struct StatementsList* list) {
+    if (list == NULL) {
+        return;
+    }
+
+    for (long i = 0;i < list->size;i++) {
+        compile_statement(generator, &list->statements[i]);
+    }
+}
+
+static void write_data_sections(struct X86Generator* generator) {
+    FILE* out = generator->out;
+
+    fputs("\n    .section .rodata\n    .balign 16\n", out);
+    fputs(".Lsign_mask:\n    .quad 0x8000000000000000, 0\n", out);
+    fputs(".Lminus_one:\n    .quad 0xbff0000000000000, 0\n", out);
+    for (int i = 0;i < generator->number_constant_count;i++) {
+        fprintf(out, ".LN%d:\n    .quad 0x%016llx\n", i, (unsigned long long)generator->number_constants[i]);
+    }
+
+    // LAID OUT LIKE struct QbString: A LENGTH FOLLOWED BY THE BYTES
+    for (int i = 0;i < generator->string_constant_count;i++) {
+        struct ConstStringExpression* value = &generator->string_constants[i];
+        fprintf(out, "    .balign 8\n.LS%d:\n    .quad %ld\n    .ascii \"", i, value->length);
+        for (long j = 0;j < value->length;j++) {
+            unsigned char c = (unsigned char)value->value[j];
+            if (c >= 0x20 && c < 0x7f && c != '"' && c != '\\') {
+                fputc(c, out);
+            } else {
+                fprintf(out, "\\%03o", c);
+            }
+        }
+        fputs("\"\n", out);
+    }
+
+    // STRING VARIABLES START AS "", NUMBER VARIABLES AS 0
+    fputs("\n    .data\n    .balign 8\n", out);
+    for (int i = 0;i < generator->variable_count;i++) {
+        if (generator->types.types[i] == STRING_VARIABLE) {
+            fprintf(out, ".Lvar_%d: # %s\n    .quad qb_empty_string\n", i, get_slot_name(generator->types.symbols, i));
+        }
+    }
+
+    fputs("\n    .bss\n    .balign 8\n", out);
+    for (int i = 0;i < generator->variable_count;i++) {
+        if (generator->types.types[i] == NUMBER_VARIABLE) {
+            fprintf(out, ".Lvar_%d: # %s\n    .zero 8\n", i, get_slot_name(generator->types.symbols, i));
+        }
+    }
+    for (int i = 0;i < generator->hidden_slot_count;i++) {
+        fprintf(out, ".Lhidden_%d:\n    .zero 8\n", i);
+    }
+
+    fputs("\n    .section .note.GNU-stack,\"\",@progbits\n", out);
+}
+
+void generate_x86_assembly(struct Program* program, FILE* out) {
+    struct X86Generator generator;
+    memset(&generator, 0, sizeof(generator));
+    generator.out = out;
+    generator.source = program->source;
+    generator.types = infer_variable_types(program);
+    generator.variable_count = generator.types.count;
+    generator.variable_registers = (int*)malloc((generator.variable_count + 1) * sizeof(int));
+    for (int i = 0;i < generator.variable_count;i++) {
+        generator.variable_registers[i] = -1;
+    }
+    for (int i = 0;i < LOOP_REGISTER_COUNT;i++) {
+        generator.register_owners[i] = -1;
+    }
+
+    // FIVE CALLEE SAVED PUSHES LEAVE %rsp 16 BYTE ALIGNED FOR EVERY CALL
+    fputs("    .text\n    .globl qb_program\n    .type qb_program, @function\nqb_program:\n", out);
+    for (int i = 0;i < LOOP_REGISTER_COUNT;i++) {
+        emit(&generator, "pushq %s", loop_register_names[i]);
+    }
+
+    compile_statements(&generator, program->list);
+
+    for (int i = LOOP_REGISTER_COUNT - 1;i >= 0;i--) {
+        emit(&generator, "popq %s", loop_register_names[i]);
+    }
+    emit(&generator, "ret");
+
+    fputs(".Ldivision_by_zero:\n", out);
+    emit(&generator, "call qb_division_by_zero@PLT");
+    fputs(".Loverflow:\n", out);
+    emit(&generator, "call qb_overflow@PLT");
+    fputs("    .size qb_program, .-qb_program\n", out);
+
+    write_data_sections(&generator);
+
+    free_variable_types(&generator.types);
+    free(generator.variable_registers);
+    free(generator.number_constants);
+    free(generator.string_constants);
+}
@@ -0,0 +1,10 @@
+#ifndef CODEGEN_X86_H_
+#define CODEGEN_X86_H_
+
+#include <stdio.h>
+#include "parser.h"
+
+// WRITES x86-64 SYSTEM V ASSEMBLY (GAS SYNTAX) DEFINING qb_program(), LINK IT WITH runtime.c
+void generate_x86_assembly(struct Program* program, FILE* out);
+
+#endif
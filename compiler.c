@@ -0,0 +1,340 @@
+#include "compiler.h"
+#include "arena.h"
+#include "variable_types.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+// WALKS THE FLAT AST, ITS NODES SIT IN THE ORDER THEY ARE COMPILED
+struct Compiler {
+    struct Chunk* chunk;
+    const struct FlatAst* ast;
+
+    int stack_depth;
+    struct VariableTypes types;
+};
+
+static void emit_instruction(struct Compiler* compiler, enum OpCode op, int stack_effect);
+static long emit_jump(struct Compiler* compiler, enum OpCode op, int stack_effect);
+static void patch_jump_to_here(struct Compiler* compiler, long operand_position);
+
+static int new_hidden_slot(struct Compiler* compiler);
+
+static void compile_string_slots(struct Compiler* compiler);
+static void compile_expression(struct Compiler* compiler, int index);
+static void compile_assigned_value(struct Compiler* compiler, int slot, int expression);
+static void compile_statements(struct Compiler* compiler, int list);
+static void compile_statement(struct Compiler* compiler, int index);
+static void compile_print_statement(struct Compiler* compiler, const struct FlatNode* node);
+static void compile_if_statement(struct Compiler* compiler, const struct FlatNode* node);
+static void compile_loop_statement(struct Compiler* compiler, const struct FlatNode* node);
+static void compile_for_statement(struct Compiler* compiler, const struct FlatNode* node);
+
+static void emit_instruction(struct Compiler* compiler, enum OpCode op, int stack_effect) {
+    emit_op(compiler->chunk, op);
+
+    compiler->stack_depth += stack_effect;
+    if (compiler->stack_depth > compiler->chunk->max_stack_depth) {
+        compiler->chunk->max_stack_depth = compiler->stack_depth;
+    }
+}
+
+static long emit_jump(struct Compiler* compiler, enum OpCode op, int stack_effect) {
+    emit_instruction(compiler, op, stack_effect);
+    return emit_operand(compiler->chunk, -1);
+}
+
+static void patch_jump_to_here(struct Compiler* compiler, long operand_position) {
+    patch_operand(compiler->chunk, operand_position, (int32_t)compiler->chunk->code_length);
+}
+
+static int new_hidden_slot(struct Compiler* compiler) {
+    return compiler->chunk->slot_count++;
+}
+
+// THE VM STARTS EVERY SLOT AT 0, DECLARED STRINGS START AS "" LIKE THEY DO IN THE NATIVE BACKENDS
+static void compile_string_slots(struct Compiler* compiler) {
+    int empty_string = -1;
+    for (int i = 0;i < compiler->types.count;i++) {
+        if (compiler->types.types[i] != STRING_VARIABLE) {
+            continue;
+        }
+
+        if (empty_string == -1) {
+            struct Value value;
+            value.type = STRING_VALUE;
+            value.string.chars = "";
+            value.string.length = 0;
+            empty_string = add_constant(compiler->chunk, value);
+        }
+
+        emit_instruction(compiler, OP_CONSTANT, 1);
+        emit_operand(compiler->chunk, empty_string);
+        emit_instruction(compiler, OP_STORE, -1);
+        emit_operand(compiler->chunk, i);
+    }
+}
+
+static void compile_expression(struct Compiler* compiler, int index) {
+    const struct FlatNode* node = &compiler->ast->nodes[index];
+    switch (node->node_type) {
+        case CONST_NUMBER_EXPRESSION: {
+            struct Value value;
+            value.type = NUMBER_VALUE;
+            value.number = get_number_as_double(compiler->ast->numbers[node->first]);
+
+            emit_instruction(compiler, OP_CONSTANT, 1);
+            emit_operand(compiler->chunk, add_constant(compiler->chunk, value));
+            return;
+        }
+        case CONST_STRING_EXPRESSION: {
+            const struct FlatString* string = &compiler->ast->strings[node->first];
+            long length = string->length;
+            char* chars = (char*)arena_alloc(compiler->chunk->arena, length + 1);
+            memcpy(chars, string->chars, length);
+            chars[length] = 0;
+
+            struct Value value;
+            value.type = STRING_VALUE;
+            value.string.chars = chars;
+            value.string.length = length;
+
+            emit_instruction(compiler, OP_CONSTANT, 1);
+            emit_operand(compiler->chunk, add_constant(compiler->chunk, value));
+            return;
+        }
+        case IDENTIFIER_EXPRESSION:
+            emit_instruction(compiler, OP_LOAD, 1);
+            emit_operand(compiler->chunk, node->first);
+            return;
+        case PREFIX_EXPRESSION:
+            compile_expression(compiler, node->first);
+            if (node->token_type == MINUS) {
+                emit_instruction(compiler, OP_NEGATE, 0);
+            } else {
+                emit_instruction(compiler, OP_NOT, 0);
+            }
+            return;
+        case INFIX_EXPRESSION: {
+            compile_expression(compiler, node->first);
+            compile_expression(compiler, node->second);
+
+            enum OpCode op;
+            switch (node->token_type) {
+                case PLUS: op = OP_ADD; break;
+                case MINUS: op = OP_SUBTRACT; break;
+                case ASTERISK: op = OP_MULTIPLY; break;
+                case SLASH: op = OP_DIVIDE; break;
+                case EQUALS: op = OP_EQUALS; break;
+                case NOT_EQUALS: op = OP_NOT_EQUALS; break;
+                case GREATER_THAN: op = OP_GREATER; break;
+                case GREATER_EQUALS: op = OP_GREATER_EQUALS; break;
+                case LESSER_THAN: op = OP_LESSER; break;
+                case LESSER_EQUALS: op = OP_LESSER_EQUALS; break;
+                default:
+                    printf("Unsupported operator %s \n", get_token_type_string((enum TokenType)node->token_type));
+                    exit(402);
+            }
+
+            emit_instruction(compiler, op, -1);
+            return;
+        }
+        default:
+            printf("Node %d is not an expression \n", node->node_type);
+            exit(403);
+    }
+}
+
+// VALUES STORED INTO DECLARED INTEGER, LONG AND SINGLE VARIABLES ARE ROUNDED TO THE TYPE
+static void compile_assigned_value(struct Compiler* compiler, int slot, int expression) {
+    compile_expression(compiler, expression);
+    if (needs_flat_number_conversion(&compiler->types, slot, compiler->ast, expression)) {
+        emit_instruction(compiler, OP_CONVERT, 0);
+        emit_operand(compiler->chunk, compiler->types.number_types[slot]);
+    }
+}
+
+static void compile_print_statement(struct Compiler* compiler, const struct FlatNode* node) {
+    const struct FlatList* expressions = &compiler->ast->lists[node->first];
+    const unsigned char* separators = &compiler->ast->separators[node->second];
+    if (expressions->count == 0) {
+        emit_instruction(compiler, OP_PRINT_NEW_LINE, 0);
+        return;
+    }
+
+    for (int i = 0;i < expressions->count;i++) {
+        compile_expression(compiler, compiler->ast->children[expressions->start + i]);
+        emit_instruction(compiler, OP_PRINT, -1);
+
+        if (separators[i] == COMMA) {
+            emit_instruction(compiler, OP_PRINT_ZONE, 0);
+        } else if (separators[i] == NEW_LINE) {
+            emit_instruction(compiler, OP_PRINT_NEW_LINE, 0);
+        }
+    }
+}
+
+static void compile_if_statement(struct Compiler* compiler, const struct FlatNode* node) {
+    const struct FlatAst* ast = compiler->ast;
+    int elses = ast->extra[node->second + 1];
+
+    // EVERY TAKEN BRANCH JUMPS TO THE END, THE JUMPS ARE PATCHED ONCE IT IS KNOWN
+    int branch_count = 1 + (elses != -1 ? ast->lists[elses].count : 0);
+    long* end_jumps = (long*)malloc(branch_count * sizeof(long));
+    int end_jump_count = 0;
+
+    const struct FlatNode* branch = node;
+    for (int i = 0;i < branch_count;i++) {
+        if (i > 0) {
+            branch = &ast->nodes[ast->children[ast->lists[elses].start + i - 1]];
+        }
+
+        long next_branch_jump = -1;
+        if (branch->first != -1) {
+            compile_expression(compiler, branch->first);
+            next_branch_jump = emit_jump(compiler, OP_JUMP_IF_FALSE, -1);
+        }
+
+        compile_statements(compiler, ast->extra[branch->second]);
+
+        if (i + 1 < branch_count) {
+            end_jumps[end_jump_count++] = emit_jump(compiler, OP_JUMP, 0);
+        }
+
+        if (next_branch_jump != -1) {
+            patch_jump_to_here(compiler, next_branch_jump);
+        }
+    }
+
+    for (int i = 0;i < end_jump_count;i++) {
+        patch_jump_to_here(compiler, end_jumps[i]);
+    }
+
+    free(end_jumps);
+}
+
+static void compile_loop_statement(struct Compiler* compiler, const struct FlatNode* node) {
+    long loop_start = compiler->chunk->code_length;
+
+    compile_expression(compiler, node->first);
+    enum OpCode exit_op = node->token_type == WHILE_KEYWORD ? OP_JUMP_IF_FALSE : OP_JUMP_IF_TRUE;
+    long exit_jump = emit_jump(compiler, exit_op, -1);
+
+    compile_statements(compiler, node->second);
+
+    emit_instruction(compiler, OP_JUMP, 0);
+    emit_operand(compiler->chunk, (int32_t)loop_start);
+    patch_jump_to_here(compiler, exit_jump);
+}
+
+static void compile_for_statement(struct Compiler* compiler, const struct FlatNode* node) {
+    const int* parts = &compiler->ast->extra[node->second];
+    int initial_expression = parts[0];
+    int end_value_expression = parts[1];
+    int step_expression = parts[2];
+    int body = parts[3];
+
+    int control_slot = compiler->ast->nodes[node->first].first;
+    int end_slot = new_hidden_slot(compiler);
+    int step_slot = new_hidden_slot(compiler);
+
+    // THE END AND STEP TAKE THE CONTROL VARIABLE'S TYPE TOO
+    compile_assigned_value(compiler, control_slot, initial_expression);
+    emit_instruction(compiler, OP_STORE, -1);
+    emit_operand(compiler->chunk, control_slot);
+
+    compile_assigned_value(compiler, control_slot, end_value_expression);
+    emit_instruction(compiler, OP_STORE, -1);
+    emit_operand(compiler->chunk, end_slot);
+
+    if (step_expression != -1) {
+        compile_assigned_value(compiler, control_slot, step_expression);
+    } else {
+        struct Value one;
+        one.type = NUMBER_VALUE;
+        one.number = 1;
+
+        emit_instruction(compiler, OP_CONSTANT, 1);
+        emit_operand(compiler->chunk, add_constant(compiler->chunk, one));
+    }
+    emit_instruction(compiler, OP_STORE, -1);
+    emit_operand(compiler->chunk, step_slot);
+
+    long loop_start = compiler->chunk->code_length;
+    emit_instruction(compiler, OP_FOR_TEST, 0);
+    emit_operand(compiler->chunk, control_slot);
+    emit_operand(compiler->chunk, end_slot);
+    long exit_jump = emit_operand(compiler->chunk, -1);
+
+    compile_statements(compiler, body);
+
+    emit_instruction(compiler, OP_FOR_STEP, 0);
+    emit_operand(compiler->chunk, control_slot);
+    emit_operand(compiler->chunk, step_slot);
+    emit_operand(compiler->chunk, (int32_t)loop_start);
+
+    patch_jump_to_here(compiler, exit_jump);
+}
+
+static void compile_statement(struct Compiler* compiler, int index) {
+    const struct FlatNode* node = &compiler->ast->nodes[index];
+    switch (node->node_type) {
+        case ASSIGN_STATEMENT: {
+            int slot = compiler->ast->nodes[node->first].first;
+            compile_assigned_value(compiler, slot, node->second);
+            emit_instruction(compiler, OP_STORE, -1);
+            emit_operand(compiler->chunk, slot);
+            return;
+        }
+        case PRINT_STATEMENT:
+            compile_print_statement(compiler, node);
+            return;
+        case IF_STATEMENT:
+            compile_if_statement(compiler, node);
+            return;
+        case LOOP_STATEMENT:
+            compile_loop_statement(compiler, node);
+            return;
+        case FOR_STATEMENT:
+            compile_for_statement(compiler, node);
+            return;
+        case DEF_TYPE_STATEMENT:
+            return;
+        default:
+            printf("Node %d is not a statement \n", node->node_type);
+            exit(404);
+    }
+}
+
+static void compile_statements(struct Compiler* compiler, int list) {
+    if (list == -1) {
+        return;
+    }
+
+    const struct FlatList* statements = &compiler->ast->lists[list];
+    for (int i = 0;i < statements->count;i++) {
+        compile_statement(compiler, compiler->ast->children[statements->start + i]);
+    }
+}
+
+struct Chunk compile_program(struct Program* program) {
+    struct Chunk chunk = new_chunk();
+    struct FlatAst ast = flatten_program(program);
+
+    struct Compiler compiler;
+    compiler.chunk = &chunk;
+    compiler.ast = &ast;
+    compiler.stack_depth = 0;
+    compiler.types = declare_variable_types(program);
+
+    // VARIABLES KEEP THEIR SYMBOL TABLE SLOTS, HIDDEN FOR LOOP SLOTS COME AFTER THEM
+    chunk.slot_count = program->symbols.slot_count;
+
+    compile_string_slots(&compiler);
+    compile_statements(&compiler, ast.statements);
+    emit_instruction(&compiler, OP_HALT, 0);
+
+    free_variable_types(&compiler.types);
+    free_flat_ast(&ast);
+    return chunk;
+}
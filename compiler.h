@@ -0,0 +1,9 @@
+#ifndef COMPILER_H_
+#define COMPILER_H_
+
+#include "parser.h"
+#include "bytecode.h"
+
+struct Chunk compile_program(struct Program* program);
+
+#endif
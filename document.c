@@ -0,0 +1,444 @@
+#include "document.h"
+#include "arena.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+// ROOM FOR INSERTIONS WHEN THE TEXT GETS A NEW BUFFER
+#define MIN_DOCUMENT_GAP 4096
+// OLD NODES A DOCUMENT MAY COLLECT BEYOND ITS PARSED SIZE BEFORE IT IS PARSED AGAIN FROM SCRATCH
+#define MIN_DOCUMENT_GARBAGE (1024 * 1024)
+
+static long get_gap_size(const struct Document* document);
+static long get_physical_offset(const struct Document* document, long offset);
+static long get_range_start(const struct Document* document, long range);
+static long get_range_end(const struct Document* document, long range);
+static long find_range(const struct Document* document, long physical_offset);
+static long find_range_containing(const struct Document* document, long physical_offset);
+
+static void shift_token(struct Token* token, long delta);
+static void shift_expression(const char* text, struct AstNode* node, long delta);
+static void shift_statements(const char* text, struct StatementsList* list, long delta);
+static void shift_ranges(struct Document* document, long first_range, long end_range, long delta);
+static void move_gap(struct Document* document, long offset);
+
+static void replace_ranges(struct Document* document, long first_range, long end_range,
+    struct DocumentRange* ranges, long range_count);
+static void parse_region(struct Document* document, long region_start, long first_range, long end_range);
+static void parse_whole_document(struct Document* document);
+
+static long get_gap_size(const struct Document* document) {
+    return document->gap_end - document->gap_start;
+}
+
+// AN OFFSET RIGHT AT THE GAP BELONGS TO THE TEXT AFTER IT
+static long get_physical_offset(const struct Document* document, long offset) {
+    return offset < document->gap_start ? offset : offset + get_gap_size(document);
+}
+
+static long get_range_start(const struct Document* document, long range) {
+    long start = document->ranges[range].start;
+    return start < document->gap_start ? start : start - get_gap_size(document);
+}
+
+static long get_range_end(const struct Document* document, long range) {
+    long end = document->ranges[range].end;
+    return end <= document->gap_start ? end : end - get_gap_size(document);
+}
+
+// THE FIRST RANGE STARTING AT OR AFTER physical_offset
+static long find_range(const struct Document* document, long physical_offset) {
+    long low = 0;
+    long high = document->range_count;
+    while (low < high) {
+        long middle = low + (high - low) / 2;
+        if (document->ranges[middle].start < physical_offset) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+// THE RANGES START AT 0 AND LEAVE NO HOLES, SO SOME RANGE ALWAYS STARTS AT OR BEFORE THE OFFSET
+static long find_range_containing(const struct Document* document, long physical_offset) {
+    return find_range(document, physical_offset + 1) - 1;
+}
+
+static void shift_token(struct Token* token, long delta) {
+    if (token != NULL) {
+        token->offset += delta;
+    }
+}
+
+static void shift_expression(const char* text, struct AstNode* node, long delta) {
+    if (node == NULL) {
+        return;
+    }
+
+    switch (node->node_type)
+    {
+    case CONST_STRING_EXPRESSION:
+        // FOLDED STRINGS ARE IN THE ARENA AND STAY WHERE THEY ARE
+        if (node->const_string_expression.token != NULL &&
+            node->const_string_expression.value == text + node->const_string_expression.token->offset) {
+            node->const_string_expression.value += delta;
+        }
+        shift_token(node->const_string_expression.token, delta);
+        break;
+    case CONST_NUMBER_EXPRESSION:
+        shift_token(node->const_number_expression.token, delta);
+        break;
+    case IDENTIFIER_EXPRESSION:
+        shift_token(node->identifier_expression.token, delta);
+        break;
+    case PREFIX_EXPRESSION:
+        shift_token(node->prefix_expression.operator, delta);
+        shift_expression(text, node->prefix_expression.value, delta);
+        break;
+    case INFIX_EXPRESSION:
+        shift_token(node->infix_expression.operator, delta);
+        shift_expression(text, node->infix_expression.left, delta);
+        shift_expression(text, node->infix_expression.right, delta);
+        break;
+    default:
+        break;
+    }
+}
+
+static void shift_statements(const char* text, struct StatementsList* list, long delta) {
+    if (list == NULL) {
+        return;
+    }
+
+    for (long i = 0;i < list->size;i++) {
+        struct AstNode* node = &list->statements[i];
+        switch (node->node_type)
+        {
+        case ASSIGN_STATEMENT:
+            shift_expression(text, node->assign_statement.identifier, delta);
+            shift_expression(text, node->assign_statement.expression, delta);
+            break;
+        case PRINT_STATEMENT:
+            shift_token(node->print_statement.token, delta);
+            for (long j = 0;j < node->print_statement.expressions.size;j++) {
+                shift_expression(text, &node->print_statement.expressions.expressions[j], delta);
+            }
+            break;
+        case IF_STATEMENT:
+            shift_token(node->if_statement.token, delta);
+            shift_expression(text, node->if_statement.condition_expression, delta);
+            shift_statements(text, node->if_statement.body, delta);
+            shift_statements(text, node->if_statement.elses, delta);
+            break;
+        case LOOP_STATEMENT:
+            shift_token(node->loop_statement.token, delta);
+            shift_token(node->loop_statement.loop_type_token, delta);
+            shift_expression(text, node->loop_statement.condition_expression, delta);
+            shift_statements(text, node->loop_statement.body, delta);
+            break;
+        case FOR_STATEMENT:
+            shift_token(node->for_statement.token, delta);
+            shift_expression(text, node->for_statement.control_identifier_expression, delta);
+            shift_expression(text, node->for_statement.initial_expression, delta);
+            shift_expression(text, node->for_statement.end_value_expression, delta);
+            shift_expression(text, node->for_statement.step_expression, delta);
+            shift_statements(text, node->for_statement.body, delta);
+            break;
+        case DEF_TYPE_STATEMENT:
+            shift_token(node->def_type_statement.token, delta);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+// THE TEXT OF RANGES [first_range, end_range) MOVED BY delta. THE OFFSETS IN THEIR STATEMENTS
+// CATCH UP IN get_document_program, SO MOVING THE GAP FAR ONLY TOUCHES THE RANGES
+static void shift_ranges(struct Document* document, long first_range, long end_range, long delta) {
+    for (long i = first_range;i < end_range;i++) {
+        document->ranges[i].start += delta;
+        document->ranges[i].end += delta;
+        document->ranges[i].shift += delta;
+    }
+}
+
+// offset COUNTS IN THE EDITED TEXT AND MUST BE WHERE A RANGE STARTS OR ENDS. ONLY THE TEXT
+// BETWEEN THE OLD AND THE NEW PLACE OF THE GAP MOVES
+static void move_gap(struct Document* document, long offset) {
+    char* text = document->text;
+    long gap = get_gap_size(document);
+
+    if (offset < document->gap_start) {
+        long length = document->gap_start - offset;
+        long first_range = find_range(document, offset);
+        long end_range = find_range(document, document->gap_end);
+
+        memmove(text + document->gap_end - length, text + offset, length);
+        memset(text + offset, ' ', gap);
+        document->gap_start -= length;
+        document->gap_end -= length;
+        shift_ranges(document, first_range, end_range, gap);
+    } else if (offset > document->gap_start) {
+        long length = offset - document->gap_start;
+        long first_range = find_range(document, document->gap_end);
+        long end_range = find_range(document, document->gap_end + length);
+
+        memmove(text + document->gap_start, text + document->gap_end, length);
+        memset(text + offset, ' ', gap);
+        document->gap_start += length;
+        document->gap_end += length;
+        shift_ranges(document, first_range, end_range, -gap);
+    }
+}
+
+// PUTS ranges IN PLACE OF RANGES [first_range, end_range)
+static void replace_ranges(struct Document* document, long first_range, long end_range,
+    struct DocumentRange* ranges, long range_count) {
+    long range_delta = range_count - (end_range - first_range);
+    if (document->range_count + range_delta > document->range_capacity) {
+        document->range_capacity = (document->range_count + range_delta) * 2;
+        document->ranges = (struct DocumentRange*)realloc(document->ranges, document->range_capacity * sizeof(struct DocumentRange));
+    }
+    memmove(document->ranges + end_range + range_delta, document->ranges + end_range,
+        (document->range_count - end_range) * sizeof(struct DocumentRange));
+    memcpy(document->ranges + first_range, ranges, range_count * sizeof(struct DocumentRange));
+    document->range_count += range_delta;
+
+    for (long i = 0;i < range_count;i++) {
+        resolve_new_symbols(&document->symbols, ranges[i].list);
+    }
+}
+
+// THE TEXT OF RANGES [first_range, end_range) WAS CHANGED AND IS NOW [region_start, gap_start).
+// IT IS LEXED AND CUT BETWEEN TOP LEVEL STATEMENTS AGAIN, WHILE A BLOCK IN IT IS LEFT OPEN OR
+// ITS LAST LINE RUNS ON INTO THE NEXT RANGE THE REGION TAKES IN MORE RANGES
+static void parse_region(struct Document* document, long region_start, long first_range, long end_range) {
+    struct TokenList tokens;
+    struct ParseSegment* segments;
+    long segment_count;
+    long added_ranges = 1;
+
+    for (;;) {
+        tokens = read_token_range(document->text, region_start, document->gap_start);
+        segments = (struct ParseSegment*)malloc((tokens.length + 1) * sizeof(struct ParseSegment));
+        segment_count = split_top_level_statements(&tokens, segments, tokens.length + 1);
+
+        int line_ended = document->gap_start == region_start || document->text[document->gap_start - 1] == '\n';
+        if ((segment_count > 0 && line_ended) || end_range == document->range_count) {
+            break;
+        }
+
+        free(segments);
+        free_token_list(&tokens);
+
+        // TWICE AS MANY RANGES EACH TIME, SO AN UNCLOSED BLOCK IS NOT RE-LEXED ONCE PER LINE
+        if (added_ranges > document->range_count - end_range) {
+            added_ranges = document->range_count - end_range;
+        }
+        end_range += added_ranges;
+        added_ranges *= 2;
+        move_gap(document, get_range_end(document, end_range - 1));
+    }
+
+    // A BLOCK LEFT OPEN OR CLOSED TWICE GOES ON TO THE END OF THE TEXT, WHICH PARSES IN ONE
+    // PIECE TO WHAT parse WOULD MAKE OF IT
+    if (segment_count == 0) {
+        segments[0] = (struct ParseSegment){0, tokens.length, NULL};
+        segment_count = 1;
+    }
+
+    // NEW LINES AT THE END GIVE AN EMPTY LAST SEGMENT, ITS TEXT GOES TO THE ONE BEFORE
+    if (segment_count > 1 && segments[segment_count - 1].start == tokens.length) {
+        segment_count--;
+    }
+
+    struct DocumentRange* ranges = (struct DocumentRange*)malloc(segment_count * sizeof(struct DocumentRange));
+    long range_count = 0;
+    long start = region_start;
+    for (long i = 0;i < segment_count;i++) {
+        long end = i + 1 < segment_count ? tokens.tokens[segments[i].end - 1].offset + 1 : document->gap_start;
+        if (end == start) {
+            continue;
+        }
+
+        ranges[range_count].start = start;
+        ranges[range_count].end = end;
+        ranges[range_count].shift = 0;
+        ranges[range_count].list = parse_token_range(&tokens, segments[i].start, segments[i].end, document->program.arena);
+        range_count++;
+        start = end;
+    }
+
+    replace_ranges(document, first_range, end_range, ranges, range_count);
+
+    free(ranges);
+    free(segments);
+    free_token_list(&tokens);
+}
+
+// THE OLD AST IS THROWN AWAY, SO THE GAP GOES TO THE END WITHOUT SHIFTING ANYTHING
+static void parse_whole_document(struct Document* document) {
+    long size = get_document_size(document);
+    memmove(document->text + document->gap_start, document->text + document->gap_end, document->capacity - document->gap_end);
+    memset(document->text + size, ' ', document->capacity - size);
+    document->gap_start = size;
+    document->gap_end = document->capacity;
+
+    if (document->program.arena != NULL) {
+        free_arena(document->program.arena);
+    }
+    document->program.arena = new_arena(0);
+    document->program.source = document->text;
+    free_symbol_resolver(&document->symbols);
+    document->symbols = new_symbol_resolver();
+    document->range_count = 0;
+
+    parse_region(document, 0, 0, 0);
+
+    document->parsed_bytes = get_arena_used(document->program.arena);
+}
+
+struct Document* open_document(const char* text, long size) {
+    struct Document* document = (struct Document*)calloc(1, sizeof(struct Document));
+    document->capacity = size + size / 2 + MIN_DOCUMENT_GAP;
+    document->text = (char*)malloc(document->capacity);
+    if (document->text == NULL) {
+        printf("Out of memory opening a document \n");
+        exit(1);
+    }
+
+    memcpy(document->text, text, size);
+    document->gap_start = size;
+    document->gap_end = document->capacity;
+
+    document->statements.capacity = 64;
+    document->statements.statements = (struct AstNode*)malloc(document->statements.capacity * sizeof(struct AstNode));
+    document->range_capacity = 64;
+    document->ranges = (struct DocumentRange*)malloc(document->range_capacity * sizeof(struct DocumentRange));
+
+    document->program.list = &document->statements;
+    document->program.owns_arena = 1;
+
+    parse_whole_document(document);
+    return document;
+}
+
+void edit_document(struct Document* document, long offset, long removed_length, const char* inserted, long inserted_length) {
+    long size = get_document_size(document);
+    if (offset < 0 || removed_length < 0 || inserted_length < 0 || offset + removed_length > size) {
+        printf("Edit of %ld bytes at %ld is outside the document of %ld bytes \n", removed_length, offset, size);
+        exit(701);
+    }
+
+    // A GAP TOO SMALL FOR THE EDIT MEANS A NEW BUFFER, AND NEW ADDRESSES FOR ALL OF THE TEXT
+    long growth = inserted_length - removed_length;
+    if (growth > get_gap_size(document)) {
+        long capacity = (size + growth) * 2 + MIN_DOCUMENT_GAP;
+        char* text = (char*)malloc(capacity);
+        if (text == NULL) {
+            printf("Out of memory editing a document \n");
+            exit(1);
+        }
+
+        copy_document_text(document, text);
+        memmove(text + offset + inserted_length, text + offset + removed_length, size - offset - removed_length);
+        memcpy(text + offset, inserted, inserted_length);
+
+        free(document->text);
+        document->text = text;
+        document->capacity = capacity;
+        document->gap_start = size + growth;
+        document->gap_end = capacity;
+        parse_whole_document(document);
+        return;
+    }
+
+    long first_range = 0;
+    long end_range = 0;
+    long region_start = 0;
+    if (document->range_count > 0) {
+        first_range = find_range_containing(document, get_physical_offset(document, offset));
+        end_range = find_range_containing(document, get_physical_offset(document, offset + removed_length)) + 1;
+        region_start = get_range_start(document, first_range);
+        move_gap(document, get_range_end(document, end_range - 1));
+    }
+
+    // THE GAP ENDS THE REGION NOW, SO ONLY THE REST OF THE REGION MOVES
+    char* text = document->text;
+    memmove(text + offset + inserted_length, text + offset + removed_length, document->gap_start - offset - removed_length);
+    memcpy(text + offset, inserted, inserted_length);
+    if (growth < 0) {
+        memset(text + document->gap_start + growth, ' ', -growth);
+    }
+    document->gap_start += growth;
+
+    parse_region(document, region_start, first_range, end_range);
+
+    if (get_arena_used(document->program.arena) > 2 * document->parsed_bytes + MIN_DOCUMENT_GARBAGE) {
+        parse_whole_document(document);
+    }
+}
+
+// THE STATEMENTS OF ALL RANGES IN ONE LIST, WITH THE OFFSETS OF THOSE THE GAP MOVED UPDATED
+struct Program* get_document_program(struct Document* document) {
+    struct StatementsList* statements = &document->statements;
+    statements->size = 0;
+    for (long i = 0;i < document->range_count;i++) {
+        statements->size += document->ranges[i].list->size;
+    }
+
+    if (statements->size > statements->capacity) {
+        statements->capacity = statements->size * 2;
+        statements->statements = (struct AstNode*)realloc(statements->statements, statements->capacity * sizeof(struct AstNode));
+    }
+
+    long position = 0;
+    for (long i = 0;i < document->range_count;i++) {
+        struct DocumentRange* range = &document->ranges[i];
+        if (range->shift != 0) {
+            shift_statements(document->text, range->list, range->shift);
+            range->shift = 0;
+        }
+
+        memcpy(statements->statements + position, range->list->statements, range->list->size * sizeof(struct AstNode));
+        position += range->list->size;
+    }
+
+    document->program.symbols.identifier_ids = document->symbols.identifier_ids;
+    document->program.symbols.slot_count = document->symbols.slot_count;
+    document->program.arena_bytes = get_arena_used(document->program.arena);
+    return &document->program;
+}
+
+long get_document_size(const struct Document* document) {
+    return document->capacity - get_gap_size(document);
+}
+
+void copy_document_text(const struct Document* document, char* buffer) {
+    memcpy(buffer, document->text, document->gap_start);
+    memcpy(buffer + document->gap_start, document->text + document->gap_end, document->capacity - document->gap_end);
+}
+
+struct SourcePosition get_document_position(const struct Document* document, long offset) {
+    struct SourcePosition position = get_source_position(document->text, offset);
+
+    // THE GAP ALWAYS STARTS A LINE, SO ONLY THE LINE AFTER IT HAS ITS SPACES
+    if (offset >= document->gap_end && offset - (position.col - 1) <= document->gap_start) {
+        position.col -= (int)get_gap_size(document);
+    }
+
+    return position;
+}
+
+void close_document(struct Document* document) {
+    free_arena(document->program.arena);
+    free_symbol_resolver(&document->symbols);
+    free(document->statements.statements);
+    free(document->ranges);
+    free(document->text);
+    free(document);
+}
@@ -0,0 +1,63 @@
+#ifndef DOCUMENT_H_
+#define DOCUMENT_H_
+
+#include "parser.h"
+
+// THE TOP LEVEL STATEMENTS PARSED FROM A RUN OF WHOLE LINES, start AND end COUNT THE GAP
+struct DocumentRange {
+    long start;
+    long end;
+    // HOW FAR THE TEXT MOVED SINCE THE OFFSETS IN list WERE LAST UPDATED
+    long shift;
+    struct StatementsList* list;
+};
+
+// A PROGRAM KEPT UP TO DATE WHILE ITS TEXT IS EDITED, FOR AN EDITOR THAT PARSES ON EVERY
+// KEYSTROKE. AN EDIT RE-LEXES ONLY THE LINES OF THE TOP LEVEL STATEMENTS IT TOUCHES, A WHOLE
+// IF ... END IF OR FOR ... NEXT WHEN IT IS INSIDE ONE, AND PUTS THEIR NEW STATEMENTS IN PLACE
+// OF THE OLD ONES.
+//
+// THE TEXT HAS A GAP OF SPACES AFTER THE LINES THE LAST EDIT RE-PARSED, SO THE TEXT BEHIND IT
+// DOESN'T MOVE AND NEITHER DO THE OFFSETS AND STRINGS ITS AST HOLDS. EVERY OFFSET COUNTS THE
+// GAP, SO program.source WORKS LIKE ANY SOURCE EXCEPT THAT COLUMNS ON THE LINE AFTER THE GAP
+// ALSO COUNT ITS SPACES, get_document_position GIVES THE POSITION IN THE EDITED TEXT
+//
+// THE PARSER STILL EXITS ON A SYNTAX ERROR, SO AN EDIT THAT LEAVES A LINE INCOMPLETE, LIKE
+// "if x >", ENDS THE PROCESS. AN EDITOR HAS TO HAND OVER ONLY TEXT THAT PARSES UNTIL THE
+// PARSER CAN REPORT ERRORS INSTEAD
+struct Document {
+    char* text;
+    long capacity;
+    long gap_start;
+    long gap_end;
+
+    // ONLY UP TO DATE AFTER get_document_program. program.list IS statements, ITS ARRAY IS OWNED
+    // BY THE DOCUMENT AND THE NODES ARE IN program.arena
+    struct Program program;
+    struct StatementsList statements;
+    // program.symbols IS THE RESOLVER'S TABLE, OLD NAMES KEEP THEIR SLOTS WHEN STATEMENTS ARE RE-PARSED
+    struct SymbolResolver symbols;
+
+    // IN TEXT ORDER, TOGETHER THEY COVER ALL OF THE TEXT BUT THE GAP
+    struct DocumentRange* ranges;
+    long range_count;
+    long range_capacity;
+
+    // WHAT THE LAST FULL PARSE TOOK FROM THE ARENA, RE-PARSED STATEMENTS LEAVE THEIR OLD NODES
+    // THERE UNTIL THE NEXT ONE
+    size_t parsed_bytes;
+};
+
+struct Document* open_document(const char* text, long size);
+// REPLACES removed_length BYTES AT offset WITH inserted, offset COUNTS IN THE EDITED TEXT.
+// EXITS LIKE A FULL PARSE WHEN THE RE-PARSED LINES HAVE A SYNTAX ERROR
+void edit_document(struct Document* document, long offset, long removed_length, const char* inserted, long inserted_length);
+// JOINS THE STATEMENTS OF ALL RANGES, WHICH TAKES AS LONG AS ANY PASS OVER THE WHOLE PROGRAM
+struct Program* get_document_program(struct Document* document);
+long get_document_size(const struct Document* document);
+// buffer NEEDS get_document_size BYTES
+void copy_document_text(const struct Document* document, char* buffer);
+struct SourcePosition get_document_position(const struct Document* document, long offset);
+void close_document(struct Document* document);
+
+#endif
@@ -0,0 +1,263 @@
+#include "flat_ast.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+static void* grow_array(void* items, int* capacity, int needed, size_t item_size);
+static int add_node(struct FlatAst* ast, enum AstNodeType node_type, const struct Token* token);
+static int add_token(struct FlatAst* ast, const struct Token* token);
+static int reserve_extra(struct FlatAst* ast, int count);
+static int reserve_list(struct FlatAst* ast, int count);
+static int flatten_expression(struct FlatAst* ast, const struct AstNode* node);
+static int flatten_expressions(struct FlatAst* ast, const struct ExpessionsList* list);
+static int flatten_statement(struct FlatAst* ast, const struct AstNode* node);
+static int flatten_statements(struct FlatAst* ast, const struct StatementsList* list);
+
+static void* grow_array(void* items, int* capacity, int needed, size_t item_size) {
+    if (needed <= *capacity) {
+        return items;
+    }
+
+    int new_capacity = *capacity == 0 ? 64 : *capacity * 2;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+
+    items = realloc(items, new_capacity * item_size);
+    if (items == NULL) {
+        printf("Out of memory flattening the AST \n");
+        exit(1);
+    }
+
+    *capacity = new_capacity;
+    return items;
+}
+
+static int add_token(struct FlatAst* ast, const struct Token* token) {
+    if (token == NULL) {
+        return -1;
+    }
+
+    ast->tokens = (struct Token*)grow_array(ast->tokens, &ast->token_capacity, ast->token_count + 1, sizeof(struct Token));
+    ast->tokens[ast->token_count] = *token;
+    return ast->token_count++;
+}
+
+static int add_node(struct FlatAst* ast, enum AstNodeType node_type, const struct Token* token) {
+    ast->nodes = (struct FlatNode*)grow_array(ast->nodes, &ast->node_capacity, ast->node_count + 1, sizeof(struct FlatNode));
+
+    struct FlatNode* node = &ast->nodes[ast->node_count];
+    node->node_type = (unsigned char)node_type;
+    node->token_type = 0;
+    node->token = add_token(ast, token);
+    node->first = -1;
+    node->second = -1;
+
+    return ast->node_count++;
+}
+
+static int reserve_extra(struct FlatAst* ast, int count) {
+    ast->extra = (int*)grow_array(ast->extra, &ast->extra_capacity, ast->extra_count + count, sizeof(int));
+    int start = ast->extra_count;
+    ast->extra_count += count;
+    return start;
+}
+
+// NODES ARE ADDED PARENT FIRST, SO A PASS OVER THE TREE MOSTLY MOVES FORWARD THROUGH nodes.
+// INDICES ARE KEPT INSTEAD OF POINTERS SINCE THE ARRAYS MOVE AS THEY GROW
+static int flatten_expression(struct FlatAst* ast, const struct AstNode* node) {
+    if (node == NULL) {
+        return -1;
+    }
+
+    int index;
+    switch (node->node_type)
+    {
+    case IDENTIFIER_EXPRESSION:
+        index = add_node(ast, IDENTIFIER_EXPRESSION, node->identifier_expression.token);
+        ast->nodes[index].first = node->identifier_expression.slot;
+        ast->nodes[index].second = node->identifier_expression.identifier_id;
+        return index;
+    case CONST_NUMBER_EXPRESSION:
+        index = add_node(ast, CONST_NUMBER_EXPRESSION, node->const_number_expression.token);
+        ast->numbers = (struct NumberValue*)grow_array(ast->numbers, &ast->number_capacity,
+            ast->number_count + 1, sizeof(struct NumberValue));
+        ast->numbers[ast->number_count] = node->const_number_expression.value;
+        ast->nodes[index].first = ast->number_count++;
+        return index;
+    case CONST_STRING_EXPRESSION:
+        // FOLDED STRINGS HAVE NO TEXT IN THE SOURCE, SO THE CHARACTERS ARE KEPT AND NOT THE TOKEN'S
+        index = add_node(ast, CONST_STRING_EXPRESSION, node->const_string_expression.token);
+        ast->strings = (struct FlatString*)grow_array(ast->strings, &ast->string_capacity,
+            ast->string_count + 1, sizeof(struct FlatString));
+        ast->strings[ast->string_count].chars = node->const_string_expression.value;
+        ast->strings[ast->string_count].length = node->const_string_expression.length;
+        ast->nodes[index].first = ast->string_count++;
+        return index;
+    case PREFIX_EXPRESSION: {
+        index = add_node(ast, PREFIX_EXPRESSION, node->prefix_expression.operator);
+        ast->nodes[index].token_type = (unsigned char)node->prefix_expression.operator->token_type;
+        int value = flatten_expression(ast, node->prefix_expression.value);
+        ast->nodes[index].first = value;
+        return index;
+    }
+    case INFIX_EXPRESSION: {
+        index = add_node(ast, INFIX_EXPRESSION, node->infix_expression.operator);
+        ast->nodes[index].token_type = (unsigned char)node->infix_expression.operator->token_type;
+        int left = flatten_expression(ast, node->infix_expression.left);
+        int right = flatten_expression(ast, node->infix_expression.right);
+        ast->nodes[index].first = left;
+        ast->nodes[index].second = right;
+        return index;
+    }
+    default:
+        printf("Node %d is not an expression \n", node->node_type);
+        exit(601);
+    }
+}
+
+// A LIST'S RUN IN children IS RESERVED BEFORE ITS ITEMS ADD THE RUNS OF THEIR OWN LISTS
+static int reserve_list(struct FlatAst* ast, int count) {
+    ast->lists = (struct FlatList*)grow_array(ast->lists, &ast->list_capacity, ast->list_count + 1, sizeof(struct FlatList));
+    ast->lists[ast->list_count].start = ast->child_count;
+    ast->lists[ast->list_count].count = count;
+
+    ast->children = (int*)grow_array(ast->children, &ast->child_capacity, ast->child_count + count, sizeof(int));
+    ast->child_count += count;
+
+    return ast->list_count++;
+}
+
+static int flatten_expressions(struct FlatAst* ast, const struct ExpessionsList* list) {
+    int list_index = reserve_list(ast, (int)list->size);
+    int start = ast->lists[list_index].start;
+    for (long i = 0;i < list->size;i++) {
+        int child = flatten_expression(ast, &list->expressions[i]);
+        ast->children[start + i] = child;
+    }
+
+    return list_index;
+}
+
+static int flatten_statements(struct FlatAst* ast, const struct StatementsList* list) {
+    if (list == NULL) {
+        return -1;
+    }
+
+    int list_index = reserve_list(ast, (int)list->size);
+    int start = ast->lists[list_index].start;
+    for (long i = 0;i < list->size;i++) {
+        int child = flatten_statement(ast, &list->statements[i]);
+        ast->children[start + i] = child;
+    }
+
+    return list_index;
+}
+
+static int flatten_statement(struct FlatAst* ast, const struct AstNode* node) {
+    int index;
+    switch (node->node_type)
+    {
+    case ASSIGN_STATEMENT: {
+        index = add_node(ast, ASSIGN_STATEMENT, NULL);
+        int identifier = flatten_expression(ast, node->assign_statement.identifier);
+        int value = flatten_expression(ast, node->assign_statement.expression);
+        ast->nodes[index].first = identifier;
+        ast->nodes[index].second = value;
+        return index;
+    }
+    case PRINT_STATEMENT: {
+        const struct PrintStatement* statement = &node->print_statement;
+        index = add_node(ast, PRINT_STATEMENT, statement->token);
+
+        int count = (int)statement->expressions.size;
+        ast->separators = (unsigned char*)grow_array(ast->separators, &ast->separator_capacity,
+            ast->separator_count + count, sizeof(unsigned char));
+        int separators = ast->separator_count;
+        for (int i = 0;i < count;i++) {
+            ast->separators[separators + i] = (unsigned char)statement->separators[i];
+        }
+        ast->separator_count += count;
+
+        int expressions = flatten_expressions(ast, &statement->expressions);
+        ast->nodes[index].first = expressions;
+        ast->nodes[index].second = separators;
+        return index;
+    }
+    case IF_STATEMENT: {
+        index = add_node(ast, IF_STATEMENT, node->if_statement.token);
+        int extra = reserve_extra(ast, 2);
+        int condition = flatten_expression(ast, node->if_statement.condition_expression);
+        int body = flatten_statements(ast, node->if_statement.body);
+        int elses = flatten_statements(ast, node->if_statement.elses);
+        ast->nodes[index].first = condition;
+        ast->nodes[index].second = extra;
+        ast->extra[extra] = body;
+        ast->extra[extra + 1] = elses;
+        return index;
+    }
+    case LOOP_STATEMENT: {
+        index = add_node(ast, LOOP_STATEMENT, node->loop_statement.token);
+        ast->nodes[index].token_type = (unsigned char)node->loop_statement.loop_type_token->token_type;
+        int condition = flatten_expression(ast, node->loop_statement.condition_expression);
+        int body = flatten_statements(ast, node->loop_statement.body);
+        ast->nodes[index].first = condition;
+        ast->nodes[index].second = body;
+        return index;
+    }
+    case FOR_STATEMENT: {
+        const struct ForStatement* statement = &node->for_statement;
+        index = add_node(ast, FOR_STATEMENT, statement->token);
+        int extra = reserve_extra(ast, 4);
+        int control = flatten_expression(ast, statement->control_identifier_expression);
+        int initial = flatten_expression(ast, statement->initial_expression);
+        int end_value = flatten_expression(ast, statement->end_value_expression);
+        int step = flatten_expression(ast, statement->step_expression);
+        int body = flatten_statements(ast, statement->body);
+        ast->nodes[index].first = control;
+        ast->nodes[index].second = extra;
+        ast->extra[extra] = initial;
+        ast->extra[extra + 1] = end_value;
+        ast->extra[extra + 2] = step;
+        ast->extra[extra + 3] = body;
+        return index;
+    }
+    case DEF_TYPE_STATEMENT:
+        index = add_node(ast, DEF_TYPE_STATEMENT, node->def_type_statement.token);
+        ast->nodes[index].first = (int)node->def_type_statement.letters;
+        return index;
+    default:
+        printf("Node %d is not a statement \n", node->node_type);
+        exit(602);
+    }
+}
+
+struct FlatAst flatten_program(const struct Program* program) {
+    struct FlatAst ast = {0};
+    ast.source = program->source;
+    ast.statements = flatten_statements(&ast, program->list);
+
+    return ast;
+}
+
+size_t get_flat_ast_size(const struct FlatAst* ast) {
+    return ast->node_count * sizeof(struct FlatNode)
+        + ast->list_count * sizeof(struct FlatList)
+        + ast->child_count * sizeof(int)
+        + ast->extra_count * sizeof(int)
+        + ast->token_count * sizeof(struct Token)
+        + ast->number_count * sizeof(struct NumberValue)
+        + ast->string_count * sizeof(struct FlatString)
+        + ast->separator_count * sizeof(unsigned char);
+}
+
+void free_flat_ast(struct FlatAst* ast) {
+    free(ast->nodes);
+    free(ast->lists);
+    free(ast->children);
+    free(ast->extra);
+    free(ast->tokens);
+    free(ast->numbers);
+    free(ast->strings);
+    free(ast->separators);
+    *ast = (struct FlatAst){0};
+}
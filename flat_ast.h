@@ -0,0 +1,85 @@
+#ifndef FLAT_AST_H_
+#define FLAT_AST_H_
+
+#include "parser.h"
+
+// THE SAME TREE AS Program WITH EVERY NODE IN ONE ARRAY AND CHILDREN REFERENCED BY INDEX,
+// -1 STANDS FOR A MISSING CHILD. STRINGS STILL POINT INTO THE PROGRAM, WHICH MUST OUTLIVE IT.
+// WHAT first AND second HOLD DEPENDS ON node_type:
+//   IDENTIFIER_EXPRESSION  first = slot, second = interned identifier id
+//   CONST_NUMBER_EXPRESSION first = index into numbers
+//   CONST_STRING_EXPRESSION first = index into strings
+//   PREFIX_EXPRESSION      first = operand
+//   INFIX_EXPRESSION       first = left, second = right
+//   ASSIGN_STATEMENT       first = identifier, second = value
+//   PRINT_STATEMENT        first = list of expressions, second = index into separators
+//   IF_STATEMENT           first = condition, -1 for ELSE, second = index into extra of
+//                          the body list and the list of ELSEIF and ELSE branches
+//   LOOP_STATEMENT         first = condition, second = body list
+//   FOR_STATEMENT          first = control identifier, second = index into extra of
+//                          the initial value, end value, step and body list
+//   DEF_TYPE_STATEMENT     first = letter bits
+struct FlatNode {
+    unsigned char node_type;
+    // THE OPERATOR OF PREFIX AND INFIX EXPRESSIONS, WHILE OR UNTIL FOR LOOPS
+    unsigned char token_type;
+    // INDEX INTO tokens
+    int token;
+    int first;
+    int second;
+};
+
+struct FlatString {
+    const char* chars;
+    long length;
+};
+
+// A LIST IS A RUN OF NODE INDICES IN children
+struct FlatList {
+    int start;
+    int count;
+};
+
+struct FlatAst {
+    const char* source;
+    struct FlatNode* nodes;
+    int node_count;
+    int node_capacity;
+
+    struct FlatList* lists;
+    int list_count;
+    int list_capacity;
+    int* children;
+    int child_count;
+    int child_capacity;
+
+    int* extra;
+    int extra_count;
+    int extra_capacity;
+
+    struct Token* tokens;
+    int token_count;
+    int token_capacity;
+
+    struct NumberValue* numbers;
+    int number_count;
+    int number_capacity;
+
+    struct FlatString* strings;
+    int string_count;
+    int string_capacity;
+
+    // SEMICOLON, COMMA OR NEW_LINE AFTER EACH PRINT EXPRESSION
+    unsigned char* separators;
+    int separator_count;
+    int separator_capacity;
+
+    // THE LIST OF TOP LEVEL STATEMENTS
+    int statements;
+};
+
+struct FlatAst flatten_program(const struct Program* program);
+size_t get_flat_ast_size(const struct FlatAst* ast);
+void free_flat_ast(struct FlatAst* ast);
+
+#endif
@@ -0,0 +1,122 @@
+#include "keyword_list.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+// WRITES keyword_table.h: THE ASSOCIATED VALUES OF A PERFECT HASH OVER KEYWORD_LIST AND THE
+// TABLE IT INDEXES. THE SEARCH IS SEEDED, SO THE SAME LIST ALWAYS GIVES THE SAME TABLE
+#define MAX_ATTEMPTS 10000000
+
+struct KeywordEntry {
+    const char* word;
+    const char* token_type;
+};
+
+static const struct KeywordEntry keywords[] = {
+#define KEYWORD(word, token_type) {#word, #token_type},
+    KEYWORD_LIST
+#undef KEYWORD
+};
+
+#define KEYWORD_COUNT ((int)(sizeof(keywords) / sizeof(keywords[0])))
+
+static uint32_t random_state = 2463534242u;
+
+static uint32_t next_random(void);
+static unsigned int hash_keyword(const unsigned char* values, const char* text, long length);
+static int place_keywords(const unsigned char* values, int* slots);
+
+// XORSHIFT, SO THE OUTPUT DOESN'T DEPEND ON THE C LIBRARY
+static uint32_t next_random(void) {
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+// MUST MATCH hash_keyword IN keywords.c
+static unsigned int hash_keyword(const unsigned char* values, const char* text, long length) {
+    return (unsigned int)(
+        length +
+        values[(unsigned char)text[0]] +
+        values[(unsigned char)text[1]] +
+        values[(unsigned char)text[length / 2]] +
+        values[(unsigned char)text[length - 1]]
+    ) % KEYWORD_TABLE_SIZE;
+}
+
+// RETURNS 1 WHEN NO TWO KEYWORDS SHARE A SLOT
+static int place_keywords(const unsigned char* values, int* slots) {
+    int used[KEYWORD_TABLE_SIZE] = {0};
+    for (int i = 0;i < KEYWORD_COUNT;i++) {
+        slots[i] = (int)hash_keyword(values, keywords[i].word, (long)strlen(keywords[i].word));
+        if (used[slots[i]]) {
+            return 0;
+        }
+        used[slots[i]] = 1;
+    }
+
+    return 1;
+}
+
+int main(void) {
+    // ONLY THE LETTERS THE HASH READS GET A VALUE
+    int is_hashed[256] = {0};
+    int min_length = 256;
+    int max_length = 0;
+    for (int i = 0;i < KEYWORD_COUNT;i++) {
+        const char* word = keywords[i].word;
+        int length = (int)strlen(word);
+        is_hashed[(unsigned char)word[0]] = 1;
+        is_hashed[(unsigned char)word[1]] = 1;
+        is_hashed[(unsigned char)word[length / 2]] = 1;
+        is_hashed[(unsigned char)word[length - 1]] = 1;
+        min_length = length < min_length ? length : min_length;
+        max_length = length > max_length ? length : max_length;
+    }
+
+    unsigned char values[256];
+    int slots[KEYWORD_COUNT];
+    int found = 0;
+    for (int attempt = 0;attempt < MAX_ATTEMPTS && !found;attempt++) {
+        memset(values, 0, sizeof(values));
+        for (int c = 0;c < 256;c++) {
+            if (is_hashed[c]) {
+                values[c] = (unsigned char)(next_random() % KEYWORD_TABLE_SIZE);
+            }
+        }
+        found = place_keywords(values, slots);
+    }
+
+    if (!found) {
+        fprintf(stderr, "No perfect hash for %d keywords in %d slots, raise KEYWORD_TABLE_SIZE \n",
+            KEYWORD_COUNT, KEYWORD_TABLE_SIZE);
+        return 1;
+    }
+
+    printf("// GENERATED BY gen_keywords.c FROM keyword_list.h, RUN make keywords INSTEAD OF EDITING IT\n\n");
+    printf("#define MIN_KEYWORD_LENGTH %d\n", min_length);
+    printf("#define MAX_KEYWORD_LENGTH %d\n\n", max_length);
+
+    printf("static const unsigned char associated_values[256] = {");
+    int printed = 0;
+    for (int c = 0;c < 256;c++) {
+        if (values[c] != 0) {
+            printf(printed % 6 == 0 ? "\n    ['%c'] = %d," : " ['%c'] = %d,", c, values[c]);
+            printed++;
+        }
+    }
+    printf("\n};\n\n");
+
+    printf("static const struct Keyword keyword_table[KEYWORD_TABLE_SIZE] = {\n");
+    for (int slot = 0;slot < KEYWORD_TABLE_SIZE;slot++) {
+        for (int i = 0;i < KEYWORD_COUNT;i++) {
+            if (slots[i] == slot) {
+                printf("    [%d] = {\"%s\", %d, %s},\n", slot, keywords[i].word, (int)strlen(keywords[i].word), keywords[i].token_type);
+            }
+        }
+    }
+    printf("};\n");
+
+    return 0;
+}
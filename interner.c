@@ -0,0 +1,205 @@
+#include "interner.h"
+#include "arena.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <ctype.h>
+#include <pthread.h>
+#include <string.h>
+
+#define INITIAL_SLOT_COUNT 1024
+#define EMPTY_SLOT -1
+// POWER OF TWO, THE CACHE IS INDEXED WITH A MASK
+#define THREAD_CACHE_SIZE 256
+
+struct Interner {
+    struct InternedIdentifier* identifiers;
+    int count;
+    int capacity;
+
+    int* slots;
+    unsigned int slot_count;
+
+    struct Arena* names;
+};
+
+static struct Interner interner = {NULL, 0, 0, NULL, 0, NULL};
+
+// FILES ARE LEXED ON SEVERAL THREADS, ONLY INTERNING AND COUNTING TAKE THE LOCK
+// BECAUSE NAMES ARE ONLY LOOKED UP AGAIN ONCE EVERY FILE IS PARSED
+static pthread_mutex_t interner_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// NAMES NEVER MOVE ONCE INTERNED, SO EACH THREAD REMEMBERS THE ONES IT SAW LAST AND
+// ONLY TAKES THE LOCK FOR NAMES THAT ARE NOT IN ITS CACHE
+struct CachedIdentifier {
+    const char* name;
+    long length;
+    unsigned int hash;
+    int id;
+};
+
+static _Thread_local struct CachedIdentifier thread_cache[THREAD_CACHE_SIZE];
+static _Thread_local unsigned int thread_cache_generation;
+static unsigned int interner_generation = 1;
+
+static unsigned int hash_identifier(const char* text, long length);
+static int identifier_matches(const struct InternedIdentifier* identifier, const char* text, long length);
+static void grow_slots(void);
+static int add_identifier(const char* text, long length, unsigned int hash);
+
+static unsigned int hash_identifier(const char* text, long length) {
+    unsigned int hash = 2166136261u;
+    for (long i = 0;i < length;i++) {
+        hash ^= (unsigned char)tolower((unsigned char)text[i]);
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static int identifier_matches(const struct InternedIdentifier* identifier, const char* text, long length) {
+    if (identifier->length != length) {
+        return 0;
+    }
+
+    for (long i = 0;i < length;i++) {
+        if (identifier->name[i] != tolower((unsigned char)text[i])) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static void grow_slots(void) {
+    unsigned int slot_count = interner.slot_count == 0 ? INITIAL_SLOT_COUNT : 2 * interner.slot_count;
+    int* slots = (int*)malloc(slot_count * sizeof(int));
+    if (slots == NULL) {
+        printf("Out of memory growing identifier table \n");
+        exit(1);
+    }
+
+    for (unsigned int i = 0;i < slot_count;i++) {
+        slots[i] = EMPTY_SLOT;
+    }
+
+    for (int id = 0;id < interner.count;id++) {
+        unsigned int slot = interner.identifiers[id].hash & (slot_count - 1);
+        while (slots[slot] != EMPTY_SLOT) {
+            slot = (slot + 1) & (slot_count - 1);
+        }
+
+        slots[slot] = id;
+    }
+
+    free(interner.slots);
+    interner.slots = slots;
+    interner.slot_count = slot_count;
+}
+
+static int add_identifier(const char* text, long length, unsigned int hash) {
+    if (interner.names == NULL) {
+        interner.names = new_arena(0);
+    }
+
+    if (interner.count >= interner.capacity) {
+        int capacity = interner.capacity == 0 ? 256 : 2 * interner.capacity;
+        interner.identifiers = (struct InternedIdentifier*)realloc(
+            interner.identifiers,
+            capacity * sizeof(struct InternedIdentifier)
+        );
+        interner.capacity = capacity;
+    }
+
+    char* name = (char*)arena_alloc(interner.names, length + 1);
+    for (long i = 0;i < length;i++) {
+        name[i] = (char)tolower((unsigned char)text[i]);
+    }
+    name[length] = 0;
+
+    struct InternedIdentifier* identifier = &interner.identifiers[interner.count];
+    identifier->name = name;
+    identifier->length = length;
+    identifier->hash = hash;
+
+    return interner.count++;
+}
+
+int intern_identifier(const char* text, long length) {
+    unsigned int hash = hash_identifier(text, length);
+
+    // free_interner BUMPS THE GENERATION, WHICH DROPS EVERY THREAD'S CACHED NAMES
+    struct CachedIdentifier* cached = &thread_cache[hash & (THREAD_CACHE_SIZE - 1)];
+    if (thread_cache_generation != __atomic_load_n(&interner_generation, __ATOMIC_ACQUIRE)) {
+        memset(thread_cache, 0, sizeof(thread_cache));
+        thread_cache_generation = __atomic_load_n(&interner_generation, __ATOMIC_ACQUIRE);
+    }
+
+    if (cached->name != NULL && cached->hash == hash) {
+        struct InternedIdentifier identifier = {cached->name, cached->length, cached->hash};
+        if (identifier_matches(&identifier, text, length)) {
+            return cached->id;
+        }
+    }
+
+    pthread_mutex_lock(&interner_lock);
+
+    // KEEP THE LOAD FACTOR UNDER ONE HALF
+    if (2 * (unsigned int)(interner.count + 1) > interner.slot_count) {
+        grow_slots();
+    }
+
+    unsigned int slot = hash & (interner.slot_count - 1);
+    while (interner.slots[slot] != EMPTY_SLOT) {
+        const struct InternedIdentifier* identifier = &interner.identifiers[interner.slots[slot]];
+        if (identifier->hash == hash && identifier_matches(identifier, text, length)) {
+            int id = interner.slots[slot];
+            *cached = (struct CachedIdentifier){identifier->name, identifier->length, hash, id};
+            pthread_mutex_unlock(&interner_lock);
+            return id;
+        }
+
+        slot = (slot + 1) & (interner.slot_count - 1);
+    }
+
+    int id = add_identifier(text, length, hash);
+    interner.slots[slot] = id;
+    *cached = (struct CachedIdentifier){interner.identifiers[id].name, length, hash, id};
+    pthread_mutex_unlock(&interner_lock);
+
+    return id;
+}
+
+const struct InternedIdentifier* get_interned_identifier(int identifier_id) {
+    if (identifier_id < 0 || identifier_id >= interner.count) {
+        return NULL;
+    }
+
+    return &interner.identifiers[identifier_id];
+}
+
+const char* get_identifier_name(int identifier_id) {
+    const struct InternedIdentifier* identifier = get_interned_identifier(identifier_id);
+    return identifier != NULL ? identifier->name : NULL;
+}
+
+int get_identifier_count(void) {
+    pthread_mutex_lock(&interner_lock);
+    int count = interner.count;
+    pthread_mutex_unlock(&interner_lock);
+
+    return count;
+}
+
+void free_interner(void) {
+    free(interner.identifiers);
+    free(interner.slots);
+    free_arena(interner.names);
+
+    interner.identifiers = NULL;
+    interner.count = 0;
+    interner.capacity = 0;
+    interner.slots = NULL;
+    interner.slot_count = 0;
+    interner.names = NULL;
+    __atomic_add_fetch(&interner_generation, 1, __ATOMIC_RELEASE);
+}
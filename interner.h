@@ -0,0 +1,16 @@
+#ifndef INTERNER_H_
+#define INTERNER_H_
+
+struct InternedIdentifier {
+    const char* name;
+    long length;
+    unsigned int hash;
+};
+
+int intern_identifier(const char* text, long length);
+const struct InternedIdentifier* get_interned_identifier(int identifier_id);
+const char* get_identifier_name(int identifier_id);
+int get_identifier_count(void);
+void free_interner(void);
+
+#endif
@@ -0,0 +1,559 @@
+#define _DEFAULT_SOURCE
+
+#include "jit.h"
+#include "numbers.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <limits.h>
+
+#if defined(__x86_64__) && defined(__unix__)
+#define JIT_X86_64 1
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// THE OPERAND STACK LIVES IN %xmm0..%xmm13 BY DEPTH, %xmm14 AND %xmm15 ARE SCRATCH
+#define JIT_STACK_REGISTERS 14
+#define JIT_FAILED INT_MIN
+
+struct Jit {
+    const struct Chunk* chunk;
+    // INDEXED BY THE BYTECODE OFFSET OF A LOOP'S BACK EDGE
+    int* back_edge_counts;
+    JitFunction* functions;
+
+    void** mappings;
+    size_t* mapping_sizes;
+    int mapping_count;
+    int mapping_capacity;
+};
+
+int is_jit_supported(void) {
+#ifdef JIT_X86_64
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+struct Jit* new_jit(const struct Chunk* chunk) {
+    struct Jit* jit = (struct Jit*)calloc(1, sizeof(struct Jit));
+    jit->chunk = chunk;
+    jit->back_edge_counts = (int*)calloc(chunk->code_length + 1, sizeof(int));
+    jit->functions = (JitFunction*)calloc(chunk->code_length + 1, sizeof(JitFunction));
+
+    return jit;
+}
+
+#ifdef JIT_X86_64
+
+enum JitStub {
+    EXIT_STUB,
+    DIVISION_BY_ZERO_STUB,
+    NOT_ENTERED_STUB,
+    OVERFLOW_STUB,
+    STUB_COUNT,
+};
+
+struct CodeBuffer {
+    uint8_t* bytes;
+    long length;
+    long capacity;
+};
+
+// A rel32 THAT JUMPS TO A BYTECODE OFFSET, OR TO A STUB WHEN target IS NEGATIVE
+struct JumpPatch {
+    long position;
+    long target;
+};
+
+struct LoopCompiler {
+    const struct Chunk* chunk;
+
+    struct CodeBuffer code;
+    long* native_offsets;
+    int* is_jump_target;
+    int* used_slots;
+
+    struct JumpPatch* patches;
+    int patch_count;
+    int patch_capacity;
+};
+
+static void emit_byte(struct CodeBuffer* code, uint8_t byte);
+static void emit_int32(struct CodeBuffer* code, int32_t value);
+static void emit_sse(struct CodeBuffer* code, uint8_t prefix, int rex_w, uint8_t opcode, int reg, int rm);
+static void emit_sse_slot(struct LoopCompiler* compiler, uint8_t prefix, uint8_t opcode, int reg, int32_t slot);
+static void emit_load_constant(struct CodeBuffer* code, int reg, double value);
+static long emit_short_jump(struct CodeBuffer* code, uint8_t opcode);
+static void patch_short_jump(struct CodeBuffer* code, long position);
+static void emit_jump(struct LoopCompiler* compiler, uint8_t condition, long target);
+static int32_t get_slot_displacement(int32_t slot, size_t field);
+static int compile_instruction(struct LoopCompiler* compiler, long offset, int* depth);
+static JitFunction compile_loop(struct Jit* jit, long loop_start, long loop_end);
+
+static void emit_byte(struct CodeBuffer* code, uint8_t byte) {
+    if (code->length == code->capacity) {
+        code->capacity = code->capacity == 0 ? 256 : code->capacity * 2;
+        code->bytes = (uint8_t*)realloc(code->bytes, code->capacity);
+    }
+
+    code->bytes[code->length++] = byte;
+}
+
+static void emit_int32(struct CodeBuffer* code, int32_t value) {
+    uint8_t bytes[sizeof(int32_t)];
+    memcpy(bytes, &value, sizeof(bytes));
+    for (size_t i = 0;i < sizeof(bytes);i++) {
+        emit_byte(code, bytes[i]);
+    }
+}
+
+static void emit_sse(struct CodeBuffer* code, uint8_t prefix, int rex_w, uint8_t opcode, int reg, int rm) {
+    // REGISTER TO REGISTER FORM: [PREFIX] [REX] 0F opcode MODRM
+    if (prefix != 0) {
+        emit_byte(code, prefix);
+    }
+
+    uint8_t rex = 0x40 | (rex_w << 3) | ((reg >> 3) << 2) | (rm >> 3);
+    if (rex != 0x40) {
+        emit_byte(code, rex);
+    }
+
+    emit_byte(code, 0x0F);
+    emit_byte(code, opcode);
+    emit_byte(code, 0xC0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+static int32_t get_slot_displacement(int32_t slot, size_t field) {
+    return (int32_t)(slot * sizeof(struct Value) + field);
+}
+
+static void emit_sse_slot(struct LoopCompiler* compiler, uint8_t prefix, uint8_t opcode, int reg, int32_t slot) {
+    // MEMORY FORM ADDRESSING THE SLOT'S NUMBER AS disp32(%rdi)
+    struct CodeBuffer* code = &compiler->code;
+    compiler->used_slots[slot] = 1;
+
+    emit_byte(code, prefix);
+    if (reg >= 8) {
+        emit_byte(code, 0x44);
+    }
+    emit_byte(code, 0x0F);
+    emit_byte(code, opcode);
+    emit_byte(code, 0x80 | ((reg & 7) << 3) | 7);
+    emit_int32(code, get_slot_displacement(slot, offsetof(struct Value, number)));
+}
+
+static void emit_load_constant(struct CodeBuffer* code, int reg, double value) {
+    // movabs $bits, %rax; movq %rax, %xmm<reg>
+    uint8_t bits[sizeof(double)];
+    memcpy(bits, &value, sizeof(bits));
+
+    emit_byte(code, 0x48);
+    emit_byte(code, 0xB8);
+    for (size_t i = 0;i < sizeof(bits);i++) {
+        emit_byte(code, bits[i]);
+    }
+    emit_sse(code, 0x66, 1, 0x6E, reg, 0);
+}
+
+static long emit_short_jump(struct CodeBuffer* code, uint8_t opcode) {
+    emit_byte(code, opcode);
+    emit_byte(code, 0);
+    return code->length;
+}
+
+static void patch_short_jump(struct CodeBuffer* code, long position) {
+    code->bytes[position - 1] = (uint8_t)(code->length - position);
+}
+
+static void emit_jump(struct LoopCompiler* compiler, uint8_t condition, long target) {
+    // condition IS THE LOW NIBBLE OF A Jcc OPCODE, 0xFF MEANS AN UNCONDITIONAL jmp
+    struct CodeBuffer* code = &compiler->code;
+    if (condition == 0xFF) {
+        emit_byte(code, 0xE9);
+    } else {
+        emit_byte(code, 0x0F);
+        emit_byte(code, 0x80 | condition);
+    }
+
+    if (compiler->patch_count == compiler->patch_capacity) {
+        compiler->patch_capacity = compiler->patch_capacity == 0 ? 16 : compiler->patch_capacity * 2;
+        compiler->patches = (struct JumpPatch*)realloc(compiler->patches, compiler->patch_capacity * sizeof(struct JumpPatch));
+    }
+
+    compiler->patches[compiler->patch_count].position = code->length;
+    compiler->patches[compiler->patch_count].target = target;
+    compiler->patch_count++;
+    emit_int32(code, 0);
+}
+
+#define JUMP_ALWAYS 0xFF
+#define CONDITION_BELOW 0x2
+#define CONDITION_EQUAL 0x4
+#define CONDITION_NOT_EQUAL 0x5
+#define CONDITION_ABOVE 0x7
+#define CONDITION_PARITY 0xA
+
+#define SSE_MOVSD 0x10
+#define SSE_MOVSD_STORE 0x11
+#define SSE_ADDSD 0x58
+#define SSE_MULSD 0x59
+#define SSE_SUBSD 0x5C
+#define SSE_DIVSD 0x5E
+#define SSE_UCOMISD 0x2E
+#define SSE_ANDPD 0x54
+#define SSE_XORPD 0x57
+#define SSE_MOVAPD 0x28
+#define SSE_CMPSD 0xC2
+#define SSE_CVTSD2SS 0x5A
+#define SSE_CVTSI2SD 0x2A
+#define SSE_CVTSD2SI 0x2D
+
+static int compile_instruction(struct LoopCompiler* compiler, long offset, int* depth) {
+    // RETURNS 0 FOR ANYTHING THE INTERPRETER HAS TO RUN: STRINGS, PRINT, JUMPS LEAVING THE LOOP
+    const struct Chunk* chunk = compiler->chunk;
+    struct CodeBuffer* code = &compiler->code;
+    enum OpCode op = (enum OpCode)chunk->code[offset];
+    const uint8_t* operands = chunk->code + offset + 1;
+    int32_t a = get_operand_count(op) > 0 ? read_operand(operands) : 0;
+    int32_t b = get_operand_count(op) > 1 ? read_operand(operands + sizeof(int32_t)) : 0;
+    int32_t c = get_operand_count(op) > 2 ? read_operand(operands + 2 * sizeof(int32_t)) : 0;
+    int top = *depth - 1;
+
+    switch (op)
+    {
+    case OP_CONSTANT:
+        if (chunk->constants[a].type != NUMBER_VALUE || *depth >= JIT_STACK_REGISTERS) {
+            return 0;
+        }
+        emit_load_constant(code, *depth, chunk->constants[a].number);
+        (*depth)++;
+        return 1;
+    case OP_LOAD:
+        if (*depth >= JIT_STACK_REGISTERS) {
+            return 0;
+        }
+        emit_sse_slot(compiler, 0xF2, SSE_MOVSD, *depth, a);
+        (*depth)++;
+        return 1;
+    case OP_STORE:
+        emit_sse_slot(compiler, 0xF2, SSE_MOVSD_STORE, top, a);
+        (*depth)--;
+        return 1;
+    case OP_ADD:
+    case OP_SUBTRACT:
+    case OP_MULTIPLY:
+    case OP_DIVIDE: {
+        if (op == OP_DIVIDE) {
+            // ucomisd TREATS NAN AS UNORDERED, THE VM ONLY REJECTS AN EXACT ZERO
+            emit_sse(code, 0x66, 0, SSE_XORPD, 15, 15);
+            emit_sse(code, 0x66, 0, SSE_UCOMISD, top, 15);
+            long skip = emit_short_jump(code, 0x70 | CONDITION_PARITY);
+            emit_jump(compiler, CONDITION_EQUAL, -1 - DIVISION_BY_ZERO_STUB);
+            patch_short_jump(code, skip);
+        }
+
+        uint8_t opcode = op == OP_ADD ? SSE_ADDSD : op == OP_SUBTRACT ? SSE_SUBSD : op == OP_MULTIPLY ? SSE_MULSD : SSE_DIVSD;
+        emit_sse(code, 0xF2, 0, opcode, top - 1, top);
+        (*depth)--;
+        return 1;
+    }
+    case OP_NEGATE:
+        emit_load_constant(code, 15, -0.0);
+        emit_sse(code, 0x66, 0, SSE_XORPD, top, 15);
+        return 1;
+    case OP_NOT:
+        // cvttsd2si %xmm, %rax; notq %rax; cvtsi2sdq %rax, %xmm
+        emit_sse(code, 0xF2, 1, 0x2C, 0, top);
+        emit_byte(code, 0x48);
+        emit_byte(code, 0xF7);
+        emit_byte(code, 0xD0);
+        emit_sse(code, 0xF2, 1, SSE_CVTSI2SD, top, 0);
+        return 1;
+    case OP_CONVERT:
+        if (a == SINGLE_NUMBER) {
+            // cvtsd2ss AND BACK WITH cvtss2sd
+            emit_sse(code, 0xF2, 0, SSE_CVTSD2SS, top, top);
+            emit_sse(code, 0xF3, 0, SSE_CVTSD2SS, top, top);
+        } else if (a == INTEGER_NUMBER || a == LONG_NUMBER) {
+            // cvtsd2si ROUNDS HALF TO EVEN UNDER THE DEFAULT MXCSR AND TURNS NAN INTO
+            // 0x8000000000000000, SO ONE SIGN EXTENSION CHECK COVERS EVERY OVERFLOW
+            emit_sse(code, 0xF2, 1, SSE_CVTSD2SI, 0, top);
+            if (a == INTEGER_NUMBER) {
+                // movswq %ax, %rcx
+                emit_byte(code, 0x48);
+                emit_byte(code, 0x0F);
+                emit_byte(code, 0xBF);
+                emit_byte(code, 0xC8);
+            } else {
+                // movslq %eax, %rcx
+                emit_byte(code, 0x48);
+                emit_byte(code, 0x63);
+                emit_byte(code, 0xC8);
+            }
+            // cmpq %rax, %rcx
+            emit_byte(code, 0x48);
+            emit_byte(code, 0x39);
+            emit_byte(code, 0xC1);
+            emit_jump(compiler, CONDITION_NOT_EQUAL, -1 - OVERFLOW_STUB);
+            emit_sse(code, 0xF2, 1, SSE_CVTSI2SD, top, 0);
+        }
+        return 1;
+    case OP_EQUALS:
+    case OP_NOT_EQUALS:
+    case OP_LESSER:
+    case OP_LESSER_EQUALS:
+    case OP_GREATER:
+    case OP_GREATER_EQUALS: {
+        // cmpsd PREDICATES: 0 EQ, 1 LT, 2 LE, 4 NEQ. a > b IS COMPUTED AS b < a
+        uint8_t predicate = op == OP_EQUALS ? 0 : op == OP_NOT_EQUALS ? 4 :
+            (op == OP_LESSER || op == OP_GREATER) ? 1 : 2;
+        if (op == OP_GREATER || op == OP_GREATER_EQUALS) {
+            emit_sse(code, 0x66, 0, SSE_MOVAPD, 15, top);
+            emit_sse(code, 0xF2, 0, SSE_CMPSD, 15, top - 1);
+            emit_byte(code, predicate);
+            emit_sse(code, 0x66, 0, SSE_MOVAPD, top - 1, 15);
+        } else {
+            emit_sse(code, 0xF2, 0, SSE_CMPSD, top - 1, top);
+            emit_byte(code, predicate);
+        }
+
+        // THE ALL ONES MASK BECOMES -1
+        emit_load_constant(code, 15, -1.0);
+        emit_sse(code, 0x66, 0, SSE_ANDPD, top - 1, 15);
+        (*depth)--;
+        return 1;
+    }
+    case OP_JUMP:
+        if (*depth != 0) {
+            return 0;
+        }
+        emit_jump(compiler, JUMP_ALWAYS, a);
+        return 1;
+    case OP_JUMP_IF_FALSE:
+    case OP_JUMP_IF_TRUE: {
+        (*depth)--;
+        if (*depth != 0) {
+            return 0;
+        }
+
+        emit_sse(code, 0x66, 0, SSE_XORPD, 15, 15);
+        emit_sse(code, 0x66, 0, SSE_UCOMISD, top, 15);
+        if (op == OP_JUMP_IF_FALSE) {
+            long skip = emit_short_jump(code, 0x70 | CONDITION_PARITY);
+            emit_jump(compiler, CONDITION_EQUAL, a);
+            patch_short_jump(code, skip);
+        } else {
+            emit_jump(compiler, CONDITION_PARITY, a);
+            emit_jump(compiler, CONDITION_NOT_EQUAL, a);
+        }
+        return 1;
+    }
+    case OP_FOR_TEST: {
+        if (*depth != 0) {
+            return 0;
+        }
+
+        // FINISHED IS step >= 0 ? control > end : control < end, EXACTLY AS IN THE VM
+        emit_sse_slot(compiler, 0xF2, SSE_MOVSD, 0, a);
+        emit_sse_slot(compiler, 0xF2, SSE_MOVSD, 1, b);
+        emit_sse_slot(compiler, 0xF2, SSE_MOVSD, 2, b + 1);
+        emit_sse(code, 0x66, 0, SSE_XORPD, 3, 3);
+        emit_sse(code, 0x66, 0, SSE_UCOMISD, 2, 3);
+        long negative = emit_short_jump(code, 0x70 | CONDITION_BELOW);
+        emit_sse(code, 0x66, 0, SSE_UCOMISD, 0, 1);
+        emit_jump(compiler, CONDITION_ABOVE, c);
+        long done = emit_short_jump(code, 0xEB);
+        patch_short_jump(code, negative);
+        emit_sse(code, 0x66, 0, SSE_UCOMISD, 1, 0);
+        emit_jump(compiler, CONDITION_ABOVE, c);
+        patch_short_jump(code, done);
+        return 1;
+    }
+    case OP_FOR_STEP:
+        if (*depth != 0) {
+            return 0;
+        }
+        emit_sse_slot(compiler, 0xF2, SSE_MOVSD, 0, a);
+        emit_sse_slot(compiler, 0xF2, SSE_ADDSD, 0, b);
+        emit_sse_slot(compiler, 0xF2, SSE_MOVSD_STORE, 0, a);
+        emit_jump(compiler, JUMP_ALWAYS, c);
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static JitFunction compile_loop(struct Jit* jit, long loop_start, long loop_end) {
+    const struct Chunk* chunk = jit->chunk;
+    long region_length = loop_end - loop_start;
+
+    struct LoopCompiler compiler;
+    memset(&compiler, 0, sizeof(compiler));
+    compiler.chunk = chunk;
+    compiler.native_offsets = (long*)malloc((region_length + 1) * sizeof(long));
+    compiler.is_jump_target = (int*)calloc(region_length + 1, sizeof(int));
+    compiler.used_slots = (int*)calloc(chunk->slot_count + 1, sizeof(int));
+
+    for (long offset = loop_start;offset < loop_end;) {
+        enum OpCode op = (enum OpCode)chunk->code[offset];
+        long target = -1;
+        if (op == OP_JUMP || op == OP_JUMP_IF_FALSE || op == OP_JUMP_IF_TRUE) {
+            target = read_operand(chunk->code + offset + 1);
+        } else if (op == OP_FOR_TEST || op == OP_FOR_STEP) {
+            target = read_operand(chunk->code + offset + 1 + 2 * sizeof(int32_t));
+        }
+
+        if (target >= loop_start && target < loop_end) {
+            compiler.is_jump_target[target - loop_start] = 1;
+        }
+        offset += 1 + get_operand_count(op) * (long)sizeof(int32_t);
+    }
+
+    JitFunction function = NULL;
+    int depth = 0;
+    int compiled = 1;
+    for (long offset = loop_start;offset < loop_end && compiled;) {
+        enum OpCode op = (enum OpCode)chunk->code[offset];
+        // STATEMENTS LEAVE THE STACK EMPTY, WHICH IS WHERE EVERY JUMP LANDS
+        if (compiler.is_jump_target[offset - loop_start] && depth != 0) {
+            compiled = 0;
+            break;
+        }
+
+        compiler.native_offsets[offset - loop_start] = compiler.code.length;
+        compiled = compile_instruction(&compiler, offset, &depth);
+        offset += 1 + get_operand_count(op) * (long)sizeof(int32_t);
+    }
+    compiler.native_offsets[region_length] = compiler.code.length;
+
+    long stubs[STUB_COUNT];
+    long guard_length = 0;
+    if (compiled) {
+        static const uint8_t stub_status[STUB_COUNT] = { JIT_LOOP_EXITED, JIT_DIVISION_BY_ZERO, JIT_NOT_ENTERED, JIT_OVERFLOW };
+        for (int i = 0;i < STUB_COUNT;i++) {
+            // movl $status, %eax; ret
+            stubs[i] = compiler.code.length;
+            emit_byte(&compiler.code, 0xB8);
+            emit_int32(&compiler.code, stub_status[i]);
+            emit_byte(&compiler.code, 0xC3);
+        }
+
+        for (int i = 0;i < compiler.patch_count && compiled;i++) {
+            long target = compiler.patches[i].target;
+            long native_target;
+            if (target < 0) {
+                native_target = stubs[-1 - target];
+            } else if (target == loop_end) {
+                native_target = stubs[EXIT_STUB];
+            } else if (target >= loop_start && target < loop_end) {
+                native_target = compiler.native_offsets[target - loop_start];
+            } else {
+                compiled = 0;
+                break;
+            }
+
+            int32_t relative = (int32_t)(native_target - (compiler.patches[i].position + 4));
+            memcpy(compiler.code.bytes + compiler.patches[i].position, &relative, sizeof(relative));
+        }
+
+        // EVERY GUARD IS cmpl $NUMBER_VALUE, disp32(%rdi) (7 BYTES) AND jne rel32 (6 BYTES)
+        for (int i = 0;i < chunk->slot_count;i++) {
+            guard_length += compiler.used_slots[i] ? 13 : 0;
+        }
+    }
+
+    if (compiled) {
+        struct CodeBuffer final_code;
+        memset(&final_code, 0, sizeof(final_code));
+        for (int i = 0;i < chunk->slot_count;i++) {
+            if (!compiler.used_slots[i]) {
+                continue;
+            }
+
+            emit_byte(&final_code, 0x83);
+            emit_byte(&final_code, 0xBF);
+            emit_int32(&final_code, get_slot_displacement(i, offsetof(struct Value, type)));
+            emit_byte(&final_code, NUMBER_VALUE);
+            emit_byte(&final_code, 0x0F);
+            emit_byte(&final_code, 0x80 | CONDITION_NOT_EQUAL);
+            emit_int32(&final_code, (int32_t)(guard_length + stubs[NOT_ENTERED_STUB] - (final_code.length + 4)));
+        }
+        for (long i = 0;i < compiler.code.length;i++) {
+            emit_byte(&final_code, compiler.code.bytes[i]);
+        }
+
+        // MAPPED WRITABLE, THEN FLIPPED TO EXECUTABLE SO NO PAGE IS EVER BOTH
+        long page_size = sysconf(_SC_PAGESIZE);
+        size_t mapping_size = (size_t)((final_code.length + page_size - 1) / page_size * page_size);
+        void* mapping = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping != MAP_FAILED) {
+            memcpy(mapping, final_code.bytes, final_code.length);
+            if (mprotect(mapping, mapping_size, PROT_READ | PROT_EXEC) == 0) {
+                if (jit->mapping_count == jit->mapping_capacity) {
+                    jit->mapping_capacity = jit->mapping_capacity == 0 ? 8 : jit->mapping_capacity * 2;
+                    jit->mappings = (void**)realloc(jit->mappings, jit->mapping_capacity * sizeof(void*));
+                    jit->mapping_sizes = (size_t*)realloc(jit->mapping_sizes, jit->mapping_capacity * sizeof(size_t));
+                }
+                jit->mappings[jit->mapping_count] = mapping;
+                jit->mapping_sizes[jit->mapping_count] = mapping_size;
+                jit->mapping_count++;
+
+                // ISO C HAS NO OBJECT TO FUNCTION POINTER CONVERSION, POSIX GUARANTEES IT WORKS
+                memcpy(&function, &mapping, sizeof(function));
+            } else {
+                munmap(mapping, mapping_size);
+            }
+        }
+
+        free(final_code.bytes);
+    }
+
+    free(compiler.code.bytes);
+    free(compiler.native_offsets);
+    free(compiler.is_jump_target);
+    free(compiler.used_slots);
+    free(compiler.patches);
+
+    return function;
+}
+
+#endif
+
+JitFunction jit_back_edge(struct Jit* jit, long back_edge, long loop_start) {
+    // CALLED EVERY TIME A LOOP JUMPS BACK, RETURNS THE MACHINE CODE ONCE THE LOOP IS HOT
+    if (jit->functions[back_edge] != NULL) {
+        return jit->functions[back_edge];
+    }
+
+    if (jit->back_edge_counts[back_edge] == JIT_FAILED || ++jit->back_edge_counts[back_edge] < JIT_HOT_LOOP_THRESHOLD) {
+        return NULL;
+    }
+
+#ifdef JIT_X86_64
+    long loop_end = back_edge + 1 + get_operand_count((enum OpCode)jit->chunk->code[back_edge]) * (long)sizeof(int32_t);
+    jit->functions[back_edge] = compile_loop(jit, loop_start, loop_end);
+#endif
+
+    if (jit->functions[back_edge] == NULL) {
+        jit->back_edge_counts[back_edge] = JIT_FAILED;
+    }
+
+    return jit->functions[back_edge];
+}
+
+void free_jit(struct Jit* jit) {
+#ifdef JIT_X86_64
+    for (int i = 0;i < jit->mapping_count;i++) {
+        munmap(jit->mappings[i], jit->mapping_sizes[i]);
+    }
+#endif
+
+    free(jit->mappings);
+    free(jit->mapping_sizes);
+    free(jit->back_edge_counts);
+    free(jit->functions);
+    free(jit);
+}
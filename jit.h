@@ -0,0 +1,29 @@
+#ifndef JIT_H_
+#define JIT_H_
+
+#include "bytecode.h"
+
+// A LOOP IS COMPILED ONCE ITS BACK EDGE HAS BEEN TAKEN THIS MANY TIMES
+#ifndef JIT_HOT_LOOP_THRESHOLD
+#define JIT_HOT_LOOP_THRESHOLD 1000
+#endif
+
+enum JitStatus {
+    // THE LOOP RAN TO ITS END, THE INTERPRETER CONTINUES AFTER THE BACK EDGE
+    JIT_LOOP_EXITED,
+    JIT_DIVISION_BY_ZERO,
+    // A SLOT THE LOOP USES DOES NOT HOLD A NUMBER, NOTHING RAN
+    JIT_NOT_ENTERED,
+    JIT_OVERFLOW,
+};
+
+typedef enum JitStatus (*JitFunction)(struct Value* slots);
+
+struct Jit;
+
+int is_jit_supported(void);
+struct Jit* new_jit(const struct Chunk* chunk);
+JitFunction jit_back_edge(struct Jit* jit, long back_edge, long loop_start);
+void free_jit(struct Jit* jit);
+
+#endif
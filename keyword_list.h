@@ -0,0 +1,29 @@
+#ifndef KEYWORD_LIST_H_
+#define KEYWORD_LIST_H_
+
+// EVERY KEYWORD AND ITS TOKEN TYPE, LOWERCASE. AFTER EDITING IT, make keywords REGENERATES
+// keyword_table.h
+#define KEYWORD_LIST \
+    KEYWORD(print, PRINT_KEYWORD) \
+    KEYWORD(if, IF_KEYWORD) \
+    KEYWORD(then, THEN_KEYWORD) \
+    KEYWORD(elseif, ELSEIF_KEYWORD) \
+    KEYWORD(else, ELSE_KEYWORD) \
+    KEYWORD(end, END_KEYWORD) \
+    KEYWORD(do, DO_KEYWORD) \
+    KEYWORD(loop, LOOP_KEYWORD) \
+    KEYWORD(while, WHILE_KEYWORD) \
+    KEYWORD(until, UNTIL_KEYWORD) \
+    KEYWORD(for, FOR_KEYWORD) \
+    KEYWORD(to, TO_KEYWORD) \
+    KEYWORD(step, STEP_KEYWORD) \
+    KEYWORD(next, NEXT_KEYWORD) \
+    KEYWORD(defint, DEFINT_KEYWORD) \
+    KEYWORD(deflng, DEFLNG_KEYWORD) \
+    KEYWORD(defsng, DEFSNG_KEYWORD) \
+    KEYWORD(defdbl, DEFDBL_KEYWORD) \
+    KEYWORD(defstr, DEFSTR_KEYWORD)
+
+#define KEYWORD_TABLE_SIZE 32
+
+#endif
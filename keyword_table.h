@@ -0,0 +1,32 @@
+// GENERATED BY gen_keywords.c FROM keyword_list.h, RUN make keywords INSTEAD OF EDITING IT
+
+#define MIN_KEYWORD_LENGTH 2
+#define MAX_KEYWORD_LENGTH 6
+
+static const unsigned char associated_values[256] = {
+    ['d'] = 13, ['e'] = 16, ['f'] = 18, ['g'] = 29, ['h'] = 19, ['i'] = 31,
+    ['l'] = 6, ['n'] = 22, ['o'] = 7, ['p'] = 18, ['r'] = 5, ['s'] = 31,
+    ['t'] = 23, ['u'] = 8, ['w'] = 27, ['x'] = 20,
+};
+
+static const struct Keyword keyword_table[KEYWORD_TABLE_SIZE] = {
+    [0] = {"until", 5, UNTIL_KEYWORD},
+    [2] = {"while", 5, WHILE_KEYWORD},
+    [4] = {"do", 2, DO_KEYWORD},
+    [6] = {"deflng", 6, DEFLNG_KEYWORD},
+    [7] = {"defstr", 6, DEFSTR_KEYWORD},
+    [8] = {"for", 3, FOR_KEYWORD},
+    [9] = {"else", 4, ELSE_KEYWORD},
+    [10] = {"loop", 4, LOOP_KEYWORD},
+    [12] = {"end", 3, END_KEYWORD},
+    [14] = {"to", 2, TO_KEYWORD},
+    [18] = {"print", 5, PRINT_KEYWORD},
+    [20] = {"then", 4, THEN_KEYWORD},
+    [21] = {"next", 4, NEXT_KEYWORD},
+    [22] = {"defdbl", 6, DEFDBL_KEYWORD},
+    [23] = {"if", 2, IF_KEYWORD},
+    [25] = {"defint", 6, DEFINT_KEYWORD},
+    [28] = {"step", 4, STEP_KEYWORD},
+    [30] = {"elseif", 6, ELSEIF_KEYWORD},
+    [31] = {"defsng", 6, DEFSNG_KEYWORD},
+};
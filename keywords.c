@@ -0,0 +1,49 @@
+#include "keywords.h"
+#include "keyword_list.h"
+
+struct Keyword {
+    const char* word;
+    long length;
+    enum TokenType token_type;
+};
+
+static unsigned int hash_keyword(const char* text, long length);
+
+// PERFECT HASH OVER THE KEYWORD SET:
+// (length + v[first] + v[second] + v[middle] + v[last]) % KEYWORD_TABLE_SIZE
+// gen_keywords.c SEARCHES THE VALUES SO THAT NO TWO KEYWORDS COLLIDE
+#include "keyword_table.h"
+
+// IDENTIFIERS ARE ASCII LETTERS ONLY, SO OR-ING 0x20 LOWERCASES THEM
+static unsigned int hash_keyword(const char* text, long length) {
+    return (unsigned int)(
+        length +
+        associated_values[(unsigned char)(text[0] | 0x20)] +
+        associated_values[(unsigned char)(text[1] | 0x20)] +
+        associated_values[(unsigned char)(text[length / 2] | 0x20)] +
+        associated_values[(unsigned char)(text[length - 1] | 0x20)]
+    ) % KEYWORD_TABLE_SIZE;
+}
+
+enum TokenType lookup_keyword(const char* text, long length) {
+    if (length < MIN_KEYWORD_LENGTH || length > MAX_KEYWORD_LENGTH) {
+        return UNQUOTED_STRING;
+    }
+
+    const struct Keyword* keyword = &keyword_table[hash_keyword(text, length)];
+    if (keyword->length != length) {
+        return UNQUOTED_STRING;
+    }
+
+    for (long i = 0;i < length;i++) {
+        if ((text[i] | 0x20) != keyword->word[i]) {
+            return UNQUOTED_STRING;
+        }
+    }
+
+    return keyword->token_type;
+}
+
+int is_keyword_token_type(enum TokenType token_type) {
+    return token_type >= PRINT_KEYWORD && token_type <= DEFSTR_KEYWORD;
+}
@@ -0,0 +1,9 @@
+#ifndef KEYWORDS_H_
+#define KEYWORDS_H_
+
+#include "lexer.h"
+
+enum TokenType lookup_keyword(const char* text, long length);
+int is_keyword_token_type(enum TokenType token_type);
+
+#endif
@@ -1,103 +1,129 @@
 #include "lexer.h"
+#include "keywords.h"
+#include "interner.h"
+#include "charclass.h"
+#include "thread_pool.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <ctype.h>
+#include <string.h>
 
-static struct TokenList new_token_list(void);
+static struct TokenList new_token_list(const char* source);
 static void add_token(struct TokenList* tokens, struct Token token);
 
-struct StringReallocator {
-    char* string;
-    int capacity;
-    int length;
-};
-
-static void add_char(struct StringReallocator* reallocator, char ch);
-static struct StringReallocator new_string_reallocator(void);
-
-struct CharPeeker {
-    char* file_buff;
-    long file_size;
-    long current_pos;
-    int row;
-    int col;
-};
-
-static struct CharPeeker new_char_peeker(char* file_buff, long file_size);
-static char* next_char(struct CharPeeker* peeker);
-static char* peek_char(struct CharPeeker* peeker);
+static struct CharPeeker new_char_peeker(const char* file_buff, long file_size);
+static const char* next_char(struct CharPeeker* peeker);
+static const char* peek_char(struct CharPeeker* peeker);
 
-static long read_special_char(struct CharPeeker* peeker, struct Token* token);
+static long read_operator_token(struct CharPeeker* peeker, struct Token* token);
 static long read_number_token(struct CharPeeker* peeker, struct Token* token);
 static long read_new_line_token(struct CharPeeker* peeker, struct Token* token);
 static long read_quoted_string_token(struct CharPeeker* peeker, struct Token* token);
+static int is_type_suffix(char c);
 static long read_unquoted_string_token(struct CharPeeker* peeker, struct Token* token);
 static long skip_whitespaces(struct CharPeeker* peeker);
-static void string_to_lowercase(char * string);
+static int scan_token(struct CharPeeker* peeker, struct Token* token);
+
+static void lex_chunk_task(void* context, int worker, int task);
+static void stitch_chunk_task(void* context, int worker, int task);
+
+// CHUNKS SMALLER THAN THIS COST MORE IN THREADS AND COPYING THAN THEY SAVE
+#define MIN_LEX_CHUNK_SIZE (256 * 1024)
+
+struct LexChunk {
+    long start;
+    long end;
+    struct TokenList tokens;
+    long first_token;
+};
+
+struct ChunkedLex {
+    const char* file_buff;
+    struct LexChunk* chunks;
+    struct Token* tokens;
+};
+
+// THE FIRST BYTE OF A TOKEN DECIDES WHICH SCANNER RUNS
+enum CharClass {
+    INVALID_CLASS,
+    WHITESPACE_CLASS,
+    NEW_LINE_CLASS,
+    ALPHA_CLASS,
+    DIGIT_CLASS,
+    QUOTE_CLASS,
+    OPERATOR_CLASS,
+};
+
+static const unsigned char char_classes[256] = {
+    [' '] = WHITESPACE_CLASS, ['\t'] = WHITESPACE_CLASS, ['\r'] = WHITESPACE_CLASS,
+    ['\n'] = NEW_LINE_CLASS,
+    ['"'] = QUOTE_CLASS,
+    ['0'] = DIGIT_CLASS, ['1'] = DIGIT_CLASS, ['2'] = DIGIT_CLASS, ['3'] = DIGIT_CLASS, ['4'] = DIGIT_CLASS,
+    ['5'] = DIGIT_CLASS, ['6'] = DIGIT_CLASS, ['7'] = DIGIT_CLASS, ['8'] = DIGIT_CLASS, ['9'] = DIGIT_CLASS,
+    ['.'] = DIGIT_CLASS, ['&'] = DIGIT_CLASS,
+    ['a'] = ALPHA_CLASS, ['b'] = ALPHA_CLASS, ['c'] = ALPHA_CLASS, ['d'] = ALPHA_CLASS, ['e'] = ALPHA_CLASS, ['f'] = ALPHA_CLASS, ['g'] = ALPHA_CLASS,
+    ['h'] = ALPHA_CLASS, ['i'] = ALPHA_CLASS, ['j'] = ALPHA_CLASS, ['k'] = ALPHA_CLASS, ['l'] = ALPHA_CLASS, ['m'] = ALPHA_CLASS, ['n'] = ALPHA_CLASS,
+    ['o'] = ALPHA_CLASS, ['p'] = ALPHA_CLASS, ['q'] = ALPHA_CLASS, ['r'] = ALPHA_CLASS, ['s'] = ALPHA_CLASS, ['t'] = ALPHA_CLASS, ['u'] = ALPHA_CLASS,
+    ['v'] = ALPHA_CLASS, ['w'] = ALPHA_CLASS, ['x'] = ALPHA_CLASS, ['y'] = ALPHA_CLASS, ['z'] = ALPHA_CLASS,
+    ['A'] = ALPHA_CLASS, ['B'] = ALPHA_CLASS, ['C'] = ALPHA_CLASS, ['D'] = ALPHA_CLASS, ['E'] = ALPHA_CLASS, ['F'] = ALPHA_CLASS, ['G'] = ALPHA_CLASS,
+    ['H'] = ALPHA_CLASS, ['I'] = ALPHA_CLASS, ['J'] = ALPHA_CLASS, ['K'] = ALPHA_CLASS, ['L'] = ALPHA_CLASS, ['M'] = ALPHA_CLASS, ['N'] = ALPHA_CLASS,
+    ['O'] = ALPHA_CLASS, ['P'] = ALPHA_CLASS, ['Q'] = ALPHA_CLASS, ['R'] = ALPHA_CLASS, ['S'] = ALPHA_CLASS, ['T'] = ALPHA_CLASS, ['U'] = ALPHA_CLASS,
+    ['V'] = ALPHA_CLASS, ['W'] = ALPHA_CLASS, ['X'] = ALPHA_CLASS, ['Y'] = ALPHA_CLASS, ['Z'] = ALPHA_CLASS,
+    [','] = OPERATOR_CLASS, [';'] = OPERATOR_CLASS, ['-'] = OPERATOR_CLASS, ['+'] = OPERATOR_CLASS,
+    ['/'] = OPERATOR_CLASS, ['*'] = OPERATOR_CLASS, ['!'] = OPERATOR_CLASS, ['='] = OPERATOR_CLASS,
+    ['>'] = OPERATOR_CLASS, ['<'] = OPERATOR_CLASS, ['('] = OPERATOR_CLASS, [')'] = OPERATOR_CLASS,
+};
+
+static const enum TokenType operator_token_types[256] = {
+    [','] = COMMA, [';'] = SEMICOLON, ['-'] = MINUS, ['+'] = PLUS,
+    ['/'] = SLASH, ['*'] = ASTERISK, ['!'] = BANG, ['='] = EQUALS,
+    ['>'] = GREATER_THAN, ['<'] = LESSER_THAN, ['('] = OPEN_ROUND_BRACKET, [')'] = CLOSE_ROUND_BRACKET,
+};
 
-static struct TokenList new_token_list(void) {
+static struct TokenList new_token_list(const char* source) {
     struct TokenList token_list;
     token_list.length = 0;
     token_list.capacity = 0;
     token_list.tokens = NULL;
+    token_list.source = source;
 
     return token_list;
 }
 
 static void add_token(struct TokenList* tokens, struct Token token) {
-    int alloc_size = 20;
+    int alloc_size = 1024;
     if (tokens->capacity == 0) {
         tokens->tokens = (struct Token*)malloc(alloc_size * sizeof(struct Token));
         tokens->capacity += alloc_size;
     }
 
     if (tokens->length >= tokens->capacity) {
-        tokens->tokens = (struct Token*)realloc(tokens->tokens, (tokens->capacity + alloc_size) * sizeof(struct Token));
-        tokens->capacity += alloc_size;
+        tokens->tokens = (struct Token*)realloc(tokens->tokens, 2 * tokens->capacity * sizeof(struct Token));
+        tokens->capacity = 2 * tokens->capacity;
     }
 
     tokens->tokens[tokens->length] = token;
     tokens->length++;
 }
 
-static struct StringReallocator new_string_reallocator(void) {
-    struct StringReallocator reallocator;
-    reallocator.capacity = 0;
-    reallocator.length = 0;
-    reallocator.string = NULL;
-
-    return reallocator;
+void free_token_list(struct TokenList* tokens) {
+    free(tokens->tokens);
+    tokens->tokens = NULL;
+    tokens->length = 0;
+    tokens->capacity = 0;
 }
 
-static void add_char(struct StringReallocator* reallocator, char ch) {
-    int alloc_size = 20;
-    if (reallocator->capacity == 0) {
-        reallocator->string = (char*)malloc(alloc_size * sizeof(char));
-        reallocator->capacity += alloc_size;
-    }
-
-    if (reallocator->length >= reallocator->capacity) {
-        reallocator->string = (char*)realloc(reallocator->string, (reallocator->capacity + alloc_size) * sizeof(char));
-        reallocator->capacity += alloc_size;
-    }
-
-    reallocator->string[reallocator->length] = ch;
-    reallocator->length++;
-}
-
-static struct CharPeeker new_char_peeker(char* file_buff, long file_size) {
+static struct CharPeeker new_char_peeker(const char* file_buff, long file_size) {
     struct CharPeeker peeker;
 
     peeker.file_buff = file_buff;
     peeker.file_size = file_size;
     peeker.current_pos = 0;
-    peeker.row = 1;
-    peeker.col = 1;
 
     return peeker;
 }
 
-static char* next_char(struct CharPeeker* peeker) {
+static const char* next_char(struct CharPeeker* peeker) {
     if (peeker->current_pos < peeker->file_size) {
         peeker->current_pos++;
     }
@@ -105,7 +131,7 @@ static char* next_char(struct CharPeeker* peeker) {
     return peek_char(peeker);
 }
 
-static char* peek_char(struct CharPeeker* peeker) {
+static const char* peek_char(struct CharPeeker* peeker) {
     if (peeker->current_pos >= peeker->file_size) {
         return NULL;
     }
@@ -120,14 +146,35 @@ const char* get_token_type_string(enum TokenType token_type) {
         case NUMBER: return "NUMBER";
         case NEW_LINE: return "NEW_LINE";
 
+        case PRINT_KEYWORD: return "PRINT_KEYWORD";
+        case IF_KEYWORD: return "IF_KEYWORD";
+        case THEN_KEYWORD: return "THEN_KEYWORD";
+        case ELSEIF_KEYWORD: return "ELSEIF_KEYWORD";
+        case ELSE_KEYWORD: return "ELSE_KEYWORD";
+        case END_KEYWORD: return "END_KEYWORD";
+        case DO_KEYWORD: return "DO_KEYWORD";
+        case LOOP_KEYWORD: return "LOOP_KEYWORD";
+        case WHILE_KEYWORD: return "WHILE_KEYWORD";
+        case UNTIL_KEYWORD: return "UNTIL_KEYWORD";
+        case FOR_KEYWORD: return "FOR_KEYWORD";
+        case TO_KEYWORD: return "TO_KEYWORD";
+        case STEP_KEYWORD: return "STEP_KEYWORD";
+        case NEXT_KEYWORD: return "NEXT_KEYWORD";
+        case DEFINT_KEYWORD: return "DEFINT_KEYWORD";
+        case DEFLNG_KEYWORD: return "DEFLNG_KEYWORD";
+        case DEFSNG_KEYWORD: return "DEFSNG_KEYWORD";
+        case DEFDBL_KEYWORD: return "DEFDBL_KEYWORD";
+        case DEFSTR_KEYWORD: return "DEFSTR_KEYWORD";
+
         case COMMA: return "COMMA";
         case SEMICOLON: return "SEMICOLON";
 
-        case ASSIGN_OPERATOR: return "ASSIGN_OPERATOR";
-
         case EQUALS: return "EQUALS";
+        case NOT_EQUALS: return "NOT_EQUALS";
         case GREATER_THAN: return "GREATER_THAN";
+        case GREATER_EQUALS: return "GREATER_EQUALS";
         case LESSER_THAN: return "LESSER_THAN";
+        case LESSER_EQUALS: return "LESSER_EQUALS";
 
         case OPEN_ROUND_BRACKET: return "OPEN_ROUND_BRACKET";
         case CLOSE_ROUND_BRACKET: return "CLOSE_ROUND_BRACKET";
@@ -137,309 +184,415 @@ const char* get_token_type_string(enum TokenType token_type) {
 
         case ASTERISK: return "ASTERISK";
         case SLASH: return "SLASH";
+        case BANG: return "BANG";
     }
 
     return "UNKNOWN TOKEN";
 }
 
-static long skip_whitespaces(struct CharPeeker* peeker) {
-    long read_bytes = 0;
-    char* char_at_pos = peek_char(peeker);
-    while (char_at_pos != NULL && (*char_at_pos == ' ' || *char_at_pos == '\t')) {
-        read_bytes++;
-        char_at_pos = next_char(peeker);
+const char* get_token_text(const char* source, const struct Token* token) {
+    return source + token->offset;
+}
+
+int token_equals(const char* source, const struct Token* token, const char* lowercase_word) {
+    const char* text = get_token_text(source, token);
+    for (long i = 0;i < token->length;i++) {
+        if (lowercase_word[i] == 0 || tolower((unsigned char)text[i]) != lowercase_word[i]) {
+            return 0;
+        }
     }
 
-    peeker->col += read_bytes;
-    return read_bytes;
+    return lowercase_word[token->length] == 0;
 }
 
-static long read_unquoted_string_token(struct CharPeeker* peeker, struct Token* token) {
-    long read_bytes = 0;
-
-    char* char_at_pos = peek_char(peeker);
-    if (!isalpha(*char_at_pos)) {
-        return read_bytes;
+int tokens_equal(const char* source, const struct Token* left, const struct Token* right) {
+    if (left->length != right->length) {
+        return 0;
     }
 
-    token->col = peeker->col;
-    token->row = peeker->row;
-
-    struct StringReallocator value = new_string_reallocator();
+    const char* left_text = get_token_text(source, left);
+    const char* right_text = get_token_text(source, right);
+    for (long i = 0;i < left->length;i++) {
+        if (tolower((unsigned char)left_text[i]) != tolower((unsigned char)right_text[i])) {
+            return 0;
+        }
+    }
 
-    while (char_at_pos != NULL && isalpha(*char_at_pos)) {
-        add_char(&value, *char_at_pos);
+    return 1;
+}
 
-        read_bytes++;
-        char_at_pos = next_char(peeker);
+void print_token_value(const char* source, const struct Token* token) {
+    if (token->identifier_id >= 0) {
+        printf("%s", get_identifier_name(token->identifier_id));
+        return;
     }
 
-    add_char(&value, 0);
+    const char* text = get_token_text(source, token);
+    if (!is_keyword_token_type(token->token_type)) {
+        printf("%.*s", (int)token->length, text);
+        return;
+    }
 
-    token->token_type = UNQUOTED_STRING;
+    for (long i = 0;i < token->length;i++) {
+        putchar(tolower((unsigned char)text[i]));
+    }
+}
 
-    string_to_lowercase(value.string);
-    token->value = value.string;
+static long skip_whitespaces(struct CharPeeker* peeker) {
+    long read_bytes = scan_whitespace_run(
+        peeker->file_buff + peeker->current_pos,
+        peeker->file_size - peeker->current_pos
+    );
 
-    peeker->col += read_bytes;
+    peeker->current_pos += read_bytes;
     return read_bytes;
 }
 
-static long read_quoted_string_token(struct CharPeeker* peeker, struct Token* token) {
-    long read_bytes = 0;
-
-    char* char_at_pos = peek_char(peeker);
-    if (*char_at_pos != '"') {
-        return read_bytes;
-    }
+static int is_type_suffix(char c) {
+    return c == '%' || c == '&' || c == '!' || c == '#' || c == '$';
+}
 
-    token->col = peeker->col;
-    token->row = peeker->row;
+static long read_unquoted_string_token(struct CharPeeker* peeker, struct Token* token) {
+    token->offset = peeker->current_pos;
 
-    read_bytes++;
-    char_at_pos = next_char(peeker);
-    struct StringReallocator value = new_string_reallocator();
+    long read_bytes = scan_alpha_run(peeker->file_buff + peeker->current_pos, peeker->file_size - peeker->current_pos);
+    peeker->current_pos += read_bytes;
 
-    while (char_at_pos != NULL && *char_at_pos != '"') {
-        add_char(&value, *char_at_pos);
+    token->token_type = lookup_keyword(peeker->file_buff + token->offset, read_bytes);
+    if (token->token_type == UNQUOTED_STRING && peeker->current_pos < peeker->file_size &&
+        is_type_suffix(peeker->file_buff[peeker->current_pos])) {
+        // THE SUFFIX IS PART OF THE NAME, a% AND a ARE DIFFERENT VARIABLES
+        peeker->current_pos++;
         read_bytes++;
-
-        char_at_pos = next_char(peeker);
     }
 
-    add_char(&value, 0);
-    read_bytes++;
-    next_char(peeker);
-    
-    token->token_type = QUOTED_STRING;
-    token->value = value.string;
+    token->length = read_bytes;
+    if (token->token_type == UNQUOTED_STRING) {
+        token->identifier_id = intern_identifier(peeker->file_buff + token->offset, read_bytes);
+    }
 
-    peeker->col += read_bytes;
     return read_bytes;
 }
 
-static void string_to_lowercase(char * string) {
-    for(char *p=string; *p; p++) *p=tolower(*p);
+static long read_quoted_string_token(struct CharPeeker* peeker, struct Token* token) {
+    token->offset = peeker->current_pos + 1;
+
+    const char* closing_quote = memchr(
+        peeker->file_buff + token->offset,
+        '"',
+        peeker->file_size - token->offset
+    );
+
+    // A STRING WITHOUT A CLOSING QUOTE ENDS WITH ITS LINE
+    long end_pos = closing_quote != NULL ? closing_quote - peeker->file_buff : peeker->file_size;
+    const char* line_end = memchr(peeker->file_buff + token->offset, '\n', end_pos - token->offset);
+    if (line_end != NULL) {
+        closing_quote = NULL;
+        end_pos = line_end - peeker->file_buff;
+    }
+
+    token->length = end_pos - token->offset;
+    token->token_type = QUOTED_STRING;
+
+    peeker->current_pos = closing_quote != NULL ? end_pos + 1 : end_pos;
+
+    long read_bytes = peeker->current_pos - (token->offset - 1);
+    return read_bytes;
 }
 
 static long read_new_line_token(struct CharPeeker* peeker, struct Token* token) {
-    char* char_at_pos = peek_char(peeker);
-    if (*char_at_pos != '\n') {
-        return 0;
-    }
-
     token->token_type = NEW_LINE;
-    token->value = NULL;
-    token->col = peeker->col;
-    token->row = peeker->row;
+    token->offset = peeker->current_pos;
+    token->length = 0;
 
     next_char(peeker);
-    peeker->row++;
-    peeker->col = 1;
 
     return 1;
 }
 
 static long read_number_token(struct CharPeeker* peeker, struct Token* token) {
-    long read_bytes = 0;
-    char* char_at_pos = peek_char(peeker);
-
-    if (!isdigit(*char_at_pos)) {
-        return read_bytes;
+    token->offset = peeker->current_pos;
+
+    enum NumberError error;
+    long read_bytes = parse_number_literal(peeker->file_buff + peeker->current_pos, peeker->file_size - peeker->current_pos, &token->number, &error);
+    if (error != NUMBER_OK) {
+        struct SourcePosition position = get_source_position(peeker->file_buff, peeker->current_pos);
+        if (error == NUMBER_MALFORMED) {
+            printf("Malformed number %.*s at %d:%d \n", (int)read_bytes, peeker->file_buff + peeker->current_pos, position.row, position.col);
+            exit(2);
+        }
+        printf("Number %.*s at %d:%d overflows its type \n", (int)read_bytes, peeker->file_buff + peeker->current_pos, position.row, position.col);
+        exit(3);
     }
 
-    token->col = peeker->col;
-    token->row = peeker->row;
+    peeker->current_pos += read_bytes;
 
-    struct StringReallocator value = new_string_reallocator();
+    token->token_type = NUMBER;
+    token->length = read_bytes;
 
-    while (char_at_pos != NULL && (isdigit(*char_at_pos) || *char_at_pos == '.')) {
-        add_char(&value, *char_at_pos);
-        read_bytes++;
+    return read_bytes;
+}
 
-        char_at_pos = next_char(peeker);
+static long read_operator_token(struct CharPeeker* peeker, struct Token* token) {
+    const char* char_at_pos = peek_char(peeker);
+
+    token->token_type = operator_token_types[(unsigned char)*char_at_pos];
+    token->offset = peeker->current_pos;
+    token->length = 1;
+
+    const char* following_char = next_char(peeker);
+    if (following_char != NULL) {
+        if (*char_at_pos == '<' && *following_char == '=') {
+            token->token_type = LESSER_EQUALS;
+        } else if (*char_at_pos == '<' && *following_char == '>') {
+            token->token_type = NOT_EQUALS;
+        } else if (*char_at_pos == '>' && *following_char == '=') {
+            token->token_type = GREATER_EQUALS;
+        }
     }
 
-    add_char(&value, 0);
-
-    token->token_type = NUMBER;
-    token->value = value.string;
+    if (token->token_type == LESSER_EQUALS || token->token_type == NOT_EQUALS || token->token_type == GREATER_EQUALS) {
+        next_char(peeker);
+        token->length = 2;
+    }
 
-    peeker->col += read_bytes;
-    return read_bytes;
+    return token->length;
 }
 
-static long read_special_char(struct CharPeeker* peeker, struct Token* token) {
-    char* char_at_pos = peek_char(peeker);
+static int scan_token(struct CharPeeker* peeker, struct Token* token) {
+    const char* char_at_pos = peek_char(peeker);
+    while (char_at_pos != NULL) {
+        token->identifier_id = -1;
+
+        switch (char_classes[(unsigned char)*char_at_pos]) {
+            case WHITESPACE_CLASS:
+                skip_whitespaces(peeker);
+                char_at_pos = peek_char(peeker);
+                continue;
+            case ALPHA_CLASS:
+                read_unquoted_string_token(peeker, token);
+                return 1;
+            case DIGIT_CLASS:
+                read_number_token(peeker, token);
+                return 1;
+            case QUOTE_CLASS:
+                read_quoted_string_token(peeker, token);
+                return 1;
+            case NEW_LINE_CLASS:
+                read_new_line_token(peeker, token);
+                return 1;
+            case OPERATOR_CLASS:
+                read_operator_token(peeker, token);
+                return 1;
+            case INVALID_CLASS:
+                break;
+        }
+
+        struct SourcePosition position = get_source_position(peeker->file_buff, peeker->current_pos);
+        printf("Undefined token at %d:%d \n", position.row, position.col);
+        exit(1);
+    }
 
-    if (*char_at_pos == ',') {
-        struct StringReallocator value = new_string_reallocator();
-        add_char(&value, ',');
-        add_char(&value, 0);
+    return 0;
+}
 
-        next_char(peeker);
-        token->col = peeker->col;
-        token->row = peeker->row;
-        token->token_type = COMMA;
-        token->value = value.string;
+struct TokenList read_tokens(const char* file_buff, long fsize) {
+    struct TokenList tokens = new_token_list(file_buff);
+    struct CharPeeker peeker = new_char_peeker(file_buff, fsize);
 
-        peeker->col++;
-        return 1;
+    struct Token token;
+    while (scan_token(&peeker, &token)) {
+        add_token(&tokens, token);
     }
 
-    if (*char_at_pos == ';') {
-        struct StringReallocator value = new_string_reallocator();
-        add_char(&value, ';');
-        add_char(&value, 0);
+    return tokens;
+}
 
-        next_char(peeker);
-        token->col = peeker->col;
-        token->row = peeker->row;
-        token->token_type = SEMICOLON;
-        token->value = value.string;
+// OFFSETS STAY RELATIVE TO THE WHOLE BUFFER, ONLY THE END IS MOVED IN
+struct TokenList read_token_range(const char* file_buff, long start, long end) {
+    struct TokenList tokens = new_token_list(file_buff);
+    struct CharPeeker peeker = new_char_peeker(file_buff, end);
+    peeker.current_pos = start;
 
-        peeker->col++;
-        return 1;
+    struct Token token;
+    while (scan_token(&peeker, &token)) {
+        add_token(&tokens, token);
     }
 
-    if (*char_at_pos == '=') {
-        struct StringReallocator value = new_string_reallocator();
-        add_char(&value, '=');
-        add_char(&value, 0);
+    return tokens;
+}
 
-        next_char(peeker);
-        token->col = peeker->col;
-        token->row = peeker->row;
-        token->token_type = ASSIGN_OPERATOR;
-        token->value = value.string;
+// ROWS AND COLUMNS ARE NOT TRACKED WHILE LEXING. A DUMP OF MANY TOKENS LOOKS THEM UP IN A
+// LINE INDEX, A SINGLE DIAGNOSTIC JUST COUNTS THE LINES BEFORE ITS OFFSET
+struct LineIndex build_line_index(const char* source, long size) {
+    struct LineIndex index;
+    long capacity = 1024;
+    index.line_starts = (long*)malloc(capacity * sizeof(long));
+    index.line_starts[0] = 0;
+    index.line_count = 1;
+
+    const char* position = source;
+    const char* end = source + size;
+    while ((position = memchr(position, '\n', end - position)) != NULL) {
+        position++;
+        if (index.line_count == capacity) {
+            capacity *= 2;
+            index.line_starts = (long*)realloc(index.line_starts, capacity * sizeof(long));
+        }
+        index.line_starts[index.line_count++] = position - source;
+    }
 
-        peeker->col++;
-        return 1;
+    return index;
+}
+
+struct SourcePosition find_source_position(const struct LineIndex* index, long offset) {
+    // THE LAST LINE STARTING AT OR BEFORE offset
+    long low = 0;
+    long high = index->line_count - 1;
+    while (low < high) {
+        long middle = low + (high - low + 1) / 2;
+        if (index->line_starts[middle] <= offset) {
+            low = middle;
+        } else {
+            high = middle - 1;
+        }
     }
 
-    if (*char_at_pos == '+') {
-        struct StringReallocator value = new_string_reallocator();
-        add_char(&value, '+');
-        add_char(&value, 0);
+    struct SourcePosition position;
+    position.row = (int)low + 1;
+    position.col = (int)(offset - index->line_starts[low]) + 1;
+    return position;
+}
 
-        next_char(peeker);
-        token->col = peeker->col;
-        token->row = peeker->row;
-        token->token_type = PLUS;
-        token->value = value.string;
+struct SourcePosition get_source_position(const char* source, long offset) {
+    struct SourcePosition position;
+    position.row = 1;
 
-        peeker->col++;
-        return 1;
+    long line_start = 0;
+    const char* new_line = source;
+    while ((new_line = memchr(new_line, '\n', offset - (new_line - source))) != NULL) {
+        new_line++;
+        line_start = new_line - source;
+        position.row++;
     }
 
-    if (*char_at_pos == '/') {
-        struct StringReallocator value = new_string_reallocator();
-        add_char(&value, '/');
-        add_char(&value, 0);
+    position.col = (int)(offset - line_start) + 1;
+    return position;
+}
 
-        next_char(peeker);
-        token->col = peeker->col;
-        token->row = peeker->row;
-        token->token_type = SLASH;
-        token->value = value.string;
+// A QUOTED STRING'S TEXT STARTS AFTER ITS QUOTE, THE TOKEN ITSELF AT THE QUOTE
+long get_token_start(const struct Token* token) {
+    return token->token_type == QUOTED_STRING ? token->offset - 1 : token->offset;
+}
 
-        peeker->col++;
-        return 1;
-    }
+void free_line_index(struct LineIndex* index) {
+    free(index->line_starts);
+    index->line_starts = NULL;
+    index->line_count = 0;
+}
 
-    if (*char_at_pos == '*') {
-        struct StringReallocator value = new_string_reallocator();
-        add_char(&value, '*');
-        add_char(&value, 0);
+static void lex_chunk_task(void* context, int worker, int task) {
+    struct ChunkedLex* lex = (struct ChunkedLex*)context;
+    struct LexChunk* chunk = &lex->chunks[task];
 
-        next_char(peeker);
-        token->col = peeker->col;
-        token->row = peeker->row;
-        token->token_type = ASTERISK;
-        token->value = value.string;
+    chunk->tokens = read_token_range(lex->file_buff, chunk->start, chunk->end);
+}
 
-        peeker->col++;
-        return 1;
-    }
+static void stitch_chunk_task(void* context, int worker, int task) {
+    struct ChunkedLex* lex = (struct ChunkedLex*)context;
+    struct LexChunk* chunk = &lex->chunks[task];
 
-    if (*char_at_pos == '(') {
-        struct StringReallocator value = new_string_reallocator();
-        add_char(&value, '(');
-        add_char(&value, 0);
+    struct Token* tokens = lex->tokens + chunk->first_token;
+    memcpy(tokens, chunk->tokens.tokens, chunk->tokens.length * sizeof(struct Token));
 
-        next_char(peeker);
-        token->col = peeker->col;
-        token->row = peeker->row;
-        token->token_type = OPEN_ROUND_BRACKET;
-        token->value = value.string;
+    free_token_list(&chunk->tokens);
+}
 
-        peeker->col++;
-        return 1;
+struct TokenList read_tokens_in_chunks(const char* file_buff, long fsize, int chunk_count) {
+    // QUOTED STRINGS END WITH THEIR LINE, SO A CHUNK THAT STARTS AT THE BEGINNING OF A LINE
+    // LEXES THE SAME ON ITS OWN
+    if (chunk_count > fsize / MIN_LEX_CHUNK_SIZE) {
+        chunk_count = (int)(fsize / MIN_LEX_CHUNK_SIZE);
     }
 
-    if (*char_at_pos == ')') {
-        struct StringReallocator value = new_string_reallocator();
-        add_char(&value, ')');
-        add_char(&value, 0);
+    if (chunk_count <= 1) {
+        return read_tokens(file_buff, fsize);
+    }
 
-        next_char(peeker);
-        token->col = peeker->col;
-        token->row = peeker->row;
-        token->token_type = CLOSE_ROUND_BRACKET;
-        token->value = value.string;
+    struct ChunkedLex lex;
+    lex.file_buff = file_buff;
+    lex.chunks = (struct LexChunk*)calloc(chunk_count, sizeof(struct LexChunk));
 
-        peeker->col++;
-        return 1;
+    int count = 0;
+    long start = 0;
+    while (start < fsize && count < chunk_count) {
+        long end = count + 1 == chunk_count ? fsize : fsize / chunk_count * (count + 1);
+        if (end < start) {
+            end = start;
+        }
+
+        const char* new_line = memchr(file_buff + end, '\n', fsize - end);
+        end = new_line != NULL ? new_line - file_buff + 1 : fsize;
+
+        lex.chunks[count].start = start;
+        lex.chunks[count].end = end;
+        count++;
+        start = end;
     }
 
-    return 0;
-}
+    run_parallel_tasks(count, count, lex_chunk_task, &lex);
 
-struct TokenList read_tokens(char* file_buff, long fsize) {
-    struct TokenList tokens = new_token_list();
-    struct CharPeeker peeker = new_char_peeker(file_buff, fsize);
+    long total = 0;
+    for (int i = 0;i < count;i++) {
+        lex.chunks[i].first_token = total;
+        total += lex.chunks[i].tokens.length;
+    }
 
-    while (peek_char(&peeker) != NULL) {
-        long read_bytes = 0;
-        read_bytes = skip_whitespaces(&peeker);
-        if (read_bytes != 0) {
-            continue;
-        }
+    struct TokenList tokens = new_token_list(file_buff);
+    tokens.tokens = (struct Token*)malloc((total + 1) * sizeof(struct Token));
+    tokens.length = total;
+    tokens.capacity = total + 1;
 
-        struct Token token;
-        read_bytes = read_unquoted_string_token(&peeker, &token);
-        if (read_bytes != 0) {
-            add_token(&tokens, token);
-            continue;
-        }
+    lex.tokens = tokens.tokens;
+    run_parallel_tasks(count, count, stitch_chunk_task, &lex);
 
-        read_bytes = read_quoted_string_token(&peeker, &token);
-        if (read_bytes != 0) {
-            add_token(&tokens, token);
-            continue;
-        }
+    free(lex.chunks);
+    return tokens;
+}
 
-        read_bytes = read_new_line_token(&peeker, &token);
-        if (read_bytes != 0) {
-            add_token(&tokens, token);
-            continue;
-        }
+struct Lexer new_lexer(const char* file_buff, long fsize) {
+    struct Lexer lexer;
+    lexer.peeker = new_char_peeker(file_buff, fsize);
+    lexer.source = file_buff;
+    lexer.window_start = 0;
+    lexer.window_length = 0;
 
-        read_bytes = read_number_token(&peeker, &token);
-        if (read_bytes != 0) {
-            add_token(&tokens, token);
-            continue;
-        }
+    return lexer;
+}
 
-        read_bytes = read_special_char(&peeker, &token);
-        if (read_bytes != 0) {
-            add_token(&tokens, token);
-            continue;
+struct Token* lexer_peek(struct Lexer* lexer, int distance) {
+    if (distance >= LEXER_LOOKAHEAD) {
+        printf("Lexer lookahead %d exceeds window of %d tokens \n", distance, LEXER_LOOKAHEAD);
+        exit(1);
+    }
+
+    while (lexer->window_length <= distance) {
+        int slot = (lexer->window_start + lexer->window_length) & (LEXER_LOOKAHEAD - 1);
+        if (!scan_token(&lexer->peeker, &lexer->window[slot])) {
+            return NULL;
         }
 
-        printf("Undefined token at position %ld \n", peeker.current_pos);
-        exit(1);
+        lexer->window_length++;
     }
 
-    return tokens;
-}
\ No newline at end of file
+    return &lexer->window[(lexer->window_start + distance) & (LEXER_LOOKAHEAD - 1)];
+}
+
+struct Token* lexer_next(struct Lexer* lexer) {
+    if (lexer_peek(lexer, 0) != NULL) {
+        lexer->window_start = (lexer->window_start + 1) & (LEXER_LOOKAHEAD - 1);
+        lexer->window_length--;
+    }
+
+    return lexer_peek(lexer, 0);
+}
@@ -1,12 +1,34 @@
 #ifndef LEXER_H_
 #define LEXER_H_
 
+#include "numbers.h"
+
 enum TokenType {
     QUOTED_STRING,
     UNQUOTED_STRING,
     NUMBER,
     NEW_LINE,
 
+    PRINT_KEYWORD,
+    IF_KEYWORD,
+    THEN_KEYWORD,
+    ELSEIF_KEYWORD,
+    ELSE_KEYWORD,
+    END_KEYWORD,
+    DO_KEYWORD,
+    LOOP_KEYWORD,
+    WHILE_KEYWORD,
+    UNTIL_KEYWORD,
+    FOR_KEYWORD,
+    TO_KEYWORD,
+    STEP_KEYWORD,
+    NEXT_KEYWORD,
+    DEFINT_KEYWORD,
+    DEFLNG_KEYWORD,
+    DEFSNG_KEYWORD,
+    DEFDBL_KEYWORD,
+    DEFSTR_KEYWORD,
+
     COMMA,
     SEMICOLON,
     MINUS,
@@ -15,31 +37,85 @@ enum TokenType {
     ASTERISK,
     BANG,
 
-    ASSIGN_OPERATOR,
-
     EQUALS,
+    NOT_EQUALS,
     GREATER_THAN,
+    GREATER_EQUALS,
     LESSER_THAN,
+    LESSER_EQUALS,
 
     OPEN_ROUND_BRACKET,
     CLOSE_ROUND_BRACKET,
 };
 
+// ROW AND COLUMN ARE WORKED OUT FROM offset WHEN SOMETHING PRINTS THEM
 struct Token {
     enum TokenType token_type;
+    int identifier_id;
+    long offset;
+    long length;
+    // ONLY SET FOR NUMBER TOKENS
+    struct NumberValue number;
+};
+
+// OFFSETS WHERE EACH LINE OF A SOURCE STARTS
+struct LineIndex {
+    long* line_starts;
+    long line_count;
+};
+
+// BOTH COUNT FROM 1
+struct SourcePosition {
     int row;
     int col;
-    char* value;
 };
 
 struct TokenList {
     long length;
     long capacity;
     struct Token* tokens;
+    const char* source;
 };
 
-struct TokenList read_tokens(char* file_buff, long fsize);
+// POWER OF TWO, THE WINDOW IS INDEXED WITH A MASK
+#define LEXER_LOOKAHEAD 8
+
+struct CharPeeker {
+    const char* file_buff;
+    long file_size;
+    long current_pos;
+};
+
+struct Lexer {
+    struct CharPeeker peeker;
+    const char* source;
+    struct Token window[LEXER_LOOKAHEAD];
+    int window_start;
+    int window_length;
+};
+
+struct TokenList read_tokens(const char* file_buff, long fsize);
+// LEXES file_buff[start, end), start SHOULD BE WHERE A LINE BEGINS
+struct TokenList read_token_range(const char* file_buff, long start, long end);
+// LEXES UP TO chunk_count SLICES OF A LARGE BUFFER AT ONCE, THE RESULT MATCHES read_tokens
+struct TokenList read_tokens_in_chunks(const char* file_buff, long fsize, int chunk_count);
+void free_token_list(struct TokenList* tokens);
+
+struct Lexer new_lexer(const char* file_buff, long fsize);
+struct Token* lexer_peek(struct Lexer* lexer, int distance);
+struct Token* lexer_next(struct Lexer* lexer);
 
 const char* get_token_type_string(enum TokenType token_type);
+const char* get_token_text(const char* source, const struct Token* token);
+int token_equals(const char* source, const struct Token* token, const char* lowercase_word);
+int tokens_equal(const char* source, const struct Token* left, const struct Token* right);
+void print_token_value(const char* source, const struct Token* token);
+
+struct LineIndex build_line_index(const char* source, long size);
+struct SourcePosition find_source_position(const struct LineIndex* index, long offset);
+// FOR ONE DIAGNOSTIC, COUNTS THE LINES BEFORE offset INSTEAD OF BUILDING AN INDEX
+struct SourcePosition get_source_position(const char* source, long offset);
+long get_token_start(const struct Token* token);
+void free_line_index(struct LineIndex* index);
 
 #endif
\ No newline at end of file
@@ -1,38 +1,561 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "lexer.h"
 #include "parser.h"
+#include "interner.h"
+#include "source.h"
+#include "arena.h"
+#include "optimizer.h"
+#include "compiler.h"
+#include "flat_ast.h"
+#include "codegen_x86.h"
+#include "codegen_c.h"
+#include "toolchain.h"
+#include "vm.h"
+#include "thread_pool.h"
+#include "document.h"
+#include "cache.h"
+#include "charclass.h"
 
-int main(void) {
-    FILE* file = fopen("test.qb", "r");
-    if (file == NULL) {
-        printf("Error reading a file \n");
+#define FILES_PER_WORKER_BATCH 16
+// SMALLER FILES LEX FASTER THAN THE POOL STARTS
+#define PARALLEL_LEX_MIN_SIZE (1024 * 1024)
+
+// REPLACES removed_length BYTES AT offset WITH text
+struct SourceEdit {
+    long offset;
+    long removed_length;
+    char* text;
+    long length;
+};
+
+struct DriverOptions {
+    int dump_tokens;
+    int dump_bytecode;
+    int dump_memory;
+    int run;
+    int jit;
+    int optimize;
+    const char* assembly_path;
+    const char* native_path;
+    const char* c_path;
+    const char* aot_path;
+    int jobs;
+    int pipeline;
+    // APPLIED TO EVERY FILE IN ORDER THROUGH A DOCUMENT, WHICH RE-PARSES WHAT EACH ONE CHANGES
+    struct SourceEdit* edits;
+    int edit_count;
+    // NULL UNLESS --cache, THEN FILES WITH AN ENTRY SKIP LEXING, PARSING AND COMPILING
+    struct CompilationCache* cache;
+};
+
+// A FILE GOES THROUGH THREE PHASES: OPENED IN ORDER, LEXED AND PARSED ON ANY WORKER,
+// THEN OPTIMIZED, COMPILED AND RUN IN ORDER SO THE OUTPUT NEVER DEPENDS ON SCHEDULING
+struct CompilationUnit {
+    const char* path;
+    struct SourceFile source;
+    int is_open;
+    struct TokenList tokens;
+    struct Program program;
+    // ONLY SET WHEN THE FILE IS EDITED, IT OWNS THE PROGRAM'S ARENA
+    struct Document* document;
+    // ON A CACHE HIT chunk IS ALL THERE IS, NOTHING WAS LEXED OR PARSED
+    int is_cached;
+    uint64_t cache_key;
+    struct Chunk chunk;
+};
+
+// THE INPUT FILES FROM THE COMMAND LINE AND MANIFESTS, IN THE ORDER THEY WERE GIVEN
+struct PathList {
+    const char** paths;
+    int count;
+    int capacity;
+};
+
+struct ParseJob {
+    struct CompilationUnit* units;
+    struct DriverOptions* options;
+    // ONE PER WORKER, RESET AFTER EVERY BATCH INSTEAD OF FREEING EACH PROGRAM'S BLOCKS
+    struct Arena** worker_arenas;
+};
+
+typedef void (*GenerateFunction)(struct Program* program, FILE* out);
+
+static int open_unit(struct CompilationUnit* unit, const char* path);
+static void parse_unit(struct CompilationUnit* unit, struct DriverOptions* options, struct Arena* arena);
+static void parse_edited_unit(struct CompilationUnit* unit, struct DriverOptions* options);
+static void parse_unit_task(void* context, int worker, int task);
+static int finish_unit(struct CompilationUnit* unit, struct DriverOptions* options);
+static int use_chunk(struct Chunk* chunk, struct DriverOptions* options);
+static int compile_files(const char** paths, int path_count, struct DriverOptions* options);
+static void add_path(struct PathList* list, const char* path);
+static int read_manifest(const char* path, struct Arena* arena, struct PathList* list);
+static int read_edit(const char* spec, struct Arena* arena, struct SourceEdit* edit);
+static int build_native_program(struct Program* program, GenerateFunction generate,
+    const char* generated_path, const char* executable_path, const char* extension);
+static void print_usage(const char* program_name);
+
+static void print_usage(const char* program_name) {
+    printf("Usage: %s [--tokens] [--bytecode] [--memory] [--run] [--jit] [--no-optimize] [--jobs n] [--pipeline] [--edit offset,length,text] [--cache dir] [--manifest list] [--asm out.s] [--native out] [--emit-c out.c] [--aot out] [file ...] \n", program_name);
+    printf("--memory reports the symbol table, AST and VM slot sizes of each program \n");
+    printf("--jit runs like --run and compiles hot FOR and DO loops to machine code \n");
+    printf("--asm writes x86-64 assembly, --native also links it with the runtime into an executable \n");
+    printf("--emit-c writes C, --aot also builds it with gcc -O2 and the runtime into an executable \n");
+    printf("--jobs lexes and parses that many files at once, the default is one per core \n");
+    printf("--pipeline lexes each file on its own thread while the parser reads its tokens \n");
+    printf("--edit replaces length bytes at offset with text and re-parses only the statements it touches, \\n in text is a new line \n");
+    printf("--cache keeps the bytecode of each file in dir and reuses it while the file and the compiler stay the same \n");
+    printf("--manifest reads more input files from list, one path per line, # starts a comment \n");
+    printf("Reads standard input when no file or '-' is given \n");
+    printf("QB_CHARCLASS=scalar|sse2|avx2 picks how the lexer scans runs of characters, this machine uses %s \n",
+        get_charclass_implementation_name());
+}
+
+static int open_unit(struct CompilationUnit* unit, const char* path) {
+    unit->path = path;
+    unit->is_open = open_source_file(path, &unit->source) == 0;
+    return unit->is_open ? 0 : 1;
+}
+
+static void parse_unit(struct CompilationUnit* unit, struct DriverOptions* options, struct Arena* arena) {
+    // TOUCHES NOTHING SHARED BUT THE INTERNER, THE AST GOES TO THE CALLING WORKER'S ARENA
+    // OR TO A NEW ONE WHEN arena IS NULL
+
+    // AN EDITED FILE KEEPS ITS OWN ARENA IN THE DOCUMENT
+    if (options->edit_count > 0) {
+        parse_edited_unit(unit, options);
+        return;
+    }
+
+    if (options->cache != NULL) {
+        unit->cache_key = get_cache_key(unit->source.data, unit->source.size, options->optimize);
+        unit->is_cached = load_cached_chunk(options->cache, unit->cache_key, unit->source.size, &unit->chunk);
+        if (unit->is_cached) {
+            return;
+        }
+    }
+
+    // A LONE LARGE FILE HAS THE POOL TO ITSELF, SO ITS LEXING AND PARSING ARE SPLIT ACROSS THE WORKERS
+    if (arena == NULL && options->jobs > 1 && unit->source.size >= PARALLEL_LEX_MIN_SIZE) {
+        struct TokenList tokens = read_tokens_in_chunks(unit->source.data, unit->source.size, options->jobs);
+        unit->program = parse_in_parallel(tokens, options->jobs);
+        if (options->dump_tokens) {
+            unit->tokens = tokens;
+        } else {
+            free_token_list(&tokens);
+        }
+        return;
+    }
+
+    if (options->dump_tokens) {
+        unit->tokens = read_tokens(unit->source.data, unit->source.size);
+    }
+
+    // FILES ALREADY SPREAD OVER THE POOL KEEP ONE THREAD EACH
+    if (arena == NULL && options->pipeline) {
+        unit->program = parse_pipelined(unit->source.data, unit->source.size);
+        return;
+    }
+
+    struct Lexer lexer = new_lexer(unit->source.data, unit->source.size);
+    unit->program = arena != NULL ? parse_stream_in_arena(&lexer, arena) : parse_stream(&lexer);
+}
+
+// THE FILE IS PARSED ONCE AS IT IS, THEN EACH EDIT RE-PARSES ONLY THE STATEMENTS AROUND IT
+static void parse_edited_unit(struct CompilationUnit* unit, struct DriverOptions* options) {
+    unit->document = open_document(unit->source.data, unit->source.size);
+    for (int i = 0;i < options->edit_count;i++) {
+        struct SourceEdit* edit = &options->edits[i];
+        edit_document(unit->document, edit->offset, edit->removed_length, edit->text, edit->length);
+    }
+
+    unit->program = *get_document_program(unit->document);
+    unit->program.owns_arena = 0;
+
+    // THE SOURCE BECOMES THE EDITED TEXT, WHICH IS WHAT --tokens SHOWS
+    long size = get_document_size(unit->document);
+    char* text = (char*)malloc(size + 1);
+    copy_document_text(unit->document, text);
+    close_source_file(&unit->source);
+    unit->source.data = text;
+    unit->source.size = size;
+
+    if (options->dump_tokens) {
+        unit->tokens = read_tokens(unit->source.data, unit->source.size);
+    }
+}
+
+static void parse_unit_task(void* context, int worker, int task) {
+    struct ParseJob* job = (struct ParseJob*)context;
+    if (job->units[task].is_open) {
+        parse_unit(&job->units[task], job->options, job->worker_arenas[worker]);
+    }
+}
+
+static int finish_unit(struct CompilationUnit* unit, struct DriverOptions* options) {
+    if (unit->is_cached) {
+        int status = use_chunk(&unit->chunk, options);
+        free_chunk(&unit->chunk);
+        close_source_file(&unit->source);
+        return status;
+    }
+
+    struct Program program = unit->program;
+
+    if (options->dump_tokens) {
+        struct TokenList tokens = unit->tokens;
+        struct LineIndex lines = build_line_index(unit->source.data, unit->source.size);
+        printf("TokenList tokens is %ld \n", tokens.length);
+
+        for (int i = 0;i < tokens.length;i++) {
+            struct SourcePosition position = find_source_position(&lines, get_token_start(&tokens.tokens[i]));
+            printf("Token type is %s | ", get_token_type_string(tokens.tokens[i].token_type));
+            print_token_value(tokens.source, &tokens.tokens[i]);
+            printf(" | row %d | col %d \n", position.row, position.col);
+        }
+
+        free_line_index(&lines);
+        free_token_list(&tokens);
+    }
+
+    // A HIT HAS NO AST TO PRINT, SO A MISS DOESN'T PRINT IT EITHER
+    if (options->cache == NULL) {
+        print_program_blocks(&program);
+        printf("program size is %ld \n", program.list->size);
+    }
+
+    if (options->optimize) {
+        optimize_program(&program);
+    }
+
+    if (options->dump_memory) {
+        print_memory_footprint(&program);
+
+        // THE COMPILER WORKS ON THIS LAYOUT, IT IS BUILT AGAIN HERE ONLY TO BE MEASURED
+        struct FlatAst ast = flatten_program(&program);
+        printf("memory: %d flat AST nodes, %zu bytes each, %zu bytes with their side tables \n",
+            ast.node_count, sizeof(struct FlatNode), get_flat_ast_size(&ast));
+        free_flat_ast(&ast);
+    }
+
+    int status = 0;
+    if (options->dump_bytecode || options->dump_memory || options->run || options->cache != NULL) {
+        struct Chunk chunk = compile_program(&program);
+        if (options->cache != NULL) {
+            store_cached_chunk(options->cache, unit->cache_key, unit->source.size, &chunk);
+        }
+
+        status = use_chunk(&chunk, options);
+        free_chunk(&chunk);
+    }
+
+    if (status == 0 && (options->assembly_path != NULL || options->native_path != NULL)) {
+        status = build_native_program(&program, generate_x86_assembly, options->assembly_path, options->native_path, ".s");
+    }
+
+    if (status == 0 && (options->c_path != NULL || options->aot_path != NULL)) {
+        status = build_native_program(&program, generate_c_source, options->c_path, options->aot_path, ".c");
+    }
+
+    free_program(&program);
+    if (unit->document != NULL) {
+        close_document(unit->document);
+    }
+    close_source_file(&unit->source);
+
+    return status;
+}
+
+static int use_chunk(struct Chunk* chunk, struct DriverOptions* options) {
+    if (options->dump_bytecode) {
+        disassemble_chunk(chunk);
     }
 
-    fseek(file, 0, SEEK_END);
-    long fsize = ftell(file);
-    fseek(file, 0, SEEK_SET);
+    if (options->dump_memory) {
+        printf("memory: %ld bytes of bytecode, %d constants, %d slots in %zu bytes \n", chunk->code_length,
+            chunk->constant_count, chunk->slot_count, chunk->slot_count * sizeof(struct Value));
+    }
+
+    if (options->run) {
+        return run_chunk(chunk, options->jit);
+    }
+
+    return 0;
+}
+
+static int compile_files(const char** paths, int path_count, struct DriverOptions* options) {
+    struct CompilationUnit* units = (struct CompilationUnit*)calloc(path_count + 1, sizeof(struct CompilationUnit));
+    int status = 0;
+
+    // ONE WORKER KEEPS THE OLD FILE BY FILE ORDER AND ONLY EVER HOLDS ONE PROGRAM
+    if (options->jobs <= 1 || path_count == 1) {
+        for (int i = 0;i < path_count;i++) {
+            if (open_unit(&units[i], paths[i]) != 0) {
+                status = 1;
+                continue;
+            }
+
+            parse_unit(&units[i], options, NULL);
+            if (finish_unit(&units[i], options) != 0) {
+                status = 1;
+            }
+        }
+
+        free(units);
+        return status;
+    }
+
+    // FILES GO THROUGH THE POOL IN BATCHES SO ONLY A FEW PARSED PROGRAMS ARE HELD AT ONCE
+    int batch_size = options->jobs * FILES_PER_WORKER_BATCH;
+    struct ParseJob job;
+    job.options = options;
+    job.worker_arenas = (struct Arena**)malloc(options->jobs * sizeof(struct Arena*));
+    for (int i = 0;i < options->jobs;i++) {
+        job.worker_arenas[i] = new_arena(0);
+    }
+
+    for (int first = 0;first < path_count;first += batch_size) {
+        int count = path_count - first < batch_size ? path_count - first : batch_size;
+        for (int i = first;i < first + count;i++) {
+            if (open_unit(&units[i], paths[i]) != 0) {
+                status = 1;
+            }
+        }
+
+        job.units = &units[first];
+        run_parallel_tasks(count, options->jobs, parse_unit_task, &job);
+
+        for (int i = first;i < first + count;i++) {
+            if (units[i].is_open && finish_unit(&units[i], options) != 0) {
+                status = 1;
+            }
+        }
+
+        for (int i = 0;i < options->jobs;i++) {
+            reset_arena(job.worker_arenas[i]);
+        }
+    }
+
+    for (int i = 0;i < options->jobs;i++) {
+        free_arena(job.worker_arenas[i]);
+    }
+    free(job.worker_arenas);
+
+    free(units);
+    return status;
+}
+
+static void add_path(struct PathList* list, const char* path) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity > 0 ? list->capacity * 2 : 8;
+        list->paths = (const char**)realloc((void*)list->paths, list->capacity * sizeof(const char*));
+    }
+
+    list->paths[list->count++] = path;
+}
+
+static int read_manifest(const char* path, struct Arena* arena, struct PathList* list) {
+    struct SourceFile manifest;
+    if (open_source_file(path, &manifest) != 0) {
+        return 1;
+    }
+
+    long line_start = 0;
+    while (line_start < manifest.size) {
+        long line_end = line_start;
+        while (line_end < manifest.size && manifest.data[line_end] != '\n') {
+            line_end++;
+        }
+
+        long start = line_start;
+        long end = line_end;
+        while (start < end && (manifest.data[start] == ' ' || manifest.data[start] == '\t')) {
+            start++;
+        }
+        while (end > start && (manifest.data[end - 1] == ' ' || manifest.data[end - 1] == '\t' || manifest.data[end - 1] == '\r')) {
+            end--;
+        }
+
+        if (end > start && manifest.data[start] != '#') {
+            char* entry = (char*)arena_alloc(arena, end - start + 1);
+            memcpy(entry, manifest.data + start, end - start);
+            entry[end - start] = 0;
+            add_path(list, entry);
+        }
 
-    char* file_buff = (char*)malloc(fsize * sizeof(char) + 1);
-    fread(file_buff, sizeof(char), fsize, file);
-    file_buff[fsize] = 0;
-    fclose(file);
+        line_start = line_end + 1;
+    }
+
+    close_source_file(&manifest);
+    return 0;
+}
+
+// AN EDIT IS GIVEN AS offset,removed_length,text
+static int read_edit(const char* spec, struct Arena* arena, struct SourceEdit* edit) {
+    char* end;
+    edit->offset = strtol(spec, &end, 10);
+    if (end == spec || *end != ',') {
+        return 1;
+    }
+
+    const char* length = end + 1;
+    edit->removed_length = strtol(length, &end, 10);
+    if (end == length || *end != ',') {
+        return 1;
+    }
+
+    const char* text = end + 1;
+    edit->text = (char*)arena_alloc(arena, strlen(text) + 1);
+    edit->length = 0;
+    for (long i = 0;text[i] != 0;i++) {
+        if (text[i] == '\\' && text[i + 1] == 'n') {
+            edit->text[edit->length++] = '\n';
+            i++;
+        } else {
+            edit->text[edit->length++] = text[i];
+        }
+    }
+
+    return 0;
+}
+
+static int build_native_program(struct Program* program, GenerateFunction generate,
+    const char* generated_path, const char* executable_path, const char* extension) {
+    // BUILDING AN EXECUTABLE WITHOUT AN EXPLICIT OUTPUT KEEPS THE GENERATED FILE NEXT TO IT
+    char default_generated_path[4096];
+    if (generated_path == NULL) {
+        snprintf(default_generated_path, sizeof(default_generated_path), "%s%s", executable_path, extension);
+        generated_path = default_generated_path;
+    }
 
-    struct TokenList tokens = read_tokens(file_buff, fsize);
-    printf("TokenList tokens is %ld \n", tokens.length);
+    FILE* out = fopen(generated_path, "w");
+    if (out == NULL) {
+        perror(generated_path);
+        return 1;
+    }
+
+    generate(program, out);
+    if (fclose(out) != 0) {
+        perror(generated_path);
+        return 1;
+    }
 
-    for (int i = 0;i < tokens.length;i++) {
-        printf(
-            "Token type is %s | %s | row %d | col %d \n", 
-            get_token_type_string(tokens.tokens[i].token_type), 
-            tokens.tokens[i].value, 
-            tokens.tokens[i].row, 
-            tokens.tokens[i].col
-        );
+    if (executable_path == NULL) {
+        return 0;
     }
 
-    struct Program program = parse(tokens);
-    printf("program size is %ld \n", program.list->size);
+    if (link_native_program(generated_path, executable_path, "-O2") != 0) {
+        printf("Building %s failed \n", executable_path);
+        return 1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    struct DriverOptions options;
+    options.dump_tokens = 0;
+    options.dump_bytecode = 0;
+    options.dump_memory = 0;
+    options.pipeline = 0;
+    options.run = 0;
+    options.jit = 0;
+    options.optimize = 1;
+    options.assembly_path = NULL;
+    options.native_path = NULL;
+    options.c_path = NULL;
+    options.aot_path = NULL;
+    options.jobs = get_default_worker_count();
+    options.edits = (struct SourceEdit*)malloc(argc * sizeof(struct SourceEdit));
+    options.edit_count = 0;
+    options.cache = NULL;
+    struct CompilationCache cache = {0};
+
+    // PATHS READ FROM MANIFESTS AND THE TEXT OF EDITS LIVE IN path_arena
+    struct Arena* path_arena = new_arena(0);
+    struct PathList paths = {NULL, 0, 0};
+    int status = 0;
+    for (int i = 1;i < argc;i++) {
+        if (strcmp(argv[i], "--tokens") == 0) {
+            options.dump_tokens = 1;
+        } else if (strcmp(argv[i], "--bytecode") == 0) {
+            options.dump_bytecode = 1;
+        } else if (strcmp(argv[i], "--memory") == 0) {
+            options.dump_memory = 1;
+        } else if (strcmp(argv[i], "--run") == 0) {
+            options.run = 1;
+        } else if (strcmp(argv[i], "--jit") == 0) {
+            options.run = 1;
+            options.jit = 1;
+        } else if (strcmp(argv[i], "--no-optimize") == 0) {
+            options.optimize = 0;
+        } else if (strcmp(argv[i], "--pipeline") == 0) {
+            options.pipeline = 1;
+        } else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            options.jobs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--edit") == 0 && i + 1 < argc) {
+            if (read_edit(argv[++i], path_arena, &options.edits[options.edit_count]) != 0) {
+                printf("Bad edit %s, expected offset,length,text \n", argv[i]);
+                status = 1;
+            } else {
+                options.edit_count++;
+            }
+        } else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            cache.directory = argv[++i];
+            options.cache = &cache;
+        } else if (strcmp(argv[i], "--manifest") == 0 && i + 1 < argc) {
+            if (read_manifest(argv[++i], path_arena, &paths) != 0) {
+                status = 1;
+            }
+        } else if (strcmp(argv[i], "--asm") == 0 && i + 1 < argc) {
+            options.assembly_path = argv[++i];
+        } else if (strcmp(argv[i], "--native") == 0 && i + 1 < argc) {
+            options.native_path = argv[++i];
+        } else if (strcmp(argv[i], "--emit-c") == 0 && i + 1 < argc) {
+            options.c_path = argv[++i];
+        } else if (strcmp(argv[i], "--aot") == 0 && i + 1 < argc) {
+            options.aot_path = argv[++i];
+        } else if (strcmp(argv[i], "--help") == 0) {
+            print_usage(argv[0]);
+            free(paths.paths);
+            free(options.edits);
+            free_arena(path_arena);
+            return 0;
+        } else if (argv[i][0] == '-' && argv[i][1] != 0) {
+            printf("Unknown option %s \n", argv[i]);
+            print_usage(argv[0]);
+            free(paths.paths);
+            free(options.edits);
+            free_arena(path_arena);
+            return 1;
+        } else {
+            add_path(&paths, argv[i]);
+        }
+    }
+
+    if (paths.count == 0 && status == 0) {
+        add_path(&paths, "-");
+    }
+
+    // AN ENTRY ONLY HOLDS BYTECODE, OUTPUTS BUILT FROM THE TOKENS OR THE AST NEED THE FULL PIPELINE
+    if (options.cache != NULL && (options.dump_tokens || options.dump_memory || options.edit_count > 0 ||
+        options.assembly_path != NULL || options.native_path != NULL || options.c_path != NULL || options.aot_path != NULL)) {
+        printf("--cache is ignored with --tokens, --memory, --edit and the native outputs \n");
+        options.cache = NULL;
+    }
+
+    if (compile_files(paths.paths, paths.count, &options) != 0) {
+        status = 1;
+    }
+
+    if (options.cache != NULL) {
+        print_cache_statistics(options.cache);
+    }
 
-    free(file_buff);
-}
\ No newline at end of file
+    free(paths.paths);
+    free(options.edits);
+    free_arena(path_arena);
+    free_interner();
+    return status;
+}
@@ -0,0 +1,293 @@
+#include "numbers.h"
+#include "charclass.h"
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+
+#define INTEGER_MAX 32767
+#define LONG_MAX_VALUE 2147483647
+#define MAX_EXACT_MANTISSA (1ULL << 53)
+#define MAX_EXACT_POWER 22
+#define MAX_SIGNIFICANT_DIGITS 19
+// FLT_MAX PLUS HALF ITS LAST PLACE
+#define SINGLE_OVERFLOW 0x1.ffffffp127
+
+// EVERY POWER OF TEN UP TO 1e22 IS EXACT IN A DOUBLE
+static const double exact_powers_of_ten[MAX_EXACT_POWER + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+static int is_digit(char c);
+static int hex_digit_value(char c);
+static long parse_hex_literal(const char* text, long length, struct NumberValue* value, enum NumberError* error);
+static double decimal_to_double(const char* text, long length, uint64_t mantissa, int exponent, int is_exact);
+
+static int is_digit(char c) {
+    return (unsigned char)(c - '0') < 10;
+}
+
+static int hex_digit_value(char c) {
+    if (is_digit(c)) {
+        return c - '0';
+    }
+
+    unsigned char lower = (unsigned char)(c | 0x20) - 'a';
+    return lower < 6 ? lower + 10 : -1;
+}
+
+static long parse_hex_literal(const char* text, long length, struct NumberValue* value, enum NumberError* error) {
+    // &H WITH UP TO 4 DIGITS IS AN INTEGER AND UP TO 8 A LONG, BOTH WRAP TO NEGATIVE LIKE QBASIC
+    long i = 2;
+    uint64_t bits = 0;
+    int digit;
+    while (i < length && (digit = hex_digit_value(text[i])) >= 0) {
+        if (bits > 0xFFFFFFFFULL) {
+            *error = NUMBER_OVERFLOW;
+        }
+        bits = (bits << 4) | (uint64_t)digit;
+        i++;
+    }
+
+    if (i == 2) {
+        *error = NUMBER_MALFORMED;
+        return i;
+    }
+
+    int is_long = i < length && text[i] == '&';
+    if (is_long) {
+        i++;
+    }
+
+    if (bits > 0xFFFFFFFFULL) {
+        *error = NUMBER_OVERFLOW;
+    } else if (bits <= 0xFFFF && !is_long) {
+        value->type = INTEGER_NUMBER;
+        value->integer = (int16_t)(uint16_t)bits;
+    } else {
+        value->type = LONG_NUMBER;
+        value->integer = (int32_t)(uint32_t)bits;
+    }
+
+    return i;
+}
+
+static double decimal_to_double(const char* text, long length, uint64_t mantissa, int exponent, int is_exact) {
+    // CLINGER'S FAST PATH: BOTH THE MANTISSA AND THE POWER OF TEN ARE EXACT DOUBLES,
+    // SO ONE CORRECTLY ROUNDED MULTIPLY OR DIVIDE GIVES THE CORRECTLY ROUNDED RESULT
+    if (is_exact && mantissa <= MAX_EXACT_MANTISSA && exponent >= -MAX_EXACT_POWER && exponent <= MAX_EXACT_POWER) {
+        double result = (double)mantissa;
+        return exponent < 0 ? result / exact_powers_of_ten[-exponent] : result * exact_powers_of_ten[exponent];
+    }
+
+    // EVERYTHING ELSE GOES THROUGH strtod, WHICH IS EXACT BUT SLOW. 'D' EXPONENTS BECOME 'E'
+    char small_buffer[64];
+    char* buffer = length < (long)sizeof(small_buffer) ? small_buffer : (char*)malloc(length + 1);
+    for (long i = 0;i < length;i++) {
+        buffer[i] = (text[i] | 0x20) == 'd' ? 'e' : text[i];
+    }
+    buffer[length] = 0;
+
+    double result = strtod(buffer, NULL);
+    if (buffer != small_buffer) {
+        free(buffer);
+    }
+
+    return result;
+}
+
+long parse_number_literal(const char* text, long length, struct NumberValue* value, enum NumberError* error) {
+    // RETURNS HOW MANY BYTES THE LITERAL SPANS, INCLUDING ITS EXPONENT AND TYPE SUFFIX
+    *error = NUMBER_OK;
+    value->type = INTEGER_NUMBER;
+    value->integer = 0;
+
+    if (length >= 2 && text[0] == '&' && (text[1] | 0x20) == 'h') {
+        return parse_hex_literal(text, length, value, error);
+    }
+
+    long run = scan_number_run(text, length);
+    uint64_t mantissa = 0;
+    int significant_digits = 0;
+    int exponent = 0;
+    int dot_count = 0;
+    int digit_count = 0;
+    int is_exact = 1;
+
+    for (long i = 0;i < run;i++) {
+        if (text[i] == '.') {
+            dot_count++;
+            continue;
+        }
+
+        digit_count++;
+        if (mantissa == 0 && text[i] == '0') {
+            // LEADING ZEROS ARE NOT SIGNIFICANT
+            exponent -= dot_count > 0;
+            continue;
+        }
+
+        if (significant_digits < MAX_SIGNIFICANT_DIGITS) {
+            mantissa = mantissa * 10 + (uint64_t)(text[i] - '0');
+            significant_digits++;
+            exponent -= dot_count > 0;
+        } else {
+            is_exact &= text[i] == '0';
+            exponent += dot_count == 0;
+        }
+    }
+
+    if (dot_count > 1 || digit_count == 0) {
+        *error = NUMBER_MALFORMED;
+        return run;
+    }
+
+    // AN EXPONENT IS ONLY TAKEN WHEN DIGITS FOLLOW, OTHERWISE THE LETTER STARTS THE NEXT TOKEN
+    long i = run;
+    int has_exponent = 0;
+    int is_double_exponent = 0;
+    if (i < length && ((text[i] | 0x20) == 'e' || (text[i] | 0x20) == 'd')) {
+        long digits_start = i + 1 + (i + 1 < length && (text[i + 1] == '+' || text[i + 1] == '-'));
+        if (digits_start < length && is_digit(text[digits_start])) {
+            int is_negative = text[i + 1] == '-';
+            is_double_exponent = (text[i] | 0x20) == 'd';
+            has_exponent = 1;
+
+            int written_exponent = 0;
+            for (i = digits_start;i < length && is_digit(text[i]);i++) {
+                if (written_exponent < 100000) {
+                    written_exponent = written_exponent * 10 + (text[i] - '0');
+                }
+            }
+            exponent += is_negative ? -written_exponent : written_exponent;
+        }
+    }
+
+    long literal_length = i;
+    char suffix = i < length ? text[i] : 0;
+    if (suffix == '%' || suffix == '&' || suffix == '!' || suffix == '#') {
+        i++;
+    } else {
+        suffix = 0;
+    }
+
+    int is_integral = dot_count == 0 && !has_exponent;
+    if (suffix == '%' || suffix == '&' || (suffix == 0 && is_integral)) {
+        int64_t limit = suffix == '%' ? INTEGER_MAX : LONG_MAX_VALUE;
+        if (!is_integral) {
+            *error = NUMBER_MALFORMED;
+            return i;
+        }
+
+        if (is_exact && significant_digits + exponent <= 10 && mantissa <= (uint64_t)LONG_MAX_VALUE) {
+            int64_t integer = (int64_t)mantissa;
+            for (int j = 0;j < exponent;j++) {
+                integer *= 10;
+            }
+
+            if (integer <= limit) {
+                value->type = integer <= INTEGER_MAX && suffix != '&' ? INTEGER_NUMBER : LONG_NUMBER;
+                value->integer = integer;
+                return i;
+            }
+        }
+
+        if (suffix != 0) {
+            *error = NUMBER_OVERFLOW;
+            return i;
+        }
+    }
+
+    // UNSUFFIXED REALS STAY DOUBLE SO THEY PRINT EXACTLY AS WRITTEN, ONLY '!' ROUNDS TO SINGLE
+    double real = decimal_to_double(text, literal_length, mantissa, exponent, is_exact);
+    // A LITERAL TOO BIG FOR ITS TYPE IS AN ERROR LIKE AN OUT OF RANGE INTEGER, NOT AN INFINITY.
+    // A SINGLE OVERFLOWS FROM HALFWAY PAST FLT_MAX, WHERE ROUNDING WOULD GO TO INFINITY
+    int is_single = suffix == '!' && !is_double_exponent;
+    if (real > DBL_MAX || real < -DBL_MAX || (is_single && (real >= SINGLE_OVERFLOW || real <= -SINGLE_OVERFLOW))) {
+        *error = NUMBER_OVERFLOW;
+        return i;
+    }
+
+    if (is_single) {
+        value->type = SINGLE_NUMBER;
+        value->real = (double)(float)real;
+    } else {
+        value->type = DOUBLE_NUMBER;
+        value->real = real;
+    }
+
+    return i;
+}
+
+struct NumberValue make_integer_number(int64_t integer) {
+    struct NumberValue value;
+    if (integer >= -INTEGER_MAX - 1 && integer <= INTEGER_MAX) {
+        value.type = INTEGER_NUMBER;
+        value.integer = integer;
+    } else if (integer >= -(int64_t)LONG_MAX_VALUE - 1 && integer <= LONG_MAX_VALUE) {
+        value.type = LONG_NUMBER;
+        value.integer = integer;
+    } else {
+        value.type = DOUBLE_NUMBER;
+        value.real = (double)integer;
+    }
+
+    return value;
+}
+
+struct NumberValue make_real_number(double real) {
+    struct NumberValue value;
+    value.type = DOUBLE_NUMBER;
+    value.real = real;
+
+    return value;
+}
+
+int is_integer_number(struct NumberValue value) {
+    return value.type == INTEGER_NUMBER || value.type == LONG_NUMBER;
+}
+
+// ROUNDS HALF TO EVEN LIKE QBASIC'S CINT, RETURNS 0 WHEN THE VALUE DOES NOT FIT THE TYPE
+int convert_number(double value, enum NumberType type, double* result) {
+    switch (type)
+    {
+    case INTEGER_NUMBER:
+    case LONG_NUMBER: {
+        double limit = type == INTEGER_NUMBER ? INTEGER_MAX + 1.0 : LONG_MAX_VALUE + 1.0;
+        if (!(value > -limit - 1 && value < limit)) {
+            return 0;
+        }
+
+        // ADDING 2^52 PUSHES THE FRACTION OUT OF THE MANTISSA AND THE FPU ROUNDS IT HALF TO EVEN
+        double rounded = value >= 0 ? (value + 0x1p52) - 0x1p52 : -((-value + 0x1p52) - 0x1p52);
+        if (rounded < -limit || rounded >= limit) {
+            return 0;
+        }
+
+        // + 0.0 TURNS A NEGATIVE ZERO INTO 0 LIKE AN INTEGER REGISTER WOULD
+        *result = rounded + 0.0;
+        return 1;
+    }
+    case SINGLE_NUMBER:
+        *result = (double)(float)value;
+        return 1;
+    default:
+        *result = value;
+        return 1;
+    }
+}
+
+double get_number_as_double(struct NumberValue value) {
+    return is_integer_number(value) ? (double)value.integer : value.real;
+}
+
+const char* get_number_type_string(enum NumberType type) {
+    switch (type)
+    {
+    case INTEGER_NUMBER: return "INTEGER";
+    case LONG_NUMBER: return "LONG";
+    case SINGLE_NUMBER: return "SINGLE";
+    case DOUBLE_NUMBER: return "DOUBLE";
+    default: return "UNDEFINED";
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef NUMBERS_H_
+#define NUMBERS_H_
+
+#include <stdint.h>
+
+// QBASIC NUMERIC TYPES, IN WIDENING ORDER
+enum NumberType {
+    INTEGER_NUMBER,
+    LONG_NUMBER,
+    SINGLE_NUMBER,
+    DOUBLE_NUMBER,
+};
+
+struct NumberValue {
+    enum NumberType type;
+    union {
+        int64_t integer;
+        double real;
+    };
+};
+
+enum NumberError {
+    NUMBER_OK,
+    NUMBER_MALFORMED,
+    NUMBER_OVERFLOW,
+};
+
+long parse_number_literal(const char* text, long length, struct NumberValue* value, enum NumberError* error);
+
+struct NumberValue make_integer_number(int64_t integer);
+struct NumberValue make_real_number(double real);
+int is_integer_number(struct NumberValue value);
+int convert_number(double value, enum NumberType type, double* result);
+double get_number_as_double(struct NumberValue value);
+const char* get_number_type_string(enum NumberType type);
+
+#endif
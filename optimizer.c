@@ -0,0 +1,401 @@
+#include "optimizer.h"
+#include "arena.h"
+#include <string.h>
+
+struct Optimizer {
+    struct Arena* arena;
+};
+
+static int is_number_constant(struct AstNode* node, double value);
+static int is_numeric_expression(struct AstNode* node);
+static int is_integer_expression(struct AstNode* node);
+static void make_number_constant(struct AstNode* node, struct Token* token, struct NumberValue value);
+static void make_string_constant(struct Optimizer* optimizer, struct AstNode* node, struct Token* token,
+    struct AstNode* left, struct AstNode* right);
+
+static void optimize_expression(struct Optimizer* optimizer, struct AstNode* node);
+static void optimize_prefix_expression(struct Optimizer* optimizer, struct AstNode* node);
+static void optimize_infix_expression(struct Optimizer* optimizer, struct AstNode* node);
+static int fold_integer_operation(enum TokenType operator, int64_t left, int64_t right, struct NumberValue* result);
+static int fold_number_operation(enum TokenType operator, struct NumberValue left, struct NumberValue right,
+    struct NumberValue* result);
+static int fold_string_comparison(enum TokenType operator, struct AstNode* left, struct AstNode* right, struct NumberValue* result);
+static int simplify_identity(struct AstNode* node);
+
+static void optimize_statements(struct Optimizer* optimizer, struct StatementsList* list);
+static void optimize_statement(struct Optimizer* optimizer, struct AstNode* node);
+static void optimize_print_statement(struct Optimizer* optimizer, struct PrintStatement* statement);
+
+static int is_number_constant(struct AstNode* node, double value) {
+    return node->node_type == CONST_NUMBER_EXPRESSION && get_number_as_double(node->const_number_expression.value) == value;
+}
+
+static int is_numeric_expression(struct AstNode* node) {
+    switch (node->node_type)
+    {
+    case CONST_NUMBER_EXPRESSION:
+    case PREFIX_EXPRESSION:
+        return 1;
+    case INFIX_EXPRESSION:
+        // ONLY '+' CAN PRODUCE A STRING, EVERYTHING ELSE IS NUMERIC OR A RUNTIME ERROR
+        if (node->infix_expression.operator->token_type != PLUS) {
+            return 1;
+        }
+
+        return is_numeric_expression(node->infix_expression.left);
+    default:
+        return 0;
+    }
+}
+
+static int is_integer_expression(struct AstNode* node) {
+    switch (node->node_type)
+    {
+    case CONST_NUMBER_EXPRESSION:
+        return is_integer_number(node->const_number_expression.value);
+    case PREFIX_EXPRESSION:
+        return is_integer_expression(node->prefix_expression.value);
+    case INFIX_EXPRESSION:
+        switch (node->infix_expression.operator->token_type)
+        {
+        case PLUS:
+        case MINUS:
+        case ASTERISK:
+            return is_integer_expression(node->infix_expression.left) &&
+                is_integer_expression(node->infix_expression.right);
+        case SLASH:
+            return 0;
+        default:
+            // RELATIONAL OPERATORS YIELD -1 OR 0, BUT A FOLD THAT DROPS THEM MUST NOT DROP
+            // A DIVISION BY ZERO IN THEIR OPERANDS EITHER
+            return is_integer_expression(node->infix_expression.left) &&
+                is_integer_expression(node->infix_expression.right);
+        }
+    default:
+        return 0;
+    }
+}
+
+static void make_number_constant(struct AstNode* node, struct Token* token, struct NumberValue value) {
+    node->node_type = CONST_NUMBER_EXPRESSION;
+    node->const_number_expression.token = token;
+    node->const_number_expression.value = value;
+}
+
+static void make_string_constant(struct Optimizer* optimizer, struct AstNode* node, struct Token* token,
+    struct AstNode* left, struct AstNode* right) {
+    long left_length = left->const_string_expression.length;
+    long right_length = right->const_string_expression.length;
+    char* chars = (char*)arena_alloc(optimizer->arena, left_length + right_length + 1);
+    memcpy(chars, left->const_string_expression.value, left_length);
+    memcpy(chars + left_length, right->const_string_expression.value, right_length);
+    chars[left_length + right_length] = 0;
+
+    node->node_type = CONST_STRING_EXPRESSION;
+    node->const_string_expression.token = token;
+    node->const_string_expression.value = chars;
+    node->const_string_expression.length = left_length + right_length;
+}
+
+static void optimize_prefix_expression(struct Optimizer* optimizer, struct AstNode* node) {
+    struct AstNode* value = node->prefix_expression.value;
+    optimize_expression(optimizer, value);
+    if (value == NULL || value->node_type != CONST_NUMBER_EXPRESSION) {
+        return;
+    }
+
+    struct Token* operator = node->prefix_expression.operator;
+    struct NumberValue number = value->const_number_expression.value;
+    if (operator->token_type == MINUS && is_integer_number(number)) {
+        make_number_constant(node, operator, make_integer_number(-number.integer));
+    } else if (operator->token_type == MINUS) {
+        make_number_constant(node, operator, make_real_number(-number.real));
+    } else if (operator->token_type == BANG) {
+        make_number_constant(node, operator, make_integer_number(~(long long)get_number_as_double(number)));
+    }
+}
+
+static int fold_integer_operation(enum TokenType operator, int64_t left, int64_t right, struct NumberValue* result) {
+    // OPERANDS ARE AT MOST 32 BITS, SO THE 64 BIT RESULT IS EXACT AND ONLY WIDENS WHEN IT MUST
+    switch (operator)
+    {
+    case PLUS:
+        *result = make_integer_number(left + right);
+        return 1;
+    case MINUS:
+        *result = make_integer_number(left - right);
+        return 1;
+    case ASTERISK:
+        *result = make_integer_number(left * right);
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static int fold_number_operation(enum TokenType operator, struct NumberValue left, struct NumberValue right,
+    struct NumberValue* result) {
+    if (is_integer_number(left) && is_integer_number(right) &&
+        fold_integer_operation(operator, left.integer, right.integer, result)) {
+        return 1;
+    }
+
+    double left_value = get_number_as_double(left);
+    double right_value = get_number_as_double(right);
+    switch (operator)
+    {
+    case PLUS:
+        *result = make_real_number(left_value + right_value);
+        return 1;
+    case MINUS:
+        *result = make_real_number(left_value - right_value);
+        return 1;
+    case ASTERISK:
+        *result = make_real_number(left_value * right_value);
+        return 1;
+    case SLASH:
+        // LEAVE DIVISION BY ZERO TO THE RUNTIME ERROR
+        if (right_value == 0) {
+            return 0;
+        }
+        *result = make_real_number(left_value / right_value);
+        return 1;
+    case EQUALS:
+        *result = make_integer_number(left_value == right_value ? -1 : 0);
+        return 1;
+    case NOT_EQUALS:
+        *result = make_integer_number(left_value != right_value ? -1 : 0);
+        return 1;
+    case GREATER_THAN:
+        *result = make_integer_number(left_value > right_value ? -1 : 0);
+        return 1;
+    case GREATER_EQUALS:
+        *result = make_integer_number(left_value >= right_value ? -1 : 0);
+        return 1;
+    case LESSER_THAN:
+        *result = make_integer_number(left_value < right_value ? -1 : 0);
+        return 1;
+    case LESSER_EQUALS:
+        *result = make_integer_number(left_value <= right_value ? -1 : 0);
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static int fold_string_comparison(enum TokenType operator, struct AstNode* left, struct AstNode* right, struct NumberValue* result) {
+    long left_length = left->const_string_expression.length;
+    long right_length = right->const_string_expression.length;
+    long length = left_length < right_length ? left_length : right_length;
+    int compared = memcmp(left->const_string_expression.value, right->const_string_expression.value, length);
+    if (compared == 0) {
+        compared = (left_length > right_length) - (left_length < right_length);
+    }
+
+    switch (operator)
+    {
+    case EQUALS:
+        *result = make_integer_number(compared == 0 ? -1 : 0);
+        return 1;
+    case NOT_EQUALS:
+        *result = make_integer_number(compared != 0 ? -1 : 0);
+        return 1;
+    case GREATER_THAN:
+        *result = make_integer_number(compared > 0 ? -1 : 0);
+        return 1;
+    case GREATER_EQUALS:
+        *result = make_integer_number(compared >= 0 ? -1 : 0);
+        return 1;
+    case LESSER_THAN:
+        *result = make_integer_number(compared < 0 ? -1 : 0);
+        return 1;
+    case LESSER_EQUALS:
+        *result = make_integer_number(compared <= 0 ? -1 : 0);
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static int simplify_identity(struct AstNode* node) {
+    struct AstNode* left = node->infix_expression.left;
+    struct AstNode* right = node->infix_expression.right;
+
+    // IDENTITIES MUST KEEP THE TYPE MISMATCH A STRING OPERAND WOULD RAISE
+    switch (node->infix_expression.operator->token_type)
+    {
+    case PLUS:
+        if (is_number_constant(right, 0) && is_numeric_expression(left)) {
+            *node = *left;
+            return 1;
+        }
+        if (is_number_constant(left, 0) && is_numeric_expression(right)) {
+            *node = *right;
+            return 1;
+        }
+        return 0;
+    case MINUS:
+        if (is_number_constant(right, 0) && is_numeric_expression(left)) {
+            *node = *left;
+            return 1;
+        }
+        return 0;
+    case ASTERISK:
+        if (is_number_constant(right, 1) && is_numeric_expression(left)) {
+            *node = *left;
+            return 1;
+        }
+        if (is_number_constant(left, 1) && is_numeric_expression(right)) {
+            *node = *right;
+            return 1;
+        }
+        // ONLY INTEGERS ARE SAFE, A DOUBLE COULD BE INFINITE OR NAN
+        if (is_number_constant(right, 0) && is_integer_expression(left)) {
+            make_number_constant(node, node->infix_expression.operator, make_integer_number(0));
+            return 1;
+        }
+        if (is_number_constant(left, 0) && is_integer_expression(right)) {
+            make_number_constant(node, node->infix_expression.operator, make_integer_number(0));
+            return 1;
+        }
+        return 0;
+    case SLASH:
+        if (is_number_constant(right, 1) && is_numeric_expression(left)) {
+            *node = *left;
+            return 1;
+        }
+        return 0;
+    default:
+        return 0;
+    }
+}
+
+static void optimize_infix_expression(struct Optimizer* optimizer, struct AstNode* node) {
+    struct AstNode* left = node->infix_expression.left;
+    struct AstNode* right = node->infix_expression.right;
+    optimize_expression(optimizer, left);
+    optimize_expression(optimizer, right);
+    // THE PARSER REJECTS MISSING OPERANDS, THIS ONLY KEEPS A BAD TREE FROM CRASHING HERE
+    if (left == NULL || right == NULL) {
+        return;
+    }
+
+    struct Token* operator = node->infix_expression.operator;
+    struct NumberValue result;
+    if (left->node_type == CONST_NUMBER_EXPRESSION && right->node_type == CONST_NUMBER_EXPRESSION) {
+        if (fold_number_operation(operator->token_type, left->const_number_expression.value,
+            right->const_number_expression.value, &result)) {
+            make_number_constant(node, operator, result);
+        }
+        return;
+    }
+
+    if (left->node_type == CONST_STRING_EXPRESSION && right->node_type == CONST_STRING_EXPRESSION) {
+        if (operator->token_type == PLUS) {
+            make_string_constant(optimizer, node, operator, left, right);
+        } else if (fold_string_comparison(operator->token_type, left, right, &result)) {
+            make_number_constant(node, operator, result);
+        }
+        return;
+    }
+
+    // (x + "a") + "b" BECOMES x + "ab"
+    if (operator->token_type == PLUS && right->node_type == CONST_STRING_EXPRESSION &&
+        left->node_type == INFIX_EXPRESSION && left->infix_expression.operator->token_type == PLUS &&
+        left->infix_expression.right->node_type == CONST_STRING_EXPRESSION) {
+        make_string_constant(optimizer, right, operator, left->infix_expression.right, right);
+        node->infix_expression.left = left->infix_expression.left;
+        return;
+    }
+
+    simplify_identity(node);
+}
+
+static void optimize_expression(struct Optimizer* optimizer, struct AstNode* node) {
+    if (node == NULL) {
+        return;
+    }
+
+    switch (node->node_type)
+    {
+    case PREFIX_EXPRESSION:
+        optimize_prefix_expression(optimizer, node);
+        break;
+    case INFIX_EXPRESSION:
+        optimize_infix_expression(optimizer, node);
+        break;
+    default:
+        break;
+    }
+}
+
+static void optimize_print_statement(struct Optimizer* optimizer, struct PrintStatement* statement) {
+    struct ExpessionsList* list = &statement->expressions;
+    for (int i = 0;i < list->size;i++) {
+        optimize_expression(optimizer, &list->expressions[i]);
+    }
+
+    // "a"; "b" PRINTS THE SAME AS "ab"
+    long kept = 0;
+    for (long i = 0;i < list->size;i++) {
+        struct AstNode* previous = kept > 0 ? &list->expressions[kept - 1] : NULL;
+        struct AstNode* current = &list->expressions[i];
+        if (previous != NULL && statement->separators[kept - 1] == SEMICOLON &&
+            previous->node_type == CONST_STRING_EXPRESSION && current->node_type == CONST_STRING_EXPRESSION) {
+            make_string_constant(optimizer, previous, previous->const_string_expression.token, previous, current);
+            statement->separators[kept - 1] = statement->separators[i];
+            continue;
+        }
+
+        list->expressions[kept] = *current;
+        statement->separators[kept] = statement->separators[i];
+        kept++;
+    }
+    list->size = kept;
+}
+
+static void optimize_statement(struct Optimizer* optimizer, struct AstNode* node) {
+    switch (node->node_type)
+    {
+    case ASSIGN_STATEMENT:
+        optimize_expression(optimizer, node->assign_statement.expression);
+        break;
+    case PRINT_STATEMENT:
+        optimize_print_statement(optimizer, &node->print_statement);
+        break;
+    case IF_STATEMENT:
+        optimize_expression(optimizer, node->if_statement.condition_expression);
+        optimize_statements(optimizer, node->if_statement.body);
+        optimize_statements(optimizer, node->if_statement.elses);
+        break;
+    case LOOP_STATEMENT:
+        optimize_expression(optimizer, node->loop_statement.condition_expression);
+        optimize_statements(optimizer, node->loop_statement.body);
+        break;
+    case FOR_STATEMENT:
+        optimize_expression(optimizer, node->for_statement.initial_expression);
+        optimize_expression(optimizer, node->for_statement.end_value_expression);
+        optimize_expression(optimizer, node->for_statement.step_expression);
+        optimize_statements(optimizer, node->for_statement.body);
+        break;
+    default:
+        break;
+    }
+}
+
+static void optimize_statements(struct Optimizer* optimizer, struct StatementsList* list) {
+    if (list == NULL) {
+        return;
+    }
+
+    for (int i = 0;i < list->size;i++) {
+        optimize_statement(optimizer, &list->statements[i]);
+    }
+}
+
+void optimize_program(struct Program* program) {
+    struct Optimizer optimizer;
+    optimizer.arena = program->arena;
+
+    optimize_statements(&optimizer, program->list);
+}
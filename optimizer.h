@@ -0,0 +1,8 @@
+#ifndef OPTIMIZER_H_
+#define OPTIMIZER_H_
+
+#include "parser.h"
+
+void optimize_program(struct Program* program);
+
+#endif
@@ -1,122 +1,250 @@
 #include "lexer.h"
 #include "parser.h"
+#include "arena.h"
+#include "interner.h"
+#include "thread_pool.h"
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
 
-struct StatementsList* new_statements_list(void);
-void add_statement_to_list(struct StatementsList* list, struct AstNode statement);
-
-struct ExpessionsList new_expressions_list(void);
-void add_expression_to_list(struct ExpessionsList* list, struct AstNode expression);
+// SEGMENTS SMALLER THAN THIS PARSE FASTER THAN THEY ARE HANDED TO A WORKER
+#define MIN_PARSE_SEGMENT_TOKENS 4096
+// MORE SEGMENTS THAN WORKERS SO A WORKER WITH SHORT STATEMENTS CAN STEAL FROM A SLOW ONE
+#define PARSE_SEGMENTS_PER_WORKER 4
 
 typedef struct TokenPeeker {
     long current_index;
     struct TokenList* tokens;
+    struct Lexer* lexer;
+    struct TokenQueue* queue;
+    const char* source;
+    struct Arena* arena;
 } TokenPeeker;
 
-struct TokenPeeker new_token_peeker(struct TokenList* tokens);
+// WHAT A SUSPENDED EXPRESSION DOES WITH THE VALUE OF THE ONE PARSED AFTER IT
+enum ExpressionFrameKind {
+    PAREN_FRAME,
+    PREFIX_FRAME,
+    INFIX_FRAME,
+};
+
+struct ExpressionFrame {
+    enum ExpressionFrameKind kind;
+    // THE PRECEDENCE OF THE SUSPENDED EXPRESSION, RESTORED WHEN IT RESUMES
+    int precedence;
+    // THE PREFIX OR INFIX NODE WAITING FOR ITS OPERAND
+    struct AstNode* node;
+    // THE OPERATOR OR '(' THE OPERAND FOLLOWS
+    struct Token* token;
+};
+
+struct StatementsList* new_statements_list(struct TokenPeeker* token_peeker);
+void add_statement_to_list(struct TokenPeeker* token_peeker, struct StatementsList* list, struct AstNode statement);
+
+struct ExpessionsList new_expressions_list(void);
+void add_expression_to_list(struct TokenPeeker* token_peeker, struct ExpessionsList* list, struct AstNode expression);
+
+struct AstNode* new_ast_node(struct TokenPeeker* token_peeker, enum AstNodeType node_type);
+
+struct TokenPeeker new_token_peeker(struct TokenList* tokens, struct Arena* arena);
+struct TokenPeeker new_stream_token_peeker(struct Lexer* lexer, struct Arena* arena);
+struct TokenPeeker new_queue_token_peeker(struct TokenQueue* queue, const char* source, struct Arena* arena);
 struct Token* next(TokenPeeker* token_peeker);
 struct Token* peek(TokenPeeker* token_peeker);
+struct Token* keep_token(TokenPeeker* token_peeker, struct Token* token);
+struct Program parse_with_peeker(struct TokenPeeker* token_peeker);
+struct Program build_program(struct Arena* arena, const char* source, struct StatementsList* list, size_t arena_start);
+
+struct ParallelParse {
+    struct TokenList* tokens;
+    struct ParseSegment* segments;
+    struct Arena** worker_arenas;
+};
+
+void parse_segment_task(void* context, int worker, int task);
 
 struct StatementsList* parse_statements(struct TokenPeeker* token_peeker);
 struct AstNode* parse_print_statement(struct TokenPeeker* token_peeker);
 struct AstNode* parse_assign_statement(struct TokenPeeker* token_peeker);
+struct AstNode* parse_def_type_statement(struct TokenPeeker* token_peeker);
+int parse_def_type_letter(struct TokenPeeker* token_peeker);
 
-struct AstNode* parse_infix_expression(struct TokenPeeker* token_peeker, struct AstNode* left);
 struct AstNode* parse_expression(struct TokenPeeker* token_peeker, int precedence);
-struct AstNode* parse_prefix_expression(struct TokenPeeker* token_peeker);
+struct AstNode* expect_expression(struct TokenPeeker* token_peeker, struct AstNode* expression, const struct Token* after);
+struct ExpressionFrame* push_expression_frame(struct ExpressionFrame* frames, struct ExpressionFrame* local_frames,
+    int* frame_count, int* frame_capacity, struct ExpressionFrame frame);
 struct AstNode* parse_node_from_token(struct TokenPeeker* token_peeker);
 int get_operator_precedence(struct Token* operator);
-void print_node(struct AstNode* node);
+void print_node(const char* source, struct AstNode* node);
+void print_block_statements(const char* source, struct StatementsList* list);
 void skip_newlines(struct TokenPeeker* token_peeker);
 
 
+#define RELATIONAL_PRECEDENCE 0
+#define ADDITIVE_PRECEDENCE 1
+#define MULTIPLICATIVE_PRECEDENCE 2
+// PREFIX OPERATORS BIND TIGHTER THAN ANY INFIX OPERATOR
+#define PREFIX_PRECEDENCE 2
+// DEEPER NESTING MOVES THE EXPRESSION PARSER'S FRAMES TO THE HEAP
+#define EXPRESSION_FRAMES_ON_STACK 64
+
+static const signed char operator_precedences[CLOSE_ROUND_BRACKET + 1] = {
+    [EQUALS] = RELATIONAL_PRECEDENCE + 1, [NOT_EQUALS] = RELATIONAL_PRECEDENCE + 1,
+    [GREATER_THAN] = RELATIONAL_PRECEDENCE + 1, [GREATER_EQUALS] = RELATIONAL_PRECEDENCE + 1,
+    [LESSER_THAN] = RELATIONAL_PRECEDENCE + 1, [LESSER_EQUALS] = RELATIONAL_PRECEDENCE + 1,
+    [PLUS] = ADDITIVE_PRECEDENCE + 1, [MINUS] = ADDITIVE_PRECEDENCE + 1,
+    [ASTERISK] = MULTIPLICATIVE_PRECEDENCE + 1, [SLASH] = MULTIPLICATIVE_PRECEDENCE + 1,
+};
+
 // END DECLARATIONS
 
-void print_node(struct AstNode* node) {
+void print_node(const char* source, struct AstNode* node) {
     if (node == NULL) {
         printf("UNDEFINED ");
         return;
     }
 
     if (node->node_type == CONST_NUMBER_EXPRESSION) {
-        printf("%s ", node->const_number_expression.token->value);
+        printf("%.15g", get_number_as_double(node->const_number_expression.value));
+        printf(" ");
     } else if (node->node_type == CONST_STRING_EXPRESSION) {
-        printf("%s ", node->const_string_expression.token->value);
+        printf("%.*s", (int)node->const_string_expression.length, node->const_string_expression.value);
+        printf(" ");
     } else if (node->node_type == PREFIX_EXPRESSION) {
-        printf("%s(", node->prefix_expression.operator->value);
-        print_node(node->prefix_expression.value);
+        print_token_value(source, node->prefix_expression.operator);
+        printf("(");
+        print_node(source, node->prefix_expression.value);
         printf(") ");
     } else if (node->node_type == INFIX_EXPRESSION) {
         printf("(");
-        print_node(node->infix_expression.left);
-        printf("%s", node->infix_expression.operator->value);
-        print_node(node->infix_expression.right);
+        print_node(source, node->infix_expression.left);
+        print_token_value(source, node->infix_expression.operator);
+        print_node(source, node->infix_expression.right);
         printf(")");
     } else if (node->node_type == IDENTIFIER_EXPRESSION) {
-        printf("IDENT(%s) ", node->identifier_expression.token->value);
+        printf("IDENT(%s) ", get_identifier_name(node->identifier_expression.identifier_id));
     } else if (node->node_type == ASSIGN_STATEMENT) {
-        print_node(node->assign_statement.identifier);
+        print_node(source, node->assign_statement.identifier);
         printf("= ");
-        print_node(node->assign_statement.expression);
+        print_node(source, node->assign_statement.expression);
     } else if (node->node_type == PRINT_STATEMENT) {
-        printf("%s ( ", node->print_statement.token->value);
+        print_token_value(source, node->print_statement.token);
+        printf(" ( ");
         for (int i = 0;i < node->print_statement.expressions.size;i++) {
-            print_node(&node->print_statement.expressions.expressions[i]);
+            print_node(source, &node->print_statement.expressions.expressions[i]);
             printf(", ");
         }
 
         printf(" ) ");
     } else if (node->node_type == IF_STATEMENT) {
-        printf("if ");
-        print_node(node->if_statement.condition_expression);
-        printf(" then\n");
+        if (node->if_statement.condition_expression == NULL) {
+            printf("else\n");
+        } else {
+            printf("if ");
+            print_node(source, node->if_statement.condition_expression);
+            printf(" then\n");
+        }
         for(int i = 0; i < node->if_statement.body->size;i++) {
             printf("    ");
-            print_node(&node->if_statement.body->statements[i]);
+            print_node(source, &node->if_statement.body->statements[i]);
             printf("\n");
         }
 
         if (node->if_statement.elses != NULL) {
             for(int i = 0; i < node->if_statement.elses->size;i++) {
-                print_node(&node->if_statement.elses->statements[i]);
+                print_node(source, &node->if_statement.elses->statements[i]);
             }
         }
         printf("end if\n");
     } else if (node->node_type == LOOP_STATEMENT) {
-        printf("%s %s ", node->loop_statement.token->value, node->loop_statement.loop_type_token->value);
-        print_node(node->loop_statement.condition_expression);
+        print_token_value(source, node->loop_statement.token);
+        printf(" ");
+        print_token_value(source, node->loop_statement.loop_type_token);
+        printf(" ");
+        print_node(source, node->loop_statement.condition_expression);
         printf("\n");
 
         if (node->loop_statement.body != NULL) {
             for(int i = 0; i < node->loop_statement.body->size;i++) {
-                print_node(&node->loop_statement.body->statements[i]);
+                print_node(source, &node->loop_statement.body->statements[i]);
             }
         }
 
         printf("loop \n");
     } else if (node->node_type == FOR_STATEMENT) {
-        printf("for %s = ", node->for_statement.control_identifier_expression->identifier_expression.token->value);    
-        print_node(node->for_statement.initial_expression);
+        printf("for %s = ", get_identifier_name(node->for_statement.control_identifier_expression->identifier_expression.identifier_id));
+        print_node(source, node->for_statement.initial_expression);
         printf("TO ");
-        print_node(node->for_statement.end_value_expression);
+        print_node(source, node->for_statement.end_value_expression);
         printf("STEP ");
-        print_node(node->for_statement.step_expression);
+        print_node(source, node->for_statement.step_expression);
         printf("\n");
 
         if (node->for_statement.body != NULL) {
             for(int i = 0; i < node->for_statement.body->size;i++) {
-                print_node(&node->for_statement.body->statements[i]);
+                print_node(source, &node->for_statement.body->statements[i]);
             }
         }
 
         printf("end for \n");
+    } else if (node->node_type == DEF_TYPE_STATEMENT) {
+        print_token_value(source, node->def_type_statement.token);
+        printf(" ");
+        for (int i = 0;i < 26;i++) {
+            if (node->def_type_statement.letters & (1u << i)) {
+                printf("%c", 'a' + i);
+            }
+        }
+        printf("\n");
+    }
+}
+
+// NESTED BLOCKS PRINT BEFORE THE BLOCK THAT CONTAINS THEM, IN THE ORDER THE PARSER FINISHES THEM
+void print_block_statements(const char* source, struct StatementsList* list) {
+    if (list == NULL) {
+        return;
+    }
+
+    for (long i = 0;i < list->size;i++) {
+        struct AstNode* node = &list->statements[i];
+        switch (node->node_type)
+        {
+        case IF_STATEMENT:
+            print_block_statements(source, node->if_statement.body);
+            if (node->if_statement.elses != NULL) {
+                for (long j = 0;j < node->if_statement.elses->size;j++) {
+                    print_block_statements(source, node->if_statement.elses->statements[j].if_statement.body);
+                }
+            }
+            break;
+        case LOOP_STATEMENT:
+            print_block_statements(source, node->loop_statement.body);
+            break;
+        case FOR_STATEMENT:
+            print_block_statements(source, node->for_statement.body);
+            break;
+        default:
+            continue;
+        }
+
+        print_node(source, node);
     }
 }
 
-struct StatementsList* new_statements_list(void) {
-    struct StatementsList* list = (struct StatementsList*)malloc(sizeof(struct StatementsList));
+void print_program_blocks(struct Program* program) {
+    print_block_statements(program->source, program->list);
+}
+
+struct AstNode* new_ast_node(struct TokenPeeker* token_peeker, enum AstNodeType node_type) {
+    struct AstNode* node = (struct AstNode*)arena_alloc(token_peeker->arena, sizeof(struct AstNode));
+    memset(node, 0, sizeof(struct AstNode));
+    node->node_type = node_type;
+
+    return node;
+}
+
+struct StatementsList* new_statements_list(struct TokenPeeker* token_peeker) {
+    struct StatementsList* list = (struct StatementsList*)arena_alloc(token_peeker->arena, sizeof(struct StatementsList));
     list->capacity = 0;
     list->size = 0;
     list->statements = NULL;
@@ -124,16 +252,21 @@ struct StatementsList* new_statements_list(void) {
     return list;
 }
 
-void add_statement_to_list(struct StatementsList* list, struct AstNode statement) {
+void add_statement_to_list(struct TokenPeeker* token_peeker, struct StatementsList* list, struct AstNode statement) {
     int alloc_size = 20;
     if (list->capacity == 0) {
-        list->statements = (struct AstNode*)malloc(alloc_size * sizeof(struct AstNode));
+        list->statements = (struct AstNode*)arena_alloc(token_peeker->arena, alloc_size * sizeof(struct AstNode));
         list->capacity = alloc_size;
     }
 
     if (list->size >= list->capacity) {
-        list->statements = (struct AstNode*)realloc(list->statements, (alloc_size + list->capacity) * sizeof(struct AstNode));
-        list->capacity = list->capacity + alloc_size;
+        list->statements = (struct AstNode*)arena_realloc(
+            token_peeker->arena,
+            list->statements,
+            list->capacity * sizeof(struct AstNode),
+            2 * list->capacity * sizeof(struct AstNode)
+        );
+        list->capacity = 2 * list->capacity;
     }
 
     list->statements[list->size] = statement;
@@ -149,31 +282,72 @@ struct ExpessionsList new_expressions_list(void) {
     return list;
 }
 
-void add_expression_to_list(struct ExpessionsList* list, struct AstNode expression) {
-    int alloc_size = 20;
+void add_expression_to_list(struct TokenPeeker* token_peeker, struct ExpessionsList* list, struct AstNode expression) {
+    int alloc_size = 4;
     if (list->capacity == 0) {
-        list->expressions = (struct AstNode*)malloc(alloc_size * sizeof(struct AstNode));
+        list->expressions = (struct AstNode*)arena_alloc(token_peeker->arena, alloc_size * sizeof(struct AstNode));
         list->capacity = alloc_size;
     }
 
     if (list->size >= list->capacity) {
-        list->expressions = (struct AstNode*)realloc(list->expressions, (alloc_size + list->capacity) * sizeof(struct AstNode));
-        list->capacity = list->capacity + alloc_size;
+        list->expressions = (struct AstNode*)arena_realloc(
+            token_peeker->arena,
+            list->expressions,
+            list->capacity * sizeof(struct AstNode),
+            2 * list->capacity * sizeof(struct AstNode)
+        );
+        list->capacity = 2 * list->capacity;
     }
 
     list->expressions[list->size] = expression;
     list->size++;
 }
 
-struct TokenPeeker new_token_peeker(struct TokenList* tokens) {
+struct TokenPeeker new_token_peeker(struct TokenList* tokens, struct Arena* arena) {
     struct TokenPeeker token_peeker;
     token_peeker.current_index = 0;
     token_peeker.tokens = tokens;
+    token_peeker.lexer = NULL;
+    token_peeker.queue = NULL;
+    token_peeker.source = tokens->source;
+    token_peeker.arena = arena;
+
+    return token_peeker;
+}
+
+struct TokenPeeker new_stream_token_peeker(struct Lexer* lexer, struct Arena* arena) {
+    struct TokenPeeker token_peeker;
+    token_peeker.current_index = 0;
+    token_peeker.tokens = NULL;
+    token_peeker.lexer = lexer;
+    token_peeker.queue = NULL;
+    token_peeker.source = lexer->source;
+    token_peeker.arena = arena;
+
+    return token_peeker;
+}
+
+struct TokenPeeker new_queue_token_peeker(struct TokenQueue* queue, const char* source, struct Arena* arena) {
+    struct TokenPeeker token_peeker;
+    token_peeker.current_index = 0;
+    token_peeker.tokens = NULL;
+    token_peeker.lexer = NULL;
+    token_peeker.queue = queue;
+    token_peeker.source = source;
+    token_peeker.arena = arena;
 
     return token_peeker;
 }
 
 struct Token* peek(TokenPeeker* token_peeker) {
+    if (token_peeker->lexer != NULL) {
+        return lexer_peek(token_peeker->lexer, 0);
+    }
+
+    if (token_peeker->queue != NULL) {
+        return token_queue_peek(token_peeker->queue);
+    }
+
     if (token_peeker->current_index >= token_peeker->tokens->length) {
         return NULL;
     }
@@ -182,6 +356,14 @@ struct Token* peek(TokenPeeker* token_peeker) {
 }
 
 struct Token* next(TokenPeeker* token_peeker) {
+    if (token_peeker->lexer != NULL) {
+        return lexer_next(token_peeker->lexer);
+    }
+
+    if (token_peeker->queue != NULL) {
+        return token_queue_next(token_peeker->queue);
+    }
+
     if (token_peeker->current_index < token_peeker->tokens->length) {
         token_peeker->current_index++;
     }
@@ -189,104 +371,176 @@ struct Token* next(TokenPeeker* token_peeker) {
     return peek(token_peeker);
 }
 
+// TOKENS RETURNED BY peek() ONLY LIVE AS LONG AS THE LEXER WINDOW,
+// EVERY TOKEN THE AST HOLDS ON TO IS COPIED INTO THE PROGRAM ARENA
+struct Token* keep_token(TokenPeeker* token_peeker, struct Token* token) {
+    if (token == NULL) {
+        return NULL;
+    }
+
+    struct Token* kept_token = (struct Token*)arena_alloc(token_peeker->arena, sizeof(struct Token));
+    *kept_token = *token;
+
+    return kept_token;
+}
+
+// PRECEDENCE CLIMBING WITHOUT RECURSION: WHERE THE RECURSIVE PARSER WOULD CALL ITSELF FOR AN
+// OPERAND IT PUSHES A FRAME AND STARTS OVER, AND A FINISHED OPERAND POPS THE FRAME THAT WAITS
+// FOR IT. THE TREES ARE THE SAME, NESTING ONLY GROWS THE FRAME ARRAY
 struct AstNode* parse_expression(struct TokenPeeker* token_peeker, int precedence) {
-    struct Token* token = peek(token_peeker);
+    struct ExpressionFrame local_frames[EXPRESSION_FRAMES_ON_STACK];
+    struct ExpressionFrame* frames = local_frames;
+    int frame_count = 0;
+    int frame_capacity = EXPRESSION_FRAMES_ON_STACK;
+
+    struct AstNode* value = NULL;
+    int needs_operand = 1;
+    while (1) {
+        if (needs_operand) {
+            needs_operand = 0;
+
+            struct Token* token = peek(token_peeker);
+            struct ExpressionFrame frame = {PAREN_FRAME, precedence, NULL, NULL};
+            if (token == NULL) {
+                value = NULL;
+            } else if (token->token_type == OPEN_ROUND_BRACKET) {
+                frame.token = keep_token(token_peeker, token);
+                next(token_peeker);
+                precedence = -1;
+                needs_operand = 1;
+            } else {
+                value = parse_node_from_token(token_peeker);
+                if (value == NULL && (token->token_type == MINUS || token->token_type == BANG)) {
+                    struct Token* operator = keep_token(token_peeker, token);
+                    frame.kind = PREFIX_FRAME;
+                    frame.node = new_ast_node(token_peeker, PREFIX_EXPRESSION);
+                    frame.node->prefix_expression.operator = operator;
+                    frame.token = operator;
+                    next(token_peeker);
+                    precedence = PREFIX_PRECEDENCE;
+                    needs_operand = 1;
+                }
+            }
 
-    struct AstNode* leftExpr = NULL;
-    if (token->token_type == OPEN_ROUND_BRACKET) {
-        next(token_peeker);
-        leftExpr = parse_expression(token_peeker, -1);
-    } else {
-        leftExpr = parse_node_from_token(token_peeker);
-        if (leftExpr == NULL) {
-            if (token->token_type == MINUS || token->token_type == BANG) {
-                leftExpr = parse_prefix_expression(token_peeker);
+            if (needs_operand) {
+                frames = push_expression_frame(frames, local_frames, &frame_count, &frame_capacity, frame);
+                continue;
             }
         }
-    }
 
-    if (leftExpr == NULL) {
-        return NULL;
-    }
+        // A MISSING OPERAND ENDS ITS EXPRESSION, WHICH IS AN ERROR UNLESS NOTHING WAS STARTED
+        struct Token* token = peek(token_peeker);
+        if (value != NULL && token != NULL && token->token_type != NEW_LINE && precedence < get_operator_precedence(token)) {
+            struct ExpressionFrame frame = {INFIX_FRAME, precedence, NULL, NULL};
+            frame.node = new_ast_node(token_peeker, INFIX_EXPRESSION);
+            frame.node->infix_expression.left = value;
+            frame.node->infix_expression.operator = keep_token(token_peeker, token);
+            frame.token = frame.node->infix_expression.operator;
+            precedence = get_operator_precedence(token);
+            next(token_peeker);
 
-    if (peek(token_peeker) == NULL || peek(token_peeker)->token_type == CLOSE_ROUND_BRACKET) {
-        next(token_peeker);
-        return leftExpr;
+            frames = push_expression_frame(frames, local_frames, &frame_count, &frame_capacity, frame);
+            needs_operand = 1;
+            continue;
+        }
+
+        if (frame_count == 0) {
+            break;
+        }
+
+        struct ExpressionFrame frame = frames[--frame_count];
+        precedence = frame.precedence;
+        expect_expression(token_peeker, value, frame.token);
+        switch (frame.kind) {
+            case PAREN_FRAME:
+                token = peek(token_peeker);
+                if (token == NULL || token->token_type != CLOSE_ROUND_BRACKET) {
+                    exit(301);
+                }
+                next(token_peeker);
+                break;
+            case PREFIX_FRAME:
+                frame.node->prefix_expression.value = value;
+                value = frame.node;
+                break;
+            case INFIX_FRAME:
+                frame.node->infix_expression.right = value;
+                value = frame.node;
+                break;
+        }
     }
 
-    while (peek(token_peeker) != NULL && peek(token_peeker)->token_type != NEW_LINE && precedence < get_operator_precedence(peek(token_peeker))) {
-        leftExpr = parse_infix_expression(token_peeker, leftExpr);
+    if (frames != local_frames) {
+        free(frames);
     }
 
-    return leftExpr;
+    return value;
 }
 
-struct AstNode* parse_prefix_expression(struct TokenPeeker* token_peeker) {
-    struct Token* operator = peek(token_peeker);
-    struct AstNode* node = (struct AstNode*)malloc(sizeof(struct AstNode));
-
-    node->node_type = PREFIX_EXPRESSION;
-    node->prefix_expression.operator = operator;
-    node->prefix_expression.value = parse_expression(token_peeker, -1);
+// OPERANDS AND THE EXPRESSIONS OF ASSIGNMENTS, LOOPS AND CONDITIONS CAN'T BE LEFT OUT, SO THE
+// OPTIMIZER AND THE COMPILER NEVER SEE A NULL CHILD
+struct AstNode* expect_expression(struct TokenPeeker* token_peeker, struct AstNode* expression, const struct Token* after) {
+    if (expression == NULL) {
+        struct SourcePosition position = get_source_position(token_peeker->source, get_token_start(after));
+        printf("Expected an expression after %.*s at %d:%d \n", (int)after->length,
+            get_token_text(token_peeker->source, after), position.row, position.col);
+        exit(121);
+    }
 
-    return node;
+    return expression;
 }
 
-int get_operator_precedence(struct Token* operator) {
-    switch (operator->token_type)
-    {
-    case PLUS:
-        return 0;
-    case MINUS:
-        return 0;
-    case SLASH:
-        return 1;
-    case ASTERISK:
-        return 1;
-    default:
-        return -1;
+struct ExpressionFrame* push_expression_frame(struct ExpressionFrame* frames, struct ExpressionFrame* local_frames,
+    int* frame_count, int* frame_capacity, struct ExpressionFrame frame) {
+    if (*frame_count == *frame_capacity) {
+        struct ExpressionFrame* grown = (struct ExpressionFrame*)malloc(2 * *frame_capacity * sizeof(struct ExpressionFrame));
+        if (grown == NULL) {
+            printf("Out of memory parsing an expression \n");
+            exit(1);
+        }
+        memcpy(grown, frames, *frame_count * sizeof(struct ExpressionFrame));
+        if (frames != local_frames) {
+            free(frames);
+        }
+        frames = grown;
+        *frame_capacity *= 2;
     }
-}
-
-struct AstNode* parse_infix_expression(struct TokenPeeker* token_peeker, struct AstNode* left) {
-    struct AstNode* node = (struct AstNode*)malloc(sizeof(struct AstNode));
-    node->node_type = INFIX_EXPRESSION;
-    node->infix_expression.left = left;
-
-    struct Token* operator = peek(token_peeker);
-    node->infix_expression.operator = operator;
-
-    next(token_peeker);
 
-    node->infix_expression.right = parse_expression(token_peeker, get_operator_precedence(operator));
+    frames[(*frame_count)++] = frame;
+    return frames;
+}
 
-    return node;
+int get_operator_precedence(struct Token* operator) {
+    // ENTRIES HOLD PRECEDENCE + 1 SO EVERY TOKEN LEFT OUT IS -1, NOT AN OPERATOR
+    return operator_precedences[operator->token_type] - 1;
 }
 
 struct AstNode* parse_node_from_token(struct TokenPeeker* token_peeker) {
     struct Token* token = peek(token_peeker);
 
     if (token->token_type == QUOTED_STRING) {
+        struct AstNode* node = new_ast_node(token_peeker, CONST_STRING_EXPRESSION);
+        node->const_string_expression.token = keep_token(token_peeker, token);
+        node->const_string_expression.value = get_token_text(token_peeker->source, token);
+        node->const_string_expression.length = token->length;
         next(token_peeker);
-        struct AstNode* node = (struct AstNode*)malloc(sizeof(struct AstNode));
-        node->node_type = CONST_STRING_EXPRESSION;
-        node->const_string_expression.token = token;
         return node;
     }
 
     if (token->token_type == NUMBER) {
+        struct AstNode* node = new_ast_node(token_peeker, CONST_NUMBER_EXPRESSION);
+        node->const_number_expression.token = keep_token(token_peeker, token);
+        node->const_number_expression.value = token->number;
         next(token_peeker);
-        struct AstNode* node = (struct AstNode*)malloc(sizeof(struct AstNode));
-        node->node_type = CONST_NUMBER_EXPRESSION;
-        node->const_number_expression.token = token;
         return node;
     }
 
     if (token->token_type == UNQUOTED_STRING) {
+        struct AstNode* node = new_ast_node(token_peeker, IDENTIFIER_EXPRESSION);
+        node->identifier_expression.token = keep_token(token_peeker, token);
+        node->identifier_expression.identifier_id = token->identifier_id;
+        node->identifier_expression.slot = -1;
         next(token_peeker);
-        struct AstNode* node = (struct AstNode*)malloc(sizeof(struct AstNode));
-        node->node_type = IDENTIFIER_EXPRESSION;
-        node->identifier_expression.token = token;
         return node;
     }
 
@@ -294,49 +548,65 @@ struct AstNode* parse_node_from_token(struct TokenPeeker* token_peeker) {
 }
 
 struct AstNode* parse_string_const(struct TokenPeeker* token_peeker) {
-    struct Token* token = peek(token_peeker);
-    struct AstNode* node = (struct AstNode*)malloc(sizeof(struct AstNode));
-
-    node->node_type = CONST_STRING_EXPRESSION;
+    struct Token* token = keep_token(token_peeker, peek(token_peeker));
+    struct AstNode* node = new_ast_node(token_peeker, CONST_STRING_EXPRESSION);
     node->const_string_expression.token = token;
+    node->const_string_expression.value = get_token_text(token_peeker->source, token);
+    node->const_string_expression.length = token->length;
 
     return node;
 }
 
 struct AstNode* parse_assign_statement(struct TokenPeeker* token_peeker) {
-    struct AstNode* statement = (struct AstNode*)malloc(sizeof(struct AstNode));
-    statement->node_type = ASSIGN_STATEMENT;
+    struct AstNode* statement = new_ast_node(token_peeker, ASSIGN_STATEMENT);
     statement->assign_statement.identifier = parse_node_from_token(token_peeker);
     
     struct Token* token = peek(token_peeker);
-    if (token == NULL || token->token_type != ASSIGN_OPERATOR) {
+    if (token == NULL || token->token_type != EQUALS) {
         exit(1);
     }
 
+    struct Token* equals = keep_token(token_peeker, token);
     next(token_peeker);
     struct AstNode* arg = parse_expression(token_peeker, -1);
-    statement->assign_statement.expression = arg;
+    statement->assign_statement.expression = expect_expression(token_peeker, arg, equals);
 
     return statement;
 }
 
 struct AstNode* parse_print_statement(struct TokenPeeker* token_peeker) {
-    struct AstNode* statement = (struct AstNode*)malloc(sizeof(struct AstNode));
-    statement->node_type = PRINT_STATEMENT;
+    struct AstNode* statement = new_ast_node(token_peeker, PRINT_STATEMENT);
     statement->print_statement.expressions = new_expressions_list();
-    statement->print_statement.token = peek(token_peeker);
+    statement->print_statement.token = keep_token(token_peeker, peek(token_peeker));
 
     next(token_peeker);
 
+    // separators[i] IS THE TOKEN TYPE THAT ENDED expressions[i]: SEMICOLON, COMMA OR NEW_LINE
+    long separators_capacity = 0;
+    statement->print_statement.separators = NULL;
+
     struct AstNode* arg = parse_expression(token_peeker, -1);
     while (arg != NULL) {
-        add_expression_to_list(&statement->print_statement.expressions, *arg);
+        struct ExpessionsList* expressions = &statement->print_statement.expressions;
+        add_expression_to_list(token_peeker, expressions, *arg);
+
+        if (expressions->capacity > separators_capacity) {
+            statement->print_statement.separators = (enum TokenType*)arena_realloc(
+                token_peeker->arena,
+                statement->print_statement.separators,
+                separators_capacity * sizeof(enum TokenType),
+                expressions->capacity * sizeof(enum TokenType)
+            );
+            separators_capacity = expressions->capacity;
+        }
 
         struct Token* token = peek(token_peeker);
         if (token == NULL || token->token_type == NEW_LINE) {
+            statement->print_statement.separators[expressions->size - 1] = NEW_LINE;
             skip_newlines(token_peeker);
             break;
         } else if (token->token_type == SEMICOLON || token->token_type == COMMA) {
+            statement->print_statement.separators[expressions->size - 1] = token->token_type;
             next(token_peeker);
             arg = parse_expression(token_peeker, -1);
             continue;
@@ -349,28 +619,24 @@ struct AstNode* parse_print_statement(struct TokenPeeker* token_peeker) {
 }
 
 struct AstNode* parse_loop_statement(struct TokenPeeker* token_peeker) {
-    struct AstNode* node = (struct AstNode*)malloc(sizeof(struct AstNode));
-    node->node_type = LOOP_STATEMENT;
+    struct AstNode* node = new_ast_node(token_peeker, LOOP_STATEMENT);
 
     struct Token* token = peek(token_peeker);
-    node->loop_statement.token = token;
+    node->loop_statement.token = keep_token(token_peeker, token);
 
     token = next(token_peeker);
 
     if (
         token == NULL ||
-        token->token_type != UNQUOTED_STRING ||
-        (
-            strcmp(token->value, "until") != 0 && 
-            strcmp(token->value, "while") != 0 
-        )
+        (token->token_type != UNTIL_KEYWORD && token->token_type != WHILE_KEYWORD)
     ) {
         exit(150);
     } 
     
-    node->loop_statement.loop_type_token = token;
+    node->loop_statement.loop_type_token = keep_token(token_peeker, token);
     token = next(token_peeker);
-    node->loop_statement.condition_expression = parse_expression(token_peeker, -1);
+    node->loop_statement.condition_expression = expect_expression(token_peeker,
+        parse_expression(token_peeker, -1), node->loop_statement.loop_type_token);
     skip_newlines(token_peeker);
 
     node->loop_statement.body = parse_statements(token_peeker);
@@ -379,8 +645,7 @@ struct AstNode* parse_loop_statement(struct TokenPeeker* token_peeker) {
 
     if (
         token == NULL ||
-        token->token_type != UNQUOTED_STRING ||
-        strcmp(token->value, "loop") != 0
+        token->token_type != LOOP_KEYWORD
     ) {
         exit(150);
     } 
@@ -390,39 +655,40 @@ struct AstNode* parse_loop_statement(struct TokenPeeker* token_peeker) {
 }
 
 struct AstNode* parse_for_statement(struct TokenPeeker* token_peeker) {
-    struct AstNode* node = (struct AstNode*)malloc(sizeof(struct AstNode));
-    node->node_type = FOR_STATEMENT;
-    node->for_statement.token = peek(token_peeker);
+    struct AstNode* node = new_ast_node(token_peeker, FOR_STATEMENT);
+    node->for_statement.token = keep_token(token_peeker, peek(token_peeker));
     
     next(token_peeker);
     node->for_statement.control_identifier_expression = parse_node_from_token(token_peeker);
     
     struct Token* token = peek(token_peeker);
-    if (token == NULL || token->token_type != ASSIGN_OPERATOR) {
+    if (token == NULL || token->token_type != EQUALS) {
         exit(201);
     }
 
+    struct Token* equals = keep_token(token_peeker, token);
     next(token_peeker);
-    node->for_statement.initial_expression = parse_expression(token_peeker, -1);
+    node->for_statement.initial_expression = expect_expression(token_peeker, parse_expression(token_peeker, -1), equals);
 
     token = peek(token_peeker);
     if (
         token == NULL || 
-        token->token_type != UNQUOTED_STRING || 
-        strcmp(token->value, "to") != 0
+        token->token_type != TO_KEYWORD
     ) {
         exit(202);
     }
     
+    struct Token* to = keep_token(token_peeker, token);
     next(token_peeker);
-    node->for_statement.end_value_expression = parse_expression(token_peeker, -1); 
+    node->for_statement.end_value_expression = expect_expression(token_peeker, parse_expression(token_peeker, -1), to);
 
     token = peek(token_peeker);
     if (token == NULL) {
         exit(203);
-    } else if (token->token_type == UNQUOTED_STRING && strcmp(token->value, "step") == 0) {
+    } else if (token->token_type == STEP_KEYWORD) {
+        struct Token* step = keep_token(token_peeker, token);
         next(token_peeker);
-        node->for_statement.step_expression = parse_expression(token_peeker, -1);
+        node->for_statement.step_expression = expect_expression(token_peeker, parse_expression(token_peeker, -1), step);
     } else {
         node->for_statement.step_expression = NULL; 
     }
@@ -434,7 +700,7 @@ struct AstNode* parse_for_statement(struct TokenPeeker* token_peeker) {
         exit(204);
     }
 
-    if (token->token_type != UNQUOTED_STRING || strcmp(token->value, "next") != 0) {
+    if (token->token_type != NEXT_KEYWORD) {
         exit(206);
     }
 
@@ -446,7 +712,7 @@ struct AstNode* parse_for_statement(struct TokenPeeker* token_peeker) {
 
     if (
         token->token_type != UNQUOTED_STRING || 
-        strcmp(token->value, node->for_statement.control_identifier_expression->identifier_expression.token->value) != 0
+        token->identifier_id != node->for_statement.control_identifier_expression->identifier_expression.identifier_id
     ) {
         exit(208);
     }
@@ -455,16 +721,62 @@ struct AstNode* parse_for_statement(struct TokenPeeker* token_peeker) {
     return node;
 }
 
+int parse_def_type_letter(struct TokenPeeker* token_peeker) {
+    struct Token* token = peek(token_peeker);
+    if (token == NULL || token->token_type != UNQUOTED_STRING || token->length != 1) {
+        printf("Expected a letter in DEF statement \n");
+        exit(230);
+    }
+
+    next(token_peeker);
+    return (get_token_text(token_peeker->source, token)[0] | 0x20) - 'a';
+}
+
+// DEFINT a-c, x MARKS THE LETTERS a, b, c AND x
+struct AstNode* parse_def_type_statement(struct TokenPeeker* token_peeker) {
+    struct AstNode* node = new_ast_node(token_peeker, DEF_TYPE_STATEMENT);
+    node->def_type_statement.token = keep_token(token_peeker, peek(token_peeker));
+    node->def_type_statement.letters = 0;
+
+    next(token_peeker);
+    while (1) {
+        int first = parse_def_type_letter(token_peeker);
+        int last = first;
+
+        struct Token* token = peek(token_peeker);
+        if (token != NULL && token->token_type == MINUS) {
+            next(token_peeker);
+            last = parse_def_type_letter(token_peeker);
+            if (last < first) {
+                printf("Letter range in DEF statement is reversed \n");
+                exit(231);
+            }
+        }
+
+        for (int i = first;i <= last;i++) {
+            node->def_type_statement.letters |= 1u << i;
+        }
+
+        token = peek(token_peeker);
+        if (token == NULL || token->token_type != COMMA) {
+            break;
+        }
+        next(token_peeker);
+    }
+
+    return node;
+}
+
 struct AstNode* parse_if_statement(struct TokenPeeker* token_peeker) {
-    struct AstNode* node = (struct AstNode*)malloc(sizeof(struct AstNode));
-    node->node_type = IF_STATEMENT;
-    node->if_statement.token = peek(token_peeker);
+    struct AstNode* node = new_ast_node(token_peeker, IF_STATEMENT);
+    node->if_statement.token = keep_token(token_peeker, peek(token_peeker));
 
     next(token_peeker);
-    node->if_statement.condition_expression = parse_expression(token_peeker, -1);
+    node->if_statement.condition_expression = expect_expression(token_peeker,
+        parse_expression(token_peeker, -1), node->if_statement.token);
 
     struct Token* token = peek(token_peeker);
-    if (token->token_type != UNQUOTED_STRING || strcmp(token->value, "then") != 0) {
+    if (token->token_type != THEN_KEYWORD) {
         exit(20);
     }
     next(token_peeker);
@@ -478,24 +790,13 @@ struct AstNode* parse_if_statement(struct TokenPeeker* token_peeker) {
     token = peek(token_peeker);
     if (token == NULL) {
         exit(15);
-    } else if (
-        token->token_type == UNQUOTED_STRING && 
-        (
-            strcmp(token->value, "elseif") == 0 ||
-            strcmp(token->value, "else") == 0
-        )
-    ) {
-        struct StatementsList* elsesList = new_statements_list();
+    } else if (token->token_type == ELSEIF_KEYWORD || token->token_type == ELSE_KEYWORD) {
+        struct StatementsList* elsesList = new_statements_list(token_peeker);
         node->if_statement.elses = elsesList;
-        while (token != NULL && token->token_type == UNQUOTED_STRING && 
-        (
-            strcmp(token->value, "elseif") == 0 ||
-            strcmp(token->value, "else") == 0
-        )) {
-            if (strcmp(token->value, "else") == 0) {
-                struct AstNode* elseNode = (struct AstNode*)malloc(sizeof(struct AstNode));
-                elseNode->node_type = IF_STATEMENT;
-                elseNode->if_statement.token = peek(token_peeker);
+        while (token != NULL && (token->token_type == ELSEIF_KEYWORD || token->token_type == ELSE_KEYWORD)) {
+            if (token->token_type == ELSE_KEYWORD) {
+                struct AstNode* elseNode = new_ast_node(token_peeker, IF_STATEMENT);
+                elseNode->if_statement.token = keep_token(token_peeker, peek(token_peeker));
                 elseNode->if_statement.elses = NULL;
 
                 next(token_peeker);
@@ -504,32 +805,24 @@ struct AstNode* parse_if_statement(struct TokenPeeker* token_peeker) {
                 struct StatementsList* elseBodyList = parse_statements(token_peeker);
                 skip_newlines(token_peeker);
 
-                struct Token* trueToken = (struct Token*)malloc(sizeof(struct Token)); 
-                trueToken->token_type = NUMBER;
-                trueToken->value = "1";  
-
-                struct AstNode* trueExpression = (struct AstNode*)malloc(sizeof(struct AstNode));
-                trueExpression->node_type = CONST_NUMBER_EXPRESSION;
-                trueExpression->const_number_expression.token = trueToken;
-
                 elseNode->if_statement.body = elseBodyList;
-                elseNode->if_statement.condition_expression = trueExpression;
+                elseNode->if_statement.condition_expression = NULL;
 
-                add_statement_to_list(node->if_statement.elses, *elseNode);
+                add_statement_to_list(token_peeker, node->if_statement.elses, *elseNode);
                 token = peek(token_peeker);
             } else {
-                struct AstNode* elseNode = (struct AstNode*)malloc(sizeof(struct AstNode));
-                elseNode->node_type = IF_STATEMENT;
-                elseNode->if_statement.token = peek(token_peeker);
+                struct AstNode* elseNode = new_ast_node(token_peeker, IF_STATEMENT);
+                elseNode->if_statement.token = keep_token(token_peeker, peek(token_peeker));
                 elseNode->if_statement.elses = NULL;
 
                 next(token_peeker);
                 skip_newlines(token_peeker);
 
-                elseNode->if_statement.condition_expression = parse_expression(token_peeker, -1);
+                elseNode->if_statement.condition_expression = expect_expression(token_peeker,
+                    parse_expression(token_peeker, -1), elseNode->if_statement.token);
 
                 token = peek(token_peeker);
-                if (token->token_type != UNQUOTED_STRING || strcmp(token->value, "then") != 0) {
+                if (token->token_type != THEN_KEYWORD) {
                     exit(20);
                 }
                 next(token_peeker);
@@ -538,14 +831,18 @@ struct AstNode* parse_if_statement(struct TokenPeeker* token_peeker) {
                 skip_newlines(token_peeker);
 
                 elseNode->if_statement.body = elseBodyList;
-                add_statement_to_list(node->if_statement.elses, *elseNode);
+                add_statement_to_list(token_peeker, node->if_statement.elses, *elseNode);
                 token = peek(token_peeker);
             }
         }
     }
 
-    if (token->token_type == UNQUOTED_STRING && strcmp(token->value, "end") == 0) {
-        next(token_peeker);    
+    if (token != NULL && token->token_type == END_KEYWORD) {
+        token = next(token_peeker);
+        if (token == NULL || token->token_type != IF_KEYWORD) {
+            exit(354);
+        }
+
         next(token_peeker);
         skip_newlines(token_peeker);
     } else {
@@ -562,90 +859,252 @@ void skip_newlines(struct TokenPeeker* token_peeker) {
 }
 
 struct StatementsList* parse_statements(struct TokenPeeker* token_peeker) {
-    struct StatementsList* list = new_statements_list();
+    struct StatementsList* list = new_statements_list(token_peeker);
     while (peek(token_peeker) != NULL) {
         skip_newlines(token_peeker);
 
         struct Token* first_token = peek(token_peeker);
         if (first_token == NULL) {
-            exit(120);      
-        }
-
-        if (
-            first_token->token_type == UNQUOTED_STRING &&
-            strcmp(first_token->value, "print") == 0
-        ) {
-            struct AstNode* print_statement = parse_print_statement(token_peeker);
-            // print_node(print_statement);
-            add_statement_to_list(list, *print_statement);
-            continue;
-        }
-
-        if (
-            first_token->token_type == UNQUOTED_STRING &&
-            strcmp(first_token->value, "if") == 0
-        ) {
-            struct AstNode* if_statement = parse_if_statement(token_peeker);
-            print_node(if_statement);
-            add_statement_to_list(list, *if_statement);
-            continue;
-        }
-
-        if (
-            first_token->token_type == UNQUOTED_STRING &&
-            strcmp(first_token->value, "do") == 0
-        ) {
-            struct AstNode* loop_statement = parse_loop_statement(token_peeker);
-            print_node(loop_statement);
-            add_statement_to_list(list, *loop_statement);
-            continue;
-        }
-
-        if (
-            first_token->token_type == UNQUOTED_STRING &&
-            strcmp(first_token->value, "for") == 0
-        ) {
-            struct AstNode* for_statement = parse_for_statement(token_peeker);
-            print_node(for_statement);
-            add_statement_to_list(list, *for_statement);
-            continue;
+            break;
         }
 
-        if (
-            first_token->token_type == UNQUOTED_STRING &&
-            (
-                strcmp(first_token->value, "end") == 0 ||
-                strcmp(first_token->value, "else") == 0 ||
-                strcmp(first_token->value, "elseif") == 0 ||
-                strcmp(first_token->value, "loop") == 0 ||
-                strcmp(first_token->value, "next") == 0
-            )
-        ) {
-            return list;
+        switch (first_token->token_type) {
+            case PRINT_KEYWORD: {
+                struct AstNode* print_statement = parse_print_statement(token_peeker);
+                // print_node(token_peeker->source, print_statement);
+                add_statement_to_list(token_peeker, list, *print_statement);
+                continue;
+            }
+            case IF_KEYWORD: {
+                struct AstNode* if_statement = parse_if_statement(token_peeker);
+                add_statement_to_list(token_peeker, list, *if_statement);
+                continue;
+            }
+            case DO_KEYWORD: {
+                struct AstNode* loop_statement = parse_loop_statement(token_peeker);
+                add_statement_to_list(token_peeker, list, *loop_statement);
+                continue;
+            }
+            case FOR_KEYWORD: {
+                struct AstNode* for_statement = parse_for_statement(token_peeker);
+                add_statement_to_list(token_peeker, list, *for_statement);
+                continue;
+            }
+            case DEFINT_KEYWORD:
+            case DEFLNG_KEYWORD:
+            case DEFSNG_KEYWORD:
+            case DEFDBL_KEYWORD:
+            case DEFSTR_KEYWORD: {
+                struct AstNode* def_type_statement = parse_def_type_statement(token_peeker);
+                add_statement_to_list(token_peeker, list, *def_type_statement);
+                continue;
+            }
+            case END_KEYWORD:
+            case ELSE_KEYWORD:
+            case ELSEIF_KEYWORD:
+            case LOOP_KEYWORD:
+            case NEXT_KEYWORD:
+                return list;
+            default:
+                break;
         }
 
         // COULDN'T RECOGNIZE OPERATOR SO PROBABLY IS ASSIGNMENT
         if (first_token->token_type == UNQUOTED_STRING) {
             struct AstNode* assign_statement = parse_assign_statement(token_peeker);
-            // print_node(assign_statement);
-            add_statement_to_list(list, *assign_statement);
+            // print_node(token_peeker->source, assign_statement);
+            add_statement_to_list(token_peeker, list, *assign_statement);
             continue;
         }
 
-        printf("undefined token is %s \n", first_token->value);
-        printf("undefined token position is %d \n", first_token->row);
+        printf("undefined token is %.*s \n", (int)first_token->length, get_token_text(token_peeker->source, first_token));
+        printf("undefined token position is %d \n", get_source_position(token_peeker->source, get_token_start(first_token)).row);
         exit(163);
     }
 
     return list;
 }
 
-struct Program parse(struct TokenList tokens) {
+struct Program build_program(struct Arena* arena, const char* source, struct StatementsList* list, size_t arena_start) {
     struct Program program;
-    struct TokenPeeker token_peeker = new_token_peeker(&tokens);
-
-    struct StatementsList* list = parse_statements(&token_peeker);
+    program.arena = arena;
+    program.source = source;
+    program.owns_arena = 1;
     program.list = list;
+    resolve_symbols(&program);
+    program.arena_bytes = get_arena_used(program.arena) - arena_start;
 
     return program;
 }
+
+struct Program parse_with_peeker(struct TokenPeeker* token_peeker) {
+    size_t arena_start = get_arena_used(token_peeker->arena);
+    struct StatementsList* list = parse_statements(token_peeker);
+
+    return build_program(token_peeker->arena, token_peeker->source, list, arena_start);
+}
+
+// CUTS THE TOKENS AFTER NEW_LINEs OUTSIDE ANY IF, DO OR FOR BLOCK INTO AT MOST max_SEGMENTS
+// OF ROUGHLY EQUAL SIZE. RETURNS 0 WHEN A BLOCK IS LEFT OPEN OR CLOSED TWICE, SINCE ONLY
+// THE SEQUENTIAL PARSER KNOWS WHERE SUCH A PROGRAM STOPS OR WHICH ERROR IT REPORTS
+long split_top_level_statements(struct TokenList* tokens, struct ParseSegment* segments, long max_segments) {
+    long target_size = tokens->length / max_segments;
+    long segment_count = 0;
+    long start = 0;
+    int depth = 0;
+
+    for (long i = 0;i < tokens->length;i++) {
+        switch (tokens->tokens[i].token_type) {
+            case IF_KEYWORD:
+                // THE IF OF END IF IS ALREADY CLOSED BY ITS END
+                if (i == 0 || tokens->tokens[i - 1].token_type != END_KEYWORD) {
+                    depth++;
+                }
+                break;
+            case DO_KEYWORD:
+            case FOR_KEYWORD:
+                depth++;
+                break;
+            case END_KEYWORD:
+            case LOOP_KEYWORD:
+            case NEXT_KEYWORD:
+                depth--;
+                if (depth < 0) {
+                    return 0;
+                }
+                break;
+            case ELSE_KEYWORD:
+            case ELSEIF_KEYWORD:
+                if (depth == 0) {
+                    return 0;
+                }
+                break;
+            case NEW_LINE:
+                if (depth == 0 && i + 1 - start >= target_size && segment_count < max_segments - 1) {
+                    segments[segment_count] = (struct ParseSegment){start, i + 1, NULL};
+                    segment_count++;
+                    start = i + 1;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (depth != 0) {
+        return 0;
+    }
+
+    segments[segment_count] = (struct ParseSegment){start, tokens->length, NULL};
+    return segment_count + 1;
+}
+
+void parse_segment_task(void* context, int worker, int task) {
+    struct ParallelParse* job = (struct ParallelParse*)context;
+    struct ParseSegment* segment = &job->segments[task];
+
+    segment->list = parse_token_range(job->tokens, segment->start, segment->end, job->worker_arenas[worker]);
+}
+
+struct StatementsList* parse_token_range(struct TokenList* tokens, long start, long end, struct Arena* arena) {
+    struct TokenList range = *tokens;
+    range.tokens += start;
+    range.length = end - start;
+    range.capacity = range.length;
+
+    struct TokenPeeker token_peeker = new_token_peeker(&range, arena);
+    return parse_statements(&token_peeker);
+}
+
+struct Program parse_in_parallel(struct TokenList tokens, int worker_count) {
+    long max_segments = (long)worker_count * PARSE_SEGMENTS_PER_WORKER;
+    if (tokens.length / MIN_PARSE_SEGMENT_TOKENS < max_segments) {
+        max_segments = tokens.length / MIN_PARSE_SEGMENT_TOKENS;
+    }
+
+    struct ParseSegment* segments = NULL;
+    long segment_count = 0;
+    if (worker_count > 1 && max_segments > 1) {
+        segments = (struct ParseSegment*)malloc(max_segments * sizeof(struct ParseSegment));
+        segment_count = split_top_level_statements(&tokens, segments, max_segments);
+    }
+
+    if (segment_count <= 1) {
+        free(segments);
+        return parse(tokens);
+    }
+
+    struct ParallelParse job;
+    job.tokens = &tokens;
+    job.segments = segments;
+    job.worker_arenas = (struct Arena**)malloc(worker_count * sizeof(struct Arena*));
+    for (int i = 0;i < worker_count;i++) {
+        job.worker_arenas[i] = new_arena(0);
+    }
+
+    run_parallel_tasks((int)segment_count, worker_count, parse_segment_task, &job);
+
+    // THE SEGMENTS' STATEMENTS ARE COPIED IN ORDER INTO ONE LIST, THE NODES THEY POINT TO
+    // STAY IN THE WORKER ARENAS WHICH THE PROGRAM ARENA THEN TAKES OVER
+    struct Arena* arena = new_arena(0);
+    struct StatementsList* list = (struct StatementsList*)arena_alloc(arena, sizeof(struct StatementsList));
+    list->size = 0;
+    for (long i = 0;i < segment_count;i++) {
+        list->size += segments[i].list->size;
+    }
+    list->capacity = list->size;
+    list->statements = (struct AstNode*)arena_alloc(arena, list->size * sizeof(struct AstNode));
+
+    long size = 0;
+    for (long i = 0;i < segment_count;i++) {
+        memcpy(list->statements + size, segments[i].list->statements, segments[i].list->size * sizeof(struct AstNode));
+        size += segments[i].list->size;
+    }
+
+    for (int i = 0;i < worker_count;i++) {
+        adopt_arena(arena, job.worker_arenas[i]);
+    }
+    free(job.worker_arenas);
+    free(segments);
+
+    return build_program(arena, tokens.source, list, 0);
+}
+
+struct Program parse(struct TokenList tokens) {
+    struct TokenPeeker token_peeker = new_token_peeker(&tokens, new_arena(0));
+    return parse_with_peeker(&token_peeker);
+}
+
+struct Program parse_stream(struct Lexer* lexer) {
+    struct TokenPeeker token_peeker = new_stream_token_peeker(lexer, new_arena(0));
+    return parse_with_peeker(&token_peeker);
+}
+
+// THE LEXER RUNS ON ITS OWN THREAD AND HANDS TOKENS OVER THROUGH THE QUEUE
+struct Program parse_pipelined(const char* file_buff, long fsize) {
+    struct TokenQueue queue;
+    start_token_queue(&queue, file_buff, fsize);
+
+    struct TokenPeeker token_peeker = new_queue_token_peeker(&queue, file_buff, new_arena(0));
+    struct Program program = parse_with_peeker(&token_peeker);
+    finish_token_queue(&queue);
+
+    return program;
+}
+
+struct Program parse_stream_in_arena(struct Lexer* lexer, struct Arena* arena) {
+    struct TokenPeeker token_peeker = new_stream_token_peeker(lexer, arena);
+    struct Program program = parse_with_peeker(&token_peeker);
+    program.owns_arena = 0;
+    return program;
+}
+
+void free_program(struct Program* program) {
+    if (program->owns_arena) {
+        free_arena(program->arena);
+    }
+    program->arena = NULL;
+    program->list = NULL;
+    program->symbols.identifier_ids = NULL;
+    program->symbols.slot_count = 0;
+}
@@ -1,6 +1,10 @@
 #ifndef PARSER_H_
 #define PARSER_H_
 
+#include "lexer.h"
+#include "symbols.h"
+#include "token_queue.h"
+
 enum AstNodeType {
     ASSIGN_STATEMENT,
     PRINT_STATEMENT,
@@ -15,10 +19,18 @@ enum AstNodeType {
     IF_STATEMENT,
     LOOP_STATEMENT,
     FOR_STATEMENT,
+    DEF_TYPE_STATEMENT,
 };
 
 typedef struct Program {
     struct StatementsList* list;
+    struct Arena* arena;
+    const char* source;
+    struct SymbolTable symbols;
+    // 0 WHEN THE ARENA WAS PASSED IN AND BELONGS TO THE CALLER
+    int owns_arena;
+    // WHAT THIS PROGRAM TOOK FROM THE ARENA, WHICH OTHER PROGRAMS MAY SHARE
+    size_t arena_bytes;
 } Program;
 
 typedef struct ExpessionsList {
@@ -41,18 +53,25 @@ typedef struct AssignStatement {
 typedef struct PrintStatement {
     struct Token* token;
     struct ExpessionsList expressions;
+    enum TokenType* separators;
 } PrintStatement;
 
 typedef struct ConstStringExpression {
     struct Token* token;
+    const char* value;
+    long length;
 } ConstStringExpression;
 
 typedef struct ConstNumberExpression {
     struct Token* token;
+    struct NumberValue value;
 } ConstNumberExpression;
 
 typedef struct IdentifierExpression {
     struct Token* token;
+    int identifier_id;
+    // INDEX OF THE VARIABLE IN ITS PROGRAM, SET BY resolve_symbols
+    int slot;
 } IdentifierExpression;
 
 typedef struct PrefixExpression {
@@ -89,6 +108,12 @@ typedef struct ForStatement {
     struct StatementsList* body;
 } ForStatement;
 
+typedef struct DefTypeStatement {
+    struct Token* token;
+    // BIT n IS SET WHEN NAMES STARTING WITH THE n-TH LETTER TAKE THE STATEMENT'S TYPE
+    unsigned int letters;
+} DefTypeStatement;
+
 typedef struct AstNode {
     enum AstNodeType node_type;
     union {
@@ -102,9 +127,28 @@ typedef struct AstNode {
         IfStatement if_statement;
         LoopStatement loop_statement;
         ForStatement for_statement;
+        DefTypeStatement def_type_statement;
     };
 } AstNode;
 
+// TOKENS [start, end) HOLD WHOLE TOP LEVEL STATEMENTS, list IS WHAT THEY PARSE TO
+struct ParseSegment {
+    long start;
+    long end;
+    struct StatementsList* list;
+};
+
 struct Program parse(struct TokenList tokens);
+// SPLITS THE PROGRAM BETWEEN TOP LEVEL STATEMENTS AND PARSES THE PIECES ON worker_count
+// THREADS, THE RESULT MATCHES parse
+struct Program parse_in_parallel(struct TokenList tokens, int worker_count);
+long split_top_level_statements(struct TokenList* tokens, struct ParseSegment* segments, long max_segments);
+struct StatementsList* parse_token_range(struct TokenList* tokens, long start, long end, struct Arena* arena);
+struct Program parse_stream(struct Lexer* lexer);
+struct Program parse_pipelined(const char* file_buff, long fsize);
+struct Program parse_stream_in_arena(struct Lexer* lexer, struct Arena* arena);
+// THE PARSER PRINTS NOTHING ITSELF, SO FILES CAN BE PARSED ON SEVERAL THREADS
+void print_program_blocks(struct Program* program);
+void free_program(struct Program* program);
 
 #endif
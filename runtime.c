@@ -0,0 +1,86 @@
+#include "runtime.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#define PRINT_ZONE_WIDTH 14
+
+static long output_column = 0;
+
+_Noreturn static void runtime_error(const char* message);
+
+const struct QbString qb_empty_string = { 0 };
+
+_Noreturn static void runtime_error(const char* message) {
+    fflush(stdout);
+    fprintf(stderr, "Runtime error: %s \n", message);
+    exit(1);
+}
+
+void qb_print_number(double value) {
+    // NUMBERS GET A LEADING SPACE IN PLACE OF THE SIGN AND A TRAILING SPACE,
+    // NEGATIVE ZERO PRINTS AS 0
+    double number = value == 0 ? 0 : value;
+    int printed = printf(number < 0 ? "%.15g " : " %.15g ", number);
+    output_column += printed;
+}
+
+void qb_print_string(const struct QbString* value) {
+    fwrite(value->chars, 1, value->length, stdout);
+
+    const char* last_new_line = memchr(value->chars, '\n', value->length);
+    output_column = last_new_line == NULL
+        ? output_column + value->length
+        : value->chars + value->length - last_new_line - 1;
+}
+
+void qb_print_zone(void) {
+    long padding = PRINT_ZONE_WIDTH - output_column % PRINT_ZONE_WIDTH;
+    printf("%*s", (int)padding, "");
+    output_column += padding;
+}
+
+void qb_print_new_line(void) {
+    putchar('\n');
+    output_column = 0;
+}
+
+const struct QbString* qb_concatenate_strings(const struct QbString* left, const struct QbString* right) {
+    // STRINGS LIVE UNTIL THE PROGRAM EXITS, LIKE THE VM STRING ARENA
+    long length = left->length + right->length;
+    struct QbString* result = (struct QbString*)malloc(sizeof(struct QbString) + length);
+    if (result == NULL) {
+        runtime_error("Out of memory");
+    }
+
+    result->length = length;
+    memcpy(result->chars, left->chars, left->length);
+    memcpy(result->chars + left->length, right->chars, right->length);
+
+    return result;
+}
+
+int qb_compare_strings(const struct QbString* left, const struct QbString* right) {
+    long length = left->length < right->length ? left->length : right->length;
+    int result = memcmp(left->chars, right->chars, length);
+    if (result != 0) {
+        return result;
+    }
+
+    return (left->length > right->length) - (left->length < right->length);
+}
+
+_Noreturn void qb_division_by_zero(void) {
+    runtime_error("Division by zero");
+}
+
+_Noreturn void qb_overflow(void) {
+    runtime_error("Overflow");
+}
+
+int main(void) {
+    qb_program();
+    fflush(stdout);
+
+    return 0;
+}
@@ -0,0 +1,59 @@
+#ifndef RUNTIME_H_
+#define RUNTIME_H_
+
+#include <stdint.h>
+
+// RUNTIME LINKED INTO PROGRAMS BUILT BY THE NATIVE BACKENDS, main() CALLS qb_program()
+
+typedef struct QbString {
+    long length;
+    char chars[];
+} QbString;
+
+extern const struct QbString qb_empty_string;
+
+void qb_program(void);
+
+void qb_print_number(double value);
+void qb_print_string(const struct QbString* value);
+void qb_print_zone(void);
+void qb_print_new_line(void);
+
+const struct QbString* qb_concatenate_strings(const struct QbString* left, const struct QbString* right);
+int qb_compare_strings(const struct QbString* left, const struct QbString* right);
+
+_Noreturn void qb_division_by_zero(void);
+_Noreturn void qb_overflow(void);
+
+// USED BY THE C BACKEND, THE ASSEMBLY BACKEND CHECKS THE DIVISOR INLINE
+static inline double qb_divide(double left, double right) {
+    if (right == 0) {
+        qb_division_by_zero();
+    }
+
+    return left / right;
+}
+
+// ROUNDS HALF TO EVEN LIKE CINT, ADDING 2^52 PUSHES THE FRACTION OUT OF THE MANTISSA
+static inline int64_t qb_round_in_range(double value, double limit) {
+    if (!(value > -limit - 1 && value < limit)) {
+        qb_overflow();
+    }
+
+    double rounded = value >= 0 ? (value + 0x1p52) - 0x1p52 : -((-value + 0x1p52) - 0x1p52);
+    if (rounded < -limit || rounded >= limit) {
+        qb_overflow();
+    }
+
+    return (int64_t)rounded;
+}
+
+static inline int32_t qb_to_integer(double value) {
+    return (int32_t)qb_round_in_range(value, 32768.0);
+}
+
+static inline int64_t qb_to_long(double value) {
+    return qb_round_in_range(value, 2147483648.0);
+}
+
+#endif
@@ -0,0 +1,129 @@
+#define _DEFAULT_SOURCE
+
+#include "source.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define READ_CHUNK_SIZE (64 * 1024)
+
+static char empty_source[1] = {0};
+
+static int map_source_file(int fd, long size, struct SourceFile* source);
+static int read_source_stream(int fd, struct SourceFile* source);
+
+static int map_source_file(int fd, long size, struct SourceFile* source) {
+    if (size == 0) {
+        source->data = empty_source;
+        source->size = 0;
+        source->is_mapped = 0;
+        return 0;
+    }
+
+    void* data = mmap(NULL, (size_t)size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        return -1;
+    }
+
+    madvise(data, (size_t)size, MADV_SEQUENTIAL);
+
+    source->data = (char*)data;
+    source->size = size;
+    source->is_mapped = 1;
+    return 0;
+}
+
+static int read_source_stream(int fd, struct SourceFile* source) {
+    long capacity = READ_CHUNK_SIZE;
+    long size = 0;
+    char* data = (char*)malloc(capacity);
+    if (data == NULL) {
+        return -1;
+    }
+
+    while (1) {
+        if (size == capacity) {
+            capacity *= 2;
+            char* grown = (char*)realloc(data, capacity);
+            if (grown == NULL) {
+                free(data);
+                return -1;
+            }
+
+            data = grown;
+        }
+
+        ssize_t read_bytes = read(fd, data + size, (size_t)(capacity - size));
+        if (read_bytes < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            free(data);
+            return -1;
+        }
+
+        if (read_bytes == 0) {
+            break;
+        }
+
+        size += read_bytes;
+    }
+
+    source->data = data;
+    source->size = size;
+    source->is_mapped = 0;
+    return 0;
+}
+
+int open_source_file(const char* path, struct SourceFile* source) {
+    source->path = path;
+    source->data = NULL;
+    source->size = 0;
+    source->is_mapped = 0;
+
+    int is_stdin = strcmp(path, "-") == 0;
+    int fd = is_stdin ? STDIN_FILENO : open(path, O_RDONLY);
+    if (fd < 0) {
+        printf("Error reading a file %s: %s \n", path, strerror(errno));
+        return -1;
+    }
+
+    struct stat file_stat;
+    int status = -1;
+    if (fstat(fd, &file_stat) == 0 && S_ISREG(file_stat.st_mode)) {
+        status = map_source_file(fd, (long)file_stat.st_size, source);
+    }
+
+    // PIPES, TERMINALS AND FILES THAT CAN'T BE MAPPED ARE READ IN CHUNKS
+    if (status != 0) {
+        status = read_source_stream(fd, source);
+    }
+
+    if (status != 0) {
+        printf("Error reading a file %s: %s \n", path, strerror(errno));
+    }
+
+    if (!is_stdin) {
+        close(fd);
+    }
+
+    return status;
+}
+
+void close_source_file(struct SourceFile* source) {
+    if (source->is_mapped) {
+        munmap(source->data, (size_t)source->size);
+    } else if (source->data != empty_source) {
+        free(source->data);
+    }
+
+    source->data = NULL;
+    source->size = 0;
+    source->is_mapped = 0;
+}
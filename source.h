@@ -0,0 +1,14 @@
+#ifndef SOURCE_H_
+#define SOURCE_H_
+
+struct SourceFile {
+    const char* path;
+    char* data;
+    long size;
+    int is_mapped;
+};
+
+int open_source_file(const char* path, struct SourceFile* source);
+void close_source_file(struct SourceFile* source);
+
+#endif
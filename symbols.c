@@ -0,0 +1,189 @@
+#include "symbols.h"
+#include "parser.h"
+#include "interner.h"
+#include "arena.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#define MIN_SLOT_MAP_CAPACITY 16
+
+static int* find_slot_entry(struct SymbolResolver* resolver, int identifier_id);
+static void grow_slot_map(struct SymbolResolver* resolver);
+static int resolve_identifier(struct SymbolResolver* resolver, int identifier_id);
+static void resolve_expression(struct SymbolResolver* resolver, struct AstNode* node);
+static void resolve_statements(struct SymbolResolver* resolver, struct StatementsList* list);
+
+// LINEAR PROBING, THE ENTRY HOLDING identifier_id'S SLOT OR THE EMPTY ONE WHERE IT GOES
+static int* find_slot_entry(struct SymbolResolver* resolver, int identifier_id) {
+    unsigned int mask = (unsigned int)resolver->slot_map_capacity - 1;
+    unsigned int index = ((unsigned int)identifier_id * 2654435761u) & mask;
+    while (resolver->slots[index] != -1 && resolver->identifier_ids[resolver->slots[index]] != identifier_id) {
+        index = (index + 1) & mask;
+    }
+
+    return &resolver->slots[index];
+}
+
+static void grow_slot_map(struct SymbolResolver* resolver) {
+    free(resolver->slots);
+    resolver->slot_map_capacity *= 2;
+    resolver->slots = (int*)malloc(resolver->slot_map_capacity * sizeof(int));
+    for (int i = 0;i < resolver->slot_map_capacity;i++) {
+        resolver->slots[i] = -1;
+    }
+
+    for (int slot = 0;slot < resolver->slot_count;slot++) {
+        *find_slot_entry(resolver, resolver->identifier_ids[slot]) = slot;
+    }
+}
+
+static int resolve_identifier(struct SymbolResolver* resolver, int identifier_id) {
+    int* entry = find_slot_entry(resolver, identifier_id);
+    if (*entry != -1) {
+        return *entry;
+    }
+
+    if (resolver->slot_count == resolver->slot_capacity) {
+        resolver->slot_capacity = resolver->slot_capacity == 0 ? 16 : resolver->slot_capacity * 2;
+        resolver->identifier_ids = (int*)realloc(resolver->identifier_ids, resolver->slot_capacity * sizeof(int));
+    }
+
+    int slot = resolver->slot_count++;
+    resolver->identifier_ids[slot] = identifier_id;
+    *entry = slot;
+
+    // AT MOST HALF FULL SO PROBES STAY SHORT
+    if (2 * resolver->slot_count > resolver->slot_map_capacity) {
+        grow_slot_map(resolver);
+    }
+
+    return slot;
+}
+
+static void resolve_expression(struct SymbolResolver* resolver, struct AstNode* node) {
+    if (node == NULL) {
+        return;
+    }
+
+    switch (node->node_type)
+    {
+    case IDENTIFIER_EXPRESSION:
+        node->identifier_expression.slot = resolve_identifier(resolver, node->identifier_expression.identifier_id);
+        break;
+    case PREFIX_EXPRESSION:
+        resolve_expression(resolver, node->prefix_expression.value);
+        break;
+    case INFIX_EXPRESSION:
+        resolve_expression(resolver, node->infix_expression.left);
+        resolve_expression(resolver, node->infix_expression.right);
+        break;
+    default:
+        break;
+    }
+}
+
+static void resolve_statements(struct SymbolResolver* resolver, struct StatementsList* list) {
+    if (list == NULL) {
+        return;
+    }
+
+    for (long i = 0;i < list->size;i++) {
+        struct AstNode* node = &list->statements[i];
+        switch (node->node_type)
+        {
+        case ASSIGN_STATEMENT:
+            resolve_expression(resolver, node->assign_statement.identifier);
+            resolve_expression(resolver, node->assign_statement.expression);
+            break;
+        case PRINT_STATEMENT:
+            for (long j = 0;j < node->print_statement.expressions.size;j++) {
+                resolve_expression(resolver, &node->print_statement.expressions.expressions[j]);
+            }
+            break;
+        case IF_STATEMENT:
+            resolve_expression(resolver, node->if_statement.condition_expression);
+            resolve_statements(resolver, node->if_statement.body);
+            resolve_statements(resolver, node->if_statement.elses);
+            break;
+        case LOOP_STATEMENT:
+            resolve_expression(resolver, node->loop_statement.condition_expression);
+            resolve_statements(resolver, node->loop_statement.body);
+            break;
+        case FOR_STATEMENT:
+            resolve_expression(resolver, node->for_statement.control_identifier_expression);
+            resolve_expression(resolver, node->for_statement.initial_expression);
+            resolve_expression(resolver, node->for_statement.end_value_expression);
+            resolve_expression(resolver, node->for_statement.step_expression);
+            resolve_statements(resolver, node->for_statement.body);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+struct SymbolResolver new_symbol_resolver(void) {
+    struct SymbolResolver resolver;
+    resolver.slot_map_capacity = MIN_SLOT_MAP_CAPACITY;
+    resolver.slots = (int*)malloc(resolver.slot_map_capacity * sizeof(int));
+    for (int i = 0;i < resolver.slot_map_capacity;i++) {
+        resolver.slots[i] = -1;
+    }
+    resolver.identifier_ids = NULL;
+    resolver.slot_count = 0;
+    resolver.slot_capacity = 0;
+
+    return resolver;
+}
+
+void resolve_new_symbols(struct SymbolResolver* resolver, struct StatementsList* list) {
+    resolve_statements(resolver, list);
+}
+
+void free_symbol_resolver(struct SymbolResolver* resolver) {
+    free(resolver->slots);
+    free(resolver->identifier_ids);
+    resolver->slots = NULL;
+    resolver->identifier_ids = NULL;
+    resolver->slot_map_capacity = 0;
+    resolver->slot_count = 0;
+    resolver->slot_capacity = 0;
+}
+
+void resolve_symbols(struct Program* program) {
+    // QBASIC WITHOUT SUB AND FUNCTION HAS ONE MODULE LEVEL SCOPE, SO ONE TABLE COVERS THE PROGRAM
+    struct SymbolResolver resolver = new_symbol_resolver();
+    resolve_new_symbols(&resolver, program->list);
+
+    // THE FINISHED TABLE LIVES IN THE PROGRAM'S ARENA AND IS FREED WITH THE AST
+    program->symbols.slot_count = resolver.slot_count;
+    program->symbols.identifier_ids = (int*)arena_alloc(program->arena, (resolver.slot_count + 1) * sizeof(int));
+    if (resolver.slot_count > 0) {
+        memcpy(program->symbols.identifier_ids, resolver.identifier_ids, resolver.slot_count * sizeof(int));
+    }
+
+    free_symbol_resolver(&resolver);
+}
+
+int get_slot_identifier(const struct SymbolTable* symbols, int slot) {
+    if (slot < 0 || slot >= symbols->slot_count) {
+        return -1;
+    }
+
+    return symbols->identifier_ids[slot];
+}
+
+const char* get_slot_name(const struct SymbolTable* symbols, int slot) {
+    return get_identifier_name(get_slot_identifier(symbols, slot));
+}
+
+size_t get_symbol_table_size(const struct SymbolTable* symbols) {
+    return sizeof(struct SymbolTable) + symbols->slot_count * sizeof(int);
+}
+
+void print_memory_footprint(const struct Program* program) {
+    // NAMES ARE SHARED BY EVERY FILE THROUGH THE INTERNER, SO THEY ARE NOT COUNTED PER PROGRAM
+    printf("memory: %d variables, %zu bytes of symbol table, %zu arena bytes used by the AST \n",
+        program->symbols.slot_count, get_symbol_table_size(&program->symbols), program->arena_bytes);
+}
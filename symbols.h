@@ -0,0 +1,39 @@
+#ifndef SYMBOLS_H_
+#define SYMBOLS_H_
+
+#include <stddef.h>
+
+struct Program;
+struct StatementsList;
+
+// EVERY VARIABLE OF A PROGRAM GETS A DENSE SLOT IN ORDER OF FIRST USE, SO THE BACKENDS
+// INDEX THEIR ARRAYS BY SLOT INSTEAD OF BY THE INTERNED IDENTIFIER ID SHARED BY ALL FILES
+struct SymbolTable {
+    // identifier_ids[slot] IS THE NAME BEHIND A SLOT
+    int* identifier_ids;
+    int slot_count;
+};
+
+// REMEMBERS THE SLOT OF EVERY NAME IT HAS SEEN, SO A PROGRAM THAT GETS MORE STATEMENTS
+// KEEPS ITS SLOTS AND ONLY NAMES FIRST USED IN THE NEW ONES GET THE NEXT SLOTS
+struct SymbolResolver {
+    // OPEN ADDRESSED BY INTERNED IDENTIFIER ID, EACH ENTRY IS A SLOT OR -1. IT IS SIZED BY THE
+    // PROGRAM'S OWN NAMES, NOT BY EVERY NAME THE OTHER FILES INTERNED
+    int* slots;
+    int slot_map_capacity;
+
+    int* identifier_ids;
+    int slot_count;
+    int slot_capacity;
+};
+
+void resolve_symbols(struct Program* program);
+struct SymbolResolver new_symbol_resolver(void);
+void resolve_new_symbols(struct SymbolResolver* resolver, struct StatementsList* list);
+void free_symbol_resolver(struct SymbolResolver* resolver);
+int get_slot_identifier(const struct SymbolTable* symbols, int slot);
+const char* get_slot_name(const struct SymbolTable* symbols, int slot);
+size_t get_symbol_table_size(const struct SymbolTable* symbols);
+void print_memory_footprint(const struct Program* program);
+
+#endif
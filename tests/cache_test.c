@@ -0,0 +1,141 @@
+#define _DEFAULT_SOURCE
+
+#include "../cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+static int failures = 0;
+
+static void check(int passed, const char* condition, int line);
+static struct Chunk new_print_chunk(void);
+static void write_entry_field(const char* path, long offset, int32_t value);
+
+static void check(int passed, const char* condition, int line) {
+    if (!passed) {
+        printf("cache_test.c:%d: %s failed \n", line, condition);
+        failures++;
+    }
+}
+
+// PRINT 1, THE ONLY PUSH MAKES A DEPTH OF ONE
+static struct Chunk new_print_chunk(void) {
+    struct Chunk chunk = new_chunk();
+    struct Value one;
+    one.type = NUMBER_VALUE;
+    one.number = 1;
+
+    emit_op(&chunk, OP_CONSTANT);
+    emit_operand(&chunk, add_constant(&chunk, one));
+    emit_op(&chunk, OP_PRINT);
+    emit_op(&chunk, OP_HALT);
+    chunk.max_stack_depth = 1;
+
+    return chunk;
+}
+
+// OFFSETS IN THE ENTRY HEADER, AFTER THE MAGIC, VERSION, KEY, SOURCE SIZE, CODE LENGTH AND CONSTANT COUNT
+#define SLOT_COUNT_OFFSET (4 + 4 + 8 + 8 + 8 + 4)
+#define STACK_DEPTH_OFFSET (SLOT_COUNT_OFFSET + 4)
+
+static void write_entry_field(const char* path, long offset, int32_t value) {
+    FILE* file = fopen(path, "r+b");
+    if (file == NULL) {
+        perror(path);
+        exit(1);
+    }
+
+    fseek(file, offset, SEEK_SET);
+    fwrite(&value, sizeof(value), 1, file);
+    fclose(file);
+}
+
+int main(void) {
+    struct Chunk chunk = new_print_chunk();
+    CHECK(verify_chunk(&chunk));
+
+    // A STACK SMALLER THAN THE CODE NEEDS
+    chunk.max_stack_depth = 0;
+    CHECK(!verify_chunk(&chunk));
+    chunk.max_stack_depth = 1;
+
+    // A JUMP INTO THE OPERAND OF THE CONSTANT
+    struct Chunk jump = new_chunk();
+    emit_op(&jump, OP_JUMP);
+    emit_operand(&jump, 6);
+    emit_op(&jump, OP_CONSTANT);
+    emit_operand(&jump, add_constant(&jump, chunk.constants[0]));
+    emit_op(&jump, OP_HALT);
+    jump.max_stack_depth = 1;
+    CHECK(!verify_chunk(&jump));
+    patch_operand(&jump, 1, 10);
+    CHECK(verify_chunk(&jump));
+    free_chunk(&jump);
+
+    // A FOR_TEST WHOSE end SLOT IS THE LAST int32_t, ITS STEP SLOT WOULD BE ONE PAST IT
+    struct Chunk loop = new_chunk();
+    emit_op(&loop, OP_FOR_TEST);
+    emit_operand(&loop, 0);
+    emit_operand(&loop, INT32_MAX);
+    emit_operand(&loop, 13);
+    emit_op(&loop, OP_HALT);
+    loop.slot_count = 2;
+    CHECK(!verify_chunk(&loop));
+    patch_operand(&loop, 5, 0);
+    CHECK(verify_chunk(&loop));
+    patch_operand(&loop, 5, 1);
+    CHECK(!verify_chunk(&loop));
+    free_chunk(&loop);
+
+    char directory[] = "/tmp/qb_cache_test.XXXXXX";
+    if (mkdtemp(directory) == NULL) {
+        perror(directory);
+        return 1;
+    }
+
+    struct CompilationCache cache = {directory, 0, 0, 0};
+    const char source[] = "print 1\n";
+    uint64_t key = get_cache_key(source, sizeof(source) - 1, 1);
+    CHECK(get_cache_key(source, sizeof(source) - 1, 0) != key);
+
+    struct Chunk loaded;
+    CHECK(!load_cached_chunk(&cache, key, sizeof(source) - 1, &loaded));
+    CHECK(store_cached_chunk(&cache, key, sizeof(source) - 1, &chunk) == 0);
+    CHECK(load_cached_chunk(&cache, key, sizeof(source) - 1, &loaded));
+    CHECK(loaded.code_length == chunk.code_length && memcmp(loaded.code, chunk.code, chunk.code_length) == 0);
+    CHECK(loaded.max_stack_depth == 1);
+    free_chunk(&loaded);
+
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%016llx.qbc", directory, (unsigned long long)key);
+    struct stat entry;
+    CHECK(stat(path, &entry) == 0 && (entry.st_mode & 0777) == 0644);
+
+    // A DAMAGED DEPTH IS A MISS, NOT A STACK THE VM OVERRUNS
+    write_entry_field(path, STACK_DEPTH_OFFSET, 0);
+    CHECK(!load_cached_chunk(&cache, key, sizeof(source) - 1, &loaded));
+    write_entry_field(path, STACK_DEPTH_OFFSET, 1 << 30);
+    CHECK(!load_cached_chunk(&cache, key, sizeof(source) - 1, &loaded));
+
+    // SO IS A SLOT COUNT NO CODE COULD NAME
+    write_entry_field(path, STACK_DEPTH_OFFSET, 1);
+    write_entry_field(path, SLOT_COUNT_OFFSET, INT32_MAX);
+    CHECK(!load_cached_chunk(&cache, key, sizeof(source) - 1, &loaded));
+    write_entry_field(path, SLOT_COUNT_OFFSET, 0);
+    CHECK(load_cached_chunk(&cache, key, sizeof(source) - 1, &loaded));
+    free_chunk(&loaded);
+    CHECK(cache.hits == 2 && cache.misses == 4 && cache.stores == 1);
+
+    unlink(path);
+    rmdir(directory);
+    free_chunk(&chunk);
+
+    if (failures == 0) {
+        printf("cache_test: all passed \n");
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,61 @@
+#include "../keywords.h"
+#include "../keyword_list.h"
+#include <stdio.h>
+#include <string.h>
+
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+struct KeywordEntry {
+    const char* word;
+    enum TokenType token_type;
+};
+
+static const struct KeywordEntry keywords[] = {
+#define KEYWORD(word, token_type) {#word, token_type},
+    KEYWORD_LIST
+#undef KEYWORD
+};
+
+static int failures = 0;
+
+static void check(int passed, const char* condition, int line);
+
+static void check(int passed, const char* condition, int line) {
+    if (!passed) {
+        printf("keywords_test.c:%d: %s failed \n", line, condition);
+        failures++;
+    }
+}
+
+int main(void) {
+    int count = (int)(sizeof(keywords) / sizeof(keywords[0]));
+    for (int i = 0;i < count;i++) {
+        const char* word = keywords[i].word;
+        long length = (long)strlen(word);
+
+        // EVERY SLOT HOLDS ONE KEYWORD, SO EACH ONE FINDING ITSELF MEANS NONE COLLIDE
+        CHECK(lookup_keyword(word, length) == keywords[i].token_type);
+        CHECK(is_keyword_token_type(keywords[i].token_type));
+
+        char upper[16];
+        for (long j = 0;j <= length;j++) {
+            upper[j] = (char)(word[j] & ~0x20);
+        }
+        CHECK(lookup_keyword(upper, length) == keywords[i].token_type);
+
+        // A PREFIX OR AN EXTENSION OF A KEYWORD IS AN IDENTIFIER
+        char longer[16];
+        snprintf(longer, sizeof(longer), "%sx", word);
+        CHECK(lookup_keyword(longer, length + 1) == UNQUOTED_STRING);
+        CHECK(length == 1 || lookup_keyword(word, length - 1) != keywords[i].token_type);
+    }
+
+    CHECK(lookup_keyword("x", 1) == UNQUOTED_STRING);
+    CHECK(lookup_keyword("counter", 7) == UNQUOTED_STRING);
+    CHECK(lookup_keyword("nxet", 4) == UNQUOTED_STRING);
+
+    if (failures == 0) {
+        printf("keywords_test: all passed \n");
+    }
+    return failures == 0 ? 0 : 1;
+}
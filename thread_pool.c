@@ -0,0 +1,131 @@
+#define _DEFAULT_SOURCE
+
+#include "thread_pool.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+
+// EVERY WORKER STARTS WITH A CONTIGUOUS RANGE OF TASKS, TAKES ITS OWN FROM THE BACK AND
+// STEALS FROM THE FRONT OF THE OTHERS WHEN IT RUNS DRY. NO TASK IS ADDED AFTER THE START,
+// SO A WORKER THAT FINDS EVERY QUEUE EMPTY IS DONE
+struct TaskQueue {
+    pthread_mutex_t lock;
+    int front;
+    int back;
+};
+
+struct ThreadPool {
+    struct TaskQueue* queues;
+    int worker_count;
+    TaskFunction run_task;
+    void* context;
+};
+
+struct Worker {
+    struct ThreadPool* pool;
+    int index;
+    pthread_t thread;
+};
+
+static int pop_task(struct TaskQueue* queue);
+static int steal_task(struct TaskQueue* queue);
+static void* run_worker(void* argument);
+
+static int pop_task(struct TaskQueue* queue) {
+    int task = -1;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->front < queue->back) {
+        task = --queue->back;
+    }
+    pthread_mutex_unlock(&queue->lock);
+
+    return task;
+}
+
+static int steal_task(struct TaskQueue* queue) {
+    int task = -1;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->front < queue->back) {
+        task = queue->front++;
+    }
+    pthread_mutex_unlock(&queue->lock);
+
+    return task;
+}
+
+static void* run_worker(void* argument) {
+    struct Worker* worker = (struct Worker*)argument;
+    struct ThreadPool* pool = worker->pool;
+
+    while (1) {
+        int task = pop_task(&pool->queues[worker->index]);
+        for (int i = 1;task == -1 && i < pool->worker_count;i++) {
+            task = steal_task(&pool->queues[(worker->index + i) % pool->worker_count]);
+        }
+
+        if (task == -1) {
+            return NULL;
+        }
+
+        pool->run_task(pool->context, worker->index, task);
+    }
+}
+
+int get_default_worker_count(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+}
+
+void run_parallel_tasks(int task_count, int worker_count, TaskFunction run_task, void* context) {
+    if (worker_count > task_count) {
+        worker_count = task_count;
+    }
+
+    if (worker_count <= 1) {
+        for (int i = 0;i < task_count;i++) {
+            run_task(context, 0, i);
+        }
+        return;
+    }
+
+    struct ThreadPool pool;
+    pool.queues = (struct TaskQueue*)malloc(worker_count * sizeof(struct TaskQueue));
+    pool.worker_count = worker_count;
+    pool.run_task = run_task;
+    pool.context = context;
+
+    struct Worker* workers = (struct Worker*)malloc(worker_count * sizeof(struct Worker));
+    if (pool.queues == NULL || workers == NULL) {
+        printf("Out of memory starting %d workers \n", worker_count);
+        exit(1);
+    }
+
+    for (int i = 0;i < worker_count;i++) {
+        pthread_mutex_init(&pool.queues[i].lock, NULL);
+        pool.queues[i].front = (int)((long)task_count * i / worker_count);
+        pool.queues[i].back = (int)((long)task_count * (i + 1) / worker_count);
+        workers[i].pool = &pool;
+        workers[i].index = i;
+    }
+
+    // THE CALLING THREAD IS WORKER 0
+    int started = 1;
+    for (int i = 1;i < worker_count;i++) {
+        if (pthread_create(&workers[i].thread, NULL, run_worker, &workers[i]) != 0) {
+            break;
+        }
+        started++;
+    }
+
+    run_worker(&workers[0]);
+    for (int i = 1;i < started;i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+
+    for (int i = 0;i < worker_count;i++) {
+        pthread_mutex_destroy(&pool.queues[i].lock);
+    }
+    free(workers);
+    free(pool.queues);
+}
@@ -0,0 +1,10 @@
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+typedef void (*TaskFunction)(void* context, int worker, int task);
+
+int get_default_worker_count(void);
+// RUNS TASKS 0..task_count-1, EACH EXACTLY ONCE, AND RETURNS WHEN ALL OF THEM ARE DONE
+void run_parallel_tasks(int task_count, int worker_count, TaskFunction run_task, void* context);
+
+#endif
@@ -0,0 +1,114 @@
+#define _DEFAULT_SOURCE
+
+#include "token_queue.h"
+#include <sched.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+// POWER OF TWO, EACH SIDE PUBLISHES ITS INDEX ONCE PER BATCH INSTEAD OF ONCE PER TOKEN
+#define TOKEN_QUEUE_BATCH 64
+// THE LAST TOKENS THE PARSER MOVED PAST ARE NOT OVERWRITTEN, SO A TOKEN IT PEEKED STAYS
+// VALID FOR AS LONG AS IT WOULD IN THE LEXER WINDOW
+#define TOKEN_QUEUE_SPACE (TOKEN_QUEUE_CAPACITY - LEXER_LOOKAHEAD)
+
+static void* run_lexer(void* argument);
+
+static void* run_lexer(void* argument) {
+    struct TokenQueue* queue = (struct TokenQueue*)argument;
+    long write_index = 0;
+    long visible_tail = 0;
+
+    struct Token* token = lexer_peek(&queue->lexer, 0);
+    while (token != NULL) {
+        if (write_index - visible_tail >= TOKEN_QUEUE_SPACE) {
+            // PUBLISH WHAT IS WRITTEN FIRST, THE PARSER MAY BE WAITING FOR IT
+            __atomic_store_n(&queue->head, write_index, __ATOMIC_RELEASE);
+            visible_tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+            while (write_index - visible_tail >= TOKEN_QUEUE_SPACE) {
+                if (__atomic_load_n(&queue->stopped, __ATOMIC_ACQUIRE)) {
+                    return NULL;
+                }
+                sched_yield();
+                visible_tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+            }
+        }
+
+        queue->tokens[write_index & (TOKEN_QUEUE_CAPACITY - 1)] = *token;
+        write_index++;
+        if ((write_index & (TOKEN_QUEUE_BATCH - 1)) == 0) {
+            __atomic_store_n(&queue->head, write_index, __ATOMIC_RELEASE);
+        }
+
+        token = lexer_next(&queue->lexer);
+    }
+
+    __atomic_store_n(&queue->head, write_index, __ATOMIC_RELEASE);
+    __atomic_store_n(&queue->finished, 1, __ATOMIC_RELEASE);
+
+    return NULL;
+}
+
+void start_token_queue(struct TokenQueue* queue, const char* file_buff, long fsize) {
+    queue->tokens = (struct Token*)malloc(TOKEN_QUEUE_CAPACITY * sizeof(struct Token));
+    if (queue->tokens == NULL) {
+        printf("Out of memory allocating token queue \n");
+        exit(1);
+    }
+
+    queue->lexer = new_lexer(file_buff, fsize);
+    queue->head = 0;
+    queue->finished = 0;
+    queue->tail = 0;
+    queue->stopped = 0;
+    queue->read_index = 0;
+    queue->visible_head = 0;
+
+    if (pthread_create(&queue->thread, NULL, run_lexer, queue) != 0) {
+        printf("Couldn't start lexer thread \n");
+        exit(1);
+    }
+}
+
+struct Token* token_queue_peek(struct TokenQueue* queue) {
+    while (queue->read_index == queue->visible_head) {
+        queue->visible_head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+        if (queue->read_index < queue->visible_head) {
+            break;
+        }
+
+        if (__atomic_load_n(&queue->finished, __ATOMIC_ACQUIRE)) {
+            // head IS PUBLISHED BEFORE finished, SO THIS READ SEES THE LAST TOKENS
+            queue->visible_head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+            if (queue->read_index == queue->visible_head) {
+                return NULL;
+            }
+            break;
+        }
+
+        // PUBLISH WHAT IS READ FIRST, THE LEXER MAY BE WAITING FOR ROOM
+        __atomic_store_n(&queue->tail, queue->read_index, __ATOMIC_RELEASE);
+        sched_yield();
+    }
+
+    return &queue->tokens[queue->read_index & (TOKEN_QUEUE_CAPACITY - 1)];
+}
+
+struct Token* token_queue_next(struct TokenQueue* queue) {
+    if (token_queue_peek(queue) != NULL) {
+        queue->read_index++;
+        if ((queue->read_index & (TOKEN_QUEUE_BATCH - 1)) == 0) {
+            __atomic_store_n(&queue->tail, queue->read_index, __ATOMIC_RELEASE);
+        }
+    }
+
+    return token_queue_peek(queue);
+}
+
+// THE PARSER MAY STOP BEFORE THE LAST TOKEN, SO THE LEXER IS TOLD TO GIVE UP BEFORE THE JOIN
+void finish_token_queue(struct TokenQueue* queue) {
+    __atomic_store_n(&queue->stopped, 1, __ATOMIC_RELEASE);
+    pthread_join(queue->thread, NULL);
+
+    free(queue->tokens);
+    queue->tokens = NULL;
+}
@@ -0,0 +1,35 @@
+#ifndef TOKEN_QUEUE_H_
+#define TOKEN_QUEUE_H_
+
+#include <pthread.h>
+#include "lexer.h"
+
+// POWER OF TWO, THE RING IS INDEXED WITH A MASK. SMALL ENOUGH TO STAY IN CACHE
+// WHILE THE LEXER WRITES IT AND THE PARSER READS IT
+#define TOKEN_QUEUE_CAPACITY 1024
+
+// ONE LEXER THREAD PUSHES TOKENS, ONE PARSER THREAD TAKES THEM. head AND tail ONLY EVER
+// GROW, EACH IS WRITTEN BY ONE SIDE AND SITS ON ITS OWN CACHE LINE
+struct TokenQueue {
+    struct Token* tokens;
+    struct Lexer lexer;
+    pthread_t thread;
+
+    // WRITTEN BY THE LEXER
+    _Alignas(64) long head;
+    int finished;
+
+    // WRITTEN BY THE PARSER, stopped TELLS THE LEXER NOBODY READS ANY MORE
+    _Alignas(64) long tail;
+    int stopped;
+    long read_index;
+    // WHAT THE PARSER HAS SEEN OF head, SO IT ONLY READS THE SHARED ONE WHEN IT RUNS DRY
+    long visible_head;
+};
+
+void start_token_queue(struct TokenQueue* queue, const char* file_buff, long fsize);
+struct Token* token_queue_peek(struct TokenQueue* queue);
+struct Token* token_queue_next(struct TokenQueue* queue);
+void finish_token_queue(struct TokenQueue* queue);
+
+#endif
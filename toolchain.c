@@ -0,0 +1,66 @@
+#define _DEFAULT_SOURCE
+
+#include "toolchain.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+// THE MAKEFILE POINTS THIS AT THE CHECKOUT, QB_RUNTIME OVERRIDES IT AT RUNTIME
+#ifndef QB_RUNTIME_SOURCE
+#define QB_RUNTIME_SOURCE "runtime.c"
+#endif
+
+const char* get_runtime_source_path(void) {
+    const char* path = getenv("QB_RUNTIME");
+    return path != NULL && path[0] != 0 ? path : QB_RUNTIME_SOURCE;
+}
+
+int run_tool(const char* const* arguments) {
+    fflush(stdout);
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return -1;
+    }
+
+    if (pid == 0) {
+        execvp(arguments[0], (char* const*)arguments);
+        perror(arguments[0]);
+        _exit(127);
+    }
+
+    int status;
+    if (waitpid(pid, &status, 0) < 0) {
+        perror("waitpid");
+        return -1;
+    }
+
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+int link_native_program(const char* input_path, const char* output_path, const char* optimization_flag) {
+    // GENERATED C INCLUDES runtime.h, WHICH SITS NEXT TO runtime.c
+    const char* runtime_path = get_runtime_source_path();
+    char include_flag[4096] = "-I.";
+    const char* last_slash = strrchr(runtime_path, '/');
+    if (last_slash != NULL) {
+        snprintf(include_flag, sizeof(include_flag), "-I%.*s", (int)(last_slash - runtime_path), runtime_path);
+    }
+
+    const char* compiler = getenv("CC");
+    const char* arguments[] = {
+        compiler != NULL && compiler[0] != 0 ? compiler : "gcc",
+        optimization_flag,
+        include_flag,
+        "-o", output_path,
+        input_path,
+        runtime_path,
+        NULL,
+    };
+
+    return run_tool(arguments);
+}
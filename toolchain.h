@@ -0,0 +1,8 @@
+#ifndef TOOLCHAIN_H_
+#define TOOLCHAIN_H_
+
+const char* get_runtime_source_path(void);
+int run_tool(const char* const* arguments);
+int link_native_program(const char* input_path, const char* output_path, const char* optimization_flag);
+
+#endif
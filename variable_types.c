@@ -0,0 +1,442 @@
+#include "variable_types.h"
+#include "interner.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+#define ASSIGNED_BY_STATEMENT 1
+#define ASSIGNED_BY_FOR 2
+
+static int get_constant_bits(struct NumberValue value);
+static int combine_integer_bits(enum TokenType operator, int left_bits, int right_bits);
+static int bits_need_conversion(const struct VariableTypes* types, int slot, int bits);
+static void set_variable_type(struct VariableTypes* types, int slot, enum VariableType type, int* changed);
+static void collect_def_types(struct StatementsList* list, enum TokenType* letter_types);
+static void declare_variable(struct VariableTypes* types, int slot, const enum TokenType* letter_types);
+static void mark_assigned_variables(struct VariableTypes* types, struct StatementsList* list, int* assigned);
+static void infer_for_variables(struct VariableTypes* types, struct StatementsList* list, int* changed);
+static void infer_statements(struct VariableTypes* types, struct StatementsList* list, int* changed);
+
+enum VariableType get_expression_type(const struct VariableTypes* types, struct AstNode* node) {
+    switch (node->node_type)
+    {
+    case CONST_NUMBER_EXPRESSION:
+    case PREFIX_EXPRESSION:
+        return NUMBER_VARIABLE;
+    case CONST_STRING_EXPRESSION:
+        return STRING_VARIABLE;
+    case IDENTIFIER_EXPRESSION:
+        return types->types[node->identifier_expression.slot];
+    case INFIX_EXPRESSION: {
+        // ONLY '+' CAN PRODUCE A STRING
+        if (node->infix_expression.operator->token_type != PLUS) {
+            return NUMBER_VARIABLE;
+        }
+
+        enum VariableType type = get_expression_type(types, node->infix_expression.left);
+        return type != UNKNOWN_VARIABLE ? type : get_expression_type(types, node->infix_expression.right);
+    }
+    default:
+        printf("Node %d is not an expression \n", node->node_type);
+        exit(503);
+    }
+}
+
+static int get_constant_bits(struct NumberValue value) {
+    if (!is_integer_number(value)) {
+        return 0;
+    }
+
+    uint64_t magnitude = value.integer < 0 ? -(uint64_t)value.integer : (uint64_t)value.integer;
+    int bits = 1;
+    while (bits < 64 && (magnitude >> bits) != 0) {
+        bits++;
+    }
+
+    return bits;
+}
+
+static int combine_integer_bits(enum TokenType operator, int left_bits, int right_bits) {
+    switch (operator)
+    {
+    case PLUS:
+    case MINUS:
+        if (left_bits > 0 && right_bits > 0) {
+            return (left_bits > right_bits ? left_bits : right_bits) + 1;
+        }
+        return 0;
+    case ASTERISK:
+        if (left_bits > 0 && right_bits > 0) {
+            return left_bits + right_bits;
+        }
+        return 0;
+    case SLASH:
+        return 0;
+    default:
+        // RELATIONAL OPERATORS YIELD -1 OR 0
+        return 1;
+    }
+}
+
+// RETURNS n WHEN THE EXPRESSION IS ALWAYS AN INTEGER BELOW 2^n IN MAGNITUDE AND 0 WHEN IT MIGHT NOT BE
+int get_integer_bits(const struct VariableTypes* types, struct AstNode* node) {
+    int bits = 0;
+    switch (node->node_type)
+    {
+    case CONST_NUMBER_EXPRESSION:
+        bits = get_constant_bits(node->const_number_expression.value);
+        break;
+    case IDENTIFIER_EXPRESSION:
+        bits = types->integer_bits[node->identifier_expression.slot];
+        break;
+    case PREFIX_EXPRESSION:
+        bits = get_integer_bits(types, node->prefix_expression.value);
+        // NOT x IS -x - 1
+        if (bits > 0 && node->prefix_expression.operator->token_type == BANG) {
+            bits++;
+        }
+        break;
+    case INFIX_EXPRESSION: {
+        int left_bits = get_integer_bits(types, node->infix_expression.left);
+        int right_bits = get_integer_bits(types, node->infix_expression.right);
+        bits = combine_integer_bits(node->infix_expression.operator->token_type, left_bits, right_bits);
+        break;
+    }
+    default:
+        break;
+    }
+
+    return bits <= MAX_EXACT_INTEGER_BITS ? bits : 0;
+}
+
+// THE SAME AS get_integer_bits FOR A NODE OF THE FLAT AST
+int get_flat_integer_bits(const struct VariableTypes* types, const struct FlatAst* ast, int index) {
+    const struct FlatNode* node = &ast->nodes[index];
+    int bits = 0;
+    switch (node->node_type)
+    {
+    case CONST_NUMBER_EXPRESSION:
+        bits = get_constant_bits(ast->numbers[node->first]);
+        break;
+    case IDENTIFIER_EXPRESSION:
+        bits = types->integer_bits[node->first];
+        break;
+    case PREFIX_EXPRESSION:
+        bits = get_flat_integer_bits(types, ast, node->first);
+        if (bits > 0 && node->token_type == BANG) {
+            bits++;
+        }
+        break;
+    case INFIX_EXPRESSION: {
+        int left_bits = get_flat_integer_bits(types, ast, node->first);
+        int right_bits = get_flat_integer_bits(types, ast, node->second);
+        bits = combine_integer_bits((enum TokenType)node->token_type, left_bits, right_bits);
+        break;
+    }
+    default:
+        break;
+    }
+
+    return bits <= MAX_EXACT_INTEGER_BITS ? bits : 0;
+}
+
+int needs_number_conversion(const struct VariableTypes* types, int slot, struct AstNode* expression) {
+    return bits_need_conversion(types, slot, get_integer_bits(types, expression));
+}
+
+int needs_flat_number_conversion(const struct VariableTypes* types, int slot, const struct FlatAst* ast, int index) {
+    return bits_need_conversion(types, slot, get_flat_integer_bits(types, ast, index));
+}
+
+// 1 WHEN A VALUE OF bits INTEGER BITS, 0 MEANING ANY NUMBER, IS CONVERTED ON ITS WAY INTO slot
+static int bits_need_conversion(const struct VariableTypes* types, int slot, int bits) {
+    switch (types->number_types[slot])
+    {
+    case INTEGER_NUMBER:
+        return bits == 0 || bits > 15;
+    case LONG_NUMBER:
+        return bits == 0 || bits > 31;
+    case SINGLE_NUMBER:
+        // A FLOAT HOLDS EVERY INTEGER BELOW 2^24
+        return bits == 0 || bits > 24;
+    default:
+        return 0;
+    }
+}
+
+static void set_variable_type(struct VariableTypes* types, int slot, enum VariableType type, int* changed) {
+    enum VariableType current = types->types[slot];
+    if (type == UNKNOWN_VARIABLE || current == type) {
+        return;
+    }
+
+    if (current != UNKNOWN_VARIABLE) {
+        printf("Variable %s holds both numbers and strings, the native backends need one type \n",
+            get_slot_name(types->symbols, slot));
+        exit(501);
+    }
+
+    types->types[slot] = type;
+    *changed = 1;
+}
+
+static void collect_def_types(struct StatementsList* list, enum TokenType* letter_types) {
+    if (list == NULL) {
+        return;
+    }
+
+    // DEF STATEMENTS COVER THE WHOLE PROGRAM, A LATER ONE OVERRIDES AN EARLIER ONE FOR THE SAME LETTER
+    for (long i = 0;i < list->size;i++) {
+        struct AstNode* node = &list->statements[i];
+        switch (node->node_type)
+        {
+        case DEF_TYPE_STATEMENT:
+            for (int letter = 0;letter < 26;letter++) {
+                if (node->def_type_statement.letters & (1u << letter)) {
+                    letter_types[letter] = node->def_type_statement.token->token_type;
+                }
+            }
+            break;
+        case IF_STATEMENT:
+            collect_def_types(node->if_statement.body, letter_types);
+            collect_def_types(node->if_statement.elses, letter_types);
+            break;
+        case LOOP_STATEMENT:
+            collect_def_types(node->loop_statement.body, letter_types);
+            break;
+        case FOR_STATEMENT:
+            collect_def_types(node->for_statement.body, letter_types);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+static void declare_variable(struct VariableTypes* types, int slot, const enum TokenType* letter_types) {
+    const struct InternedIdentifier* identifier = get_interned_identifier(get_slot_identifier(types->symbols, slot));
+    enum TokenType declaration;
+    switch (identifier->name[identifier->length - 1])
+    {
+    case '%': declaration = DEFINT_KEYWORD; break;
+    case '&': declaration = DEFLNG_KEYWORD; break;
+    case '!': declaration = DEFSNG_KEYWORD; break;
+    case '#': declaration = DEFDBL_KEYWORD; break;
+    case '$': declaration = DEFSTR_KEYWORD; break;
+    default: declaration = letter_types[identifier->name[0] - 'a']; break;
+    }
+
+    // UNDECLARED VARIABLES STAY UNKNOWN AND ARE TYPED BY THEIR ASSIGNMENTS
+    switch (declaration)
+    {
+    case DEFINT_KEYWORD:
+        types->types[slot] = NUMBER_VARIABLE;
+        types->number_types[slot] = INTEGER_NUMBER;
+        // A FOR LOOP MAY STEP ONE PAST THE RANGE, NOTHING ELSE ESCAPES THE ASSIGNMENT CHECK
+        types->integer_bits[slot] = 16;
+        break;
+    case DEFLNG_KEYWORD:
+        types->types[slot] = NUMBER_VARIABLE;
+        types->number_types[slot] = LONG_NUMBER;
+        types->integer_bits[slot] = 32;
+        break;
+    case DEFSNG_KEYWORD:
+        types->types[slot] = NUMBER_VARIABLE;
+        types->number_types[slot] = SINGLE_NUMBER;
+        break;
+    case DEFDBL_KEYWORD:
+        types->types[slot] = NUMBER_VARIABLE;
+        break;
+    case DEFSTR_KEYWORD:
+        types->types[slot] = STRING_VARIABLE;
+        break;
+    default:
+        break;
+    }
+}
+
+// THE CONTROL VALUE STAYS BETWEEN THE INITIAL VALUE AND ONE STEP PAST THE END,
+// SO INTEGER BOUNDS KEEP A VARIABLE ONLY FOR LOOPS ASSIGN IN THE INTEGERS
+static void infer_for_variables(struct VariableTypes* types, struct StatementsList* list, int* changed) {
+    if (list == NULL) {
+        return;
+    }
+
+    for (long i = 0;i < list->size;i++) {
+        struct AstNode* node = &list->statements[i];
+        switch (node->node_type)
+        {
+        case IF_STATEMENT:
+            infer_for_variables(types, node->if_statement.body, changed);
+            infer_for_variables(types, node->if_statement.elses, changed);
+            break;
+        case LOOP_STATEMENT:
+            infer_for_variables(types, node->loop_statement.body, changed);
+            break;
+        case FOR_STATEMENT: {
+            struct ForStatement* statement = &node->for_statement;
+            int slot = statement->control_identifier_expression->identifier_expression.slot;
+            if (types->types[slot] == UNKNOWN_VARIABLE && types->integer_bits[slot] > 0) {
+                int initial_bits = get_integer_bits(types, statement->initial_expression);
+                int end_bits = get_integer_bits(types, statement->end_value_expression);
+                int step_bits = statement->step_expression != NULL ? get_integer_bits(types, statement->step_expression) : 1;
+
+                int bits = (end_bits > step_bits ? end_bits : step_bits) + 1;
+                bits = initial_bits > bits ? initial_bits : bits;
+                if (initial_bits == 0 || end_bits == 0 || step_bits == 0 || bits > MAX_EXACT_INTEGER_BITS) {
+                    types->integer_bits[slot] = 0;
+                    *changed = 1;
+                } else if (bits > types->integer_bits[slot]) {
+                    types->integer_bits[slot] = bits;
+                    *changed = 1;
+                }
+            }
+
+            infer_for_variables(types, statement->body, changed);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+}
+
+static void mark_assigned_variables(struct VariableTypes* types, struct StatementsList* list, int* assigned) {
+    if (list == NULL) {
+        return;
+    }
+
+    for (long i = 0;i < list->size;i++) {
+        struct AstNode* node = &list->statements[i];
+        switch (node->node_type)
+        {
+        case ASSIGN_STATEMENT:
+            assigned[node->assign_statement.identifier->identifier_expression.slot] |= ASSIGNED_BY_STATEMENT;
+            break;
+        case IF_STATEMENT:
+            mark_assigned_variables(types, node->if_statement.body, assigned);
+            mark_assigned_variables(types, node->if_statement.elses, assigned);
+            break;
+        case LOOP_STATEMENT:
+            mark_assigned_variables(types, node->loop_statement.body, assigned);
+            break;
+        case FOR_STATEMENT:
+            assigned[node->for_statement.control_identifier_expression->identifier_expression.slot] |= ASSIGNED_BY_FOR;
+            mark_assigned_variables(types, node->for_statement.body, assigned);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+static void infer_statements(struct VariableTypes* types, struct StatementsList* list, int* changed) {
+    if (list == NULL) {
+        return;
+    }
+
+    for (long i = 0;i < list->size;i++) {
+        struct AstNode* node = &list->statements[i];
+        switch (node->node_type)
+        {
+        case ASSIGN_STATEMENT:
+            set_variable_type(types, node->assign_statement.identifier->identifier_expression.slot,
+                get_expression_type(types, node->assign_statement.expression), changed);
+            break;
+        case IF_STATEMENT:
+            infer_statements(types, node->if_statement.body, changed);
+            infer_statements(types, node->if_statement.elses, changed);
+            break;
+        case LOOP_STATEMENT:
+            infer_statements(types, node->loop_statement.body, changed);
+            break;
+        case FOR_STATEMENT:
+            set_variable_type(types, node->for_statement.control_identifier_expression->identifier_expression.slot,
+                NUMBER_VARIABLE, changed);
+            infer_statements(types, node->for_statement.body, changed);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+struct VariableTypes declare_variable_types(struct Program* program) {
+    struct VariableTypes result;
+    struct VariableTypes* types = &result;
+    types->symbols = &program->symbols;
+    types->count = program->symbols.slot_count;
+    types->types = (enum VariableType*)calloc(types->count + 1, sizeof(enum VariableType));
+    types->number_types = (enum NumberType*)malloc((types->count + 1) * sizeof(enum NumberType));
+    types->integer_bits = (int*)calloc(types->count + 1, sizeof(int));
+
+    enum TokenType letter_types[26];
+    for (int i = 0;i < 26;i++) {
+        letter_types[i] = UNQUOTED_STRING;
+    }
+    collect_def_types(program->list, letter_types);
+
+    for (int i = 0;i < types->count;i++) {
+        types->number_types[i] = DOUBLE_NUMBER;
+        declare_variable(types, i, letter_types);
+    }
+
+    // UNDECLARED VARIABLES THAT ONLY FOR LOOPS ASSIGN START OUT AS INTEGERS, BOUNDS THAT
+    // ARE NOT INTEGERS OR THAT GROW PAST THE EXACT RANGE DROP THEM BACK TO DOUBLES
+    int* assigned = (int*)calloc(types->count + 1, sizeof(int));
+    mark_assigned_variables(types, program->list, assigned);
+    for (int i = 0;i < types->count;i++) {
+        if (types->types[i] == UNKNOWN_VARIABLE && assigned[i] == ASSIGNED_BY_FOR) {
+            types->integer_bits[i] = 1;
+        }
+    }
+    free(assigned);
+
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        infer_for_variables(types, program->list, &changed);
+    }
+
+    return result;
+}
+
+struct VariableTypes infer_variable_types(struct Program* program) {
+    struct VariableTypes result = declare_variable_types(program);
+    struct VariableTypes* types = &result;
+
+    // A VARIABLE THAT IS NEVER ASSIGNED READS AS 0, EVERY OTHER ONE TAKES THE TYPE OF ITS ASSIGNMENTS
+    int* assigned = (int*)calloc(types->count + 1, sizeof(int));
+    mark_assigned_variables(types, program->list, assigned);
+    for (int i = 0;i < types->count;i++) {
+        if (!assigned[i] && types->types[i] == UNKNOWN_VARIABLE) {
+            types->types[i] = NUMBER_VARIABLE;
+        }
+    }
+    free(assigned);
+
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        infer_statements(types, program->list, &changed);
+    }
+
+    // ONLY VARIABLES ASSIGNED FROM EACH OTHER ARE LEFT, THEY START AS 0 TOO
+    for (int i = 0;i < types->count;i++) {
+        if (types->types[i] == UNKNOWN_VARIABLE) {
+            types->types[i] = NUMBER_VARIABLE;
+        }
+    }
+
+    return result;
+}
+
+void free_variable_types(struct VariableTypes* types) {
+    free(types->types);
+    free(types->number_types);
+    free(types->integer_bits);
+    types->types = NULL;
+    types->number_types = NULL;
+    types->integer_bits = NULL;
+    types->symbols = NULL;
+    types->count = 0;
+}
@@ -0,0 +1,38 @@
+#ifndef VARIABLE_TYPES_H_
+#define VARIABLE_TYPES_H_
+
+#include "parser.h"
+#include "flat_ast.h"
+
+// THE NATIVE BACKENDS HAVE NO TAGGED VALUES, SO EVERY VARIABLE GETS ONE TYPE FOR THE WHOLE PROGRAM
+enum VariableType {
+    UNKNOWN_VARIABLE,
+    NUMBER_VARIABLE,
+    STRING_VARIABLE,
+};
+
+// A DOUBLE HOLDS EVERY INTEGER BELOW 2^53 EXACTLY, SO INTEGER ARITHMETIC
+// BELOW THAT BOUND GIVES THE SAME RESULTS AS THE FLOATING POINT ONE
+#define MAX_EXACT_INTEGER_BITS 53
+
+// INDEXED BY THE SLOTS OF THE PROGRAM'S SYMBOL TABLE
+struct VariableTypes {
+    const struct SymbolTable* symbols;
+    enum VariableType* types;
+    // HOW AN ASSIGNMENT CONVERTS ITS VALUE: INTEGER AND LONG ROUND AND CHECK THE RANGE, SINGLE ROUNDS
+    enum NumberType* number_types;
+    // n > 0 WHEN THE VARIABLE ONLY EVER HOLDS INTEGERS BELOW 2^n IN MAGNITUDE
+    int* integer_bits;
+    int count;
+};
+
+struct VariableTypes declare_variable_types(struct Program* program);
+struct VariableTypes infer_variable_types(struct Program* program);
+enum VariableType get_expression_type(const struct VariableTypes* types, struct AstNode* node);
+int get_integer_bits(const struct VariableTypes* types, struct AstNode* node);
+int needs_number_conversion(const struct VariableTypes* types, int slot, struct AstNode* expression);
+int get_flat_integer_bits(const struct VariableTypes* types, const struct FlatAst* ast, int index);
+int needs_flat_number_conversion(const struct VariableTypes* types, int slot, const struct FlatAst* ast, int index);
+void free_variable_types(struct VariableTypes* types);
+
+#endif
@@ -0,0 +1,390 @@
+#include "vm.h"
+#include "arena.h"
+#include "jit.h"
+#include "numbers.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+// GCC AND CLANG DISPATCH THROUGH A TABLE OF LABEL ADDRESSES, BUILD WITH
+// -DVM_SWITCH_DISPATCH TO FORCE THE PORTABLE SWITCH LOOP
+#if defined(__GNUC__) && !defined(VM_SWITCH_DISPATCH)
+#define VM_COMPUTED_GOTO 1
+#endif
+
+#define PRINT_ZONE_WIDTH 14
+
+struct VM {
+    const struct Chunk* chunk;
+    struct Value* slots;
+    struct Value* stack;
+    struct Arena* strings;
+    long output_column;
+    struct Jit* jit;
+};
+
+static void print_output_value(struct VM* vm, const struct Value* value);
+static int values_equal(const struct Value* left, const struct Value* right);
+static int compare_values(const struct Value* left, const struct Value* right);
+static struct Value concatenate_strings(struct VM* vm, const struct Value* left, const struct Value* right);
+static int runtime_error(const char* message);
+static int execute(struct VM* vm);
+
+static void print_output_value(struct VM* vm, const struct Value* value) {
+    if (value->type == STRING_VALUE) {
+        fwrite(value->string.chars, 1, value->string.length, stdout);
+
+        const char* last_new_line = memchr(value->string.chars, '\n', value->string.length);
+        vm->output_column = last_new_line == NULL
+            ? vm->output_column + value->string.length
+            : value->string.chars + value->string.length - last_new_line - 1;
+        return;
+    }
+
+    // NUMBERS GET A LEADING SPACE IN PLACE OF THE SIGN AND A TRAILING SPACE,
+    // NEGATIVE ZERO PRINTS AS 0
+    double number = value->number == 0 ? 0 : value->number;
+    int printed = printf(number < 0 ? "%.15g " : " %.15g ", number);
+    vm->output_column += printed;
+}
+
+static int values_equal(const struct Value* left, const struct Value* right) {
+    if (left->type == STRING_VALUE) {
+        return left->string.length == right->string.length &&
+            memcmp(left->string.chars, right->string.chars, left->string.length) == 0;
+    }
+
+    return left->number == right->number;
+}
+
+static int compare_values(const struct Value* left, const struct Value* right) {
+    if (left->type == STRING_VALUE) {
+        long length = left->string.length < right->string.length ? left->string.length : right->string.length;
+        int result = memcmp(left->string.chars, right->string.chars, length);
+        if (result != 0) {
+            return result;
+        }
+
+        return (left->string.length > right->string.length) - (left->string.length < right->string.length);
+    }
+
+    return (left->number > right->number) - (left->number < right->number);
+}
+
+static struct Value concatenate_strings(struct VM* vm, const struct Value* left, const struct Value* right) {
+    long length = left->string.length + right->string.length;
+    char* chars = (char*)arena_alloc(vm->strings, length);
+    memcpy(chars, left->string.chars, left->string.length);
+    memcpy(chars + left->string.length, right->string.chars, right->string.length);
+
+    struct Value value;
+    value.type = STRING_VALUE;
+    value.string.chars = chars;
+    value.string.length = length;
+
+    return value;
+}
+
+static int runtime_error(const char* message) {
+    fflush(stdout);
+    fprintf(stderr, "Runtime error: %s \n", message);
+    return 1;
+}
+
+#ifdef VM_COMPUTED_GOTO
+#define DISPATCH() __extension__ ({ goto *dispatch_table[*ip++]; })
+#define CASE(op) label_##op:
+#else
+#define DISPATCH() continue
+#define CASE(op) case op:
+#endif
+
+#define READ_OPERAND() (ip += sizeof(int32_t), read_operand(ip - sizeof(int32_t)))
+#define POP() (--sp)
+#define PUSH(value) (*sp++ = (value))
+#define TOP() (sp[-1])
+
+#define REQUIRE_NUMBERS(left, right)                                            \
+    if ((left).type != NUMBER_VALUE || (right).type != NUMBER_VALUE) {          \
+        return runtime_error("Type mismatch");                                  \
+    }
+
+#define REQUIRE_SAME_TYPE(left, right)                                          \
+    if ((left).type != (right).type) {                                          \
+        return runtime_error("Type mismatch");                                  \
+    }
+
+// EVERY BACK EDGE FEEDS THE JIT, ONCE THE LOOP IS HOT IT RUNS AS MACHINE CODE AND
+// THE INTERPRETER PICKS UP AFTER THE BACK EDGE. jit_back_edge() RETURNS NULL
+// UNTIL THEN, AND FOR LOOPS IT CANNOT COMPILE
+#define ENTER_HOT_LOOP(back_edge, loop_start)                                   \
+    if (vm->jit != NULL) {                                                      \
+        JitFunction function = jit_back_edge(vm->jit, (back_edge), (loop_start)); \
+        if (function != NULL) {                                                 \
+            enum JitStatus status = function(slots);                            \
+            if (status == JIT_DIVISION_BY_ZERO) {                               \
+                return runtime_error("Division by zero");                       \
+            }                                                                   \
+            if (status == JIT_OVERFLOW) {                                       \
+                return runtime_error("Overflow");                               \
+            }                                                                   \
+            if (status == JIT_LOOP_EXITED) {                                    \
+                ip = code + (back_edge) + 1 + get_operand_count(code[back_edge]) * sizeof(int32_t); \
+            }                                                                   \
+        }                                                                       \
+    }
+
+#define COMPARISON(test)                                                        \
+    {                                                                           \
+        struct Value* right = POP();                                            \
+        struct Value* left = &TOP();                                            \
+        REQUIRE_SAME_TYPE(*left, *right);                                       \
+        int result = compare_values(left, right);                               \
+        left->type = NUMBER_VALUE;                                              \
+        left->number = (test) ? -1 : 0;                                         \
+        DISPATCH();                                                             \
+    }
+
+static int execute(struct VM* vm) {
+    const uint8_t* code = vm->chunk->code;
+    const uint8_t* ip = code;
+    const struct Value* constants = vm->chunk->constants;
+    struct Value* slots = vm->slots;
+    struct Value* sp = vm->stack;
+
+#ifdef VM_COMPUTED_GOTO
+    // verify_chunk() HAS ALREADY REJECTED OPCODES WITHOUT AN ENTRY
+    __extension__ static const void* dispatch_table[OP_HALT + 1] = {
+        [OP_CONSTANT] = &&label_OP_CONSTANT,
+        [OP_LOAD] = &&label_OP_LOAD,
+        [OP_STORE] = &&label_OP_STORE,
+        [OP_ADD] = &&label_OP_ADD,
+        [OP_SUBTRACT] = &&label_OP_SUBTRACT,
+        [OP_MULTIPLY] = &&label_OP_MULTIPLY,
+        [OP_DIVIDE] = &&label_OP_DIVIDE,
+        [OP_NEGATE] = &&label_OP_NEGATE,
+        [OP_NOT] = &&label_OP_NOT,
+        [OP_CONVERT] = &&label_OP_CONVERT,
+        [OP_EQUALS] = &&label_OP_EQUALS,
+        [OP_NOT_EQUALS] = &&label_OP_NOT_EQUALS,
+        [OP_GREATER] = &&label_OP_GREATER,
+        [OP_GREATER_EQUALS] = &&label_OP_GREATER_EQUALS,
+        [OP_LESSER] = &&label_OP_LESSER,
+        [OP_LESSER_EQUALS] = &&label_OP_LESSER_EQUALS,
+        [OP_JUMP] = &&label_OP_JUMP,
+        [OP_JUMP_IF_FALSE] = &&label_OP_JUMP_IF_FALSE,
+        [OP_JUMP_IF_TRUE] = &&label_OP_JUMP_IF_TRUE,
+        [OP_FOR_TEST] = &&label_OP_FOR_TEST,
+        [OP_FOR_STEP] = &&label_OP_FOR_STEP,
+        [OP_PRINT] = &&label_OP_PRINT,
+        [OP_PRINT_ZONE] = &&label_OP_PRINT_ZONE,
+        [OP_PRINT_NEW_LINE] = &&label_OP_PRINT_NEW_LINE,
+        [OP_HALT] = &&label_OP_HALT,
+    };
+
+    DISPATCH();
+#else
+    while (1) {
+        switch (*ip++) {
+#endif
+
+    CASE(OP_CONSTANT) {
+        PUSH(constants[READ_OPERAND()]);
+        DISPATCH();
+    }
+    CASE(OP_LOAD) {
+        PUSH(slots[READ_OPERAND()]);
+        DISPATCH();
+    }
+    CASE(OP_STORE) {
+        slots[READ_OPERAND()] = *POP();
+        DISPATCH();
+    }
+    CASE(OP_ADD) {
+        struct Value* right = POP();
+        struct Value* left = &TOP();
+        REQUIRE_SAME_TYPE(*left, *right);
+        if (left->type == STRING_VALUE) {
+            *left = concatenate_strings(vm, left, right);
+        } else {
+            left->number += right->number;
+        }
+        DISPATCH();
+    }
+    CASE(OP_SUBTRACT) {
+        struct Value* right = POP();
+        struct Value* left = &TOP();
+        REQUIRE_NUMBERS(*left, *right);
+        left->number -= right->number;
+        DISPATCH();
+    }
+    CASE(OP_MULTIPLY) {
+        struct Value* right = POP();
+        struct Value* left = &TOP();
+        REQUIRE_NUMBERS(*left, *right);
+        left->number *= right->number;
+        DISPATCH();
+    }
+    CASE(OP_DIVIDE) {
+        struct Value* right = POP();
+        struct Value* left = &TOP();
+        REQUIRE_NUMBERS(*left, *right);
+        if (right->number == 0) {
+            return runtime_error("Division by zero");
+        }
+        left->number /= right->number;
+        DISPATCH();
+    }
+    CASE(OP_NEGATE) {
+        if (TOP().type != NUMBER_VALUE) {
+            return runtime_error("Type mismatch");
+        }
+        TOP().number = -TOP().number;
+        DISPATCH();
+    }
+    CASE(OP_NOT) {
+        if (TOP().type != NUMBER_VALUE) {
+            return runtime_error("Type mismatch");
+        }
+        TOP().number = (double)~(long long)TOP().number;
+        DISPATCH();
+    }
+    CASE(OP_CONVERT) {
+        enum NumberType type = (enum NumberType)READ_OPERAND();
+        if (TOP().type != NUMBER_VALUE) {
+            return runtime_error("Type mismatch");
+        }
+        if (!convert_number(TOP().number, type, &TOP().number)) {
+            return runtime_error("Overflow");
+        }
+        DISPATCH();
+    }
+    CASE(OP_EQUALS) {
+        struct Value* right = POP();
+        struct Value* left = &TOP();
+        REQUIRE_SAME_TYPE(*left, *right);
+        int equal = values_equal(left, right);
+        left->type = NUMBER_VALUE;
+        left->number = equal ? -1 : 0;
+        DISPATCH();
+    }
+    CASE(OP_NOT_EQUALS) {
+        struct Value* right = POP();
+        struct Value* left = &TOP();
+        REQUIRE_SAME_TYPE(*left, *right);
+        int equal = values_equal(left, right);
+        left->type = NUMBER_VALUE;
+        left->number = equal ? 0 : -1;
+        DISPATCH();
+    }
+    CASE(OP_GREATER) COMPARISON(result > 0)
+    CASE(OP_GREATER_EQUALS) COMPARISON(result >= 0)
+    CASE(OP_LESSER) COMPARISON(result < 0)
+    CASE(OP_LESSER_EQUALS) COMPARISON(result <= 0)
+    CASE(OP_JUMP) {
+        long back_edge = ip - 1 - code;
+        int32_t target = read_operand(ip);
+        ip = code + target;
+        if (target < back_edge) {
+            ENTER_HOT_LOOP(back_edge, target);
+        }
+        DISPATCH();
+    }
+    CASE(OP_JUMP_IF_FALSE) {
+        struct Value* condition = POP();
+        if (condition->type != NUMBER_VALUE) {
+            return runtime_error("Type mismatch");
+        }
+        ip = condition->number == 0 ? code + read_operand(ip) : ip + sizeof(int32_t);
+        DISPATCH();
+    }
+    CASE(OP_JUMP_IF_TRUE) {
+        struct Value* condition = POP();
+        if (condition->type != NUMBER_VALUE) {
+            return runtime_error("Type mismatch");
+        }
+        ip = condition->number != 0 ? code + read_operand(ip) : ip + sizeof(int32_t);
+        DISPATCH();
+    }
+    CASE(OP_FOR_TEST) {
+        struct Value* control = &slots[READ_OPERAND()];
+        struct Value* end = &slots[READ_OPERAND()];
+        int32_t exit_target = READ_OPERAND();
+        struct Value* step = end + 1;
+        REQUIRE_NUMBERS(*control, *end);
+        REQUIRE_NUMBERS(*step, *end);
+
+        int finished = step->number >= 0 ? control->number > end->number : control->number < end->number;
+        if (finished) {
+            ip = code + exit_target;
+        }
+        DISPATCH();
+    }
+    CASE(OP_FOR_STEP) {
+        long back_edge = ip - 1 - code;
+        struct Value* control = &slots[READ_OPERAND()];
+        struct Value* step = &slots[READ_OPERAND()];
+        int32_t loop_start = READ_OPERAND();
+        REQUIRE_NUMBERS(*control, *step);
+
+        control->number += step->number;
+        ip = code + loop_start;
+        ENTER_HOT_LOOP(back_edge, loop_start);
+        DISPATCH();
+    }
+    CASE(OP_PRINT) {
+        print_output_value(vm, POP());
+        DISPATCH();
+    }
+    CASE(OP_PRINT_ZONE) {
+        long padding = PRINT_ZONE_WIDTH - vm->output_column % PRINT_ZONE_WIDTH;
+        printf("%*s", (int)padding, "");
+        vm->output_column += padding;
+        DISPATCH();
+    }
+    CASE(OP_PRINT_NEW_LINE) {
+        putchar('\n');
+        vm->output_column = 0;
+        DISPATCH();
+    }
+    CASE(OP_HALT) {
+        return 0;
+    }
+
+#ifndef VM_COMPUTED_GOTO
+        }
+    }
+#endif
+}
+
+int run_chunk(const struct Chunk* chunk, int use_jit) {
+    if (!verify_chunk(chunk)) {
+        return runtime_error("Invalid bytecode");
+    }
+
+    struct VM vm;
+    vm.chunk = chunk;
+    vm.slots = (struct Value*)calloc(chunk->slot_count + 1, sizeof(struct Value));
+    vm.stack = (struct Value*)malloc((chunk->max_stack_depth + 1) * sizeof(struct Value));
+    vm.strings = new_arena(0);
+    vm.output_column = 0;
+    vm.jit = use_jit && is_jit_supported() ? new_jit(chunk) : NULL;
+
+    // UNASSIGNED VARIABLES READ AS ZERO
+    for (int i = 0;i < chunk->slot_count;i++) {
+        vm.slots[i].type = NUMBER_VALUE;
+        vm.slots[i].number = 0;
+    }
+
+    int status = execute(&vm);
+    fflush(stdout);
+
+    free(vm.slots);
+    free(vm.stack);
+    free_arena(vm.strings);
+    if (vm.jit != NULL) {
+        free_jit(vm.jit);
+    }
+
+    return status;
+}
@@ -0,0 +1,8 @@
+#ifndef VM_H_
+#define VM_H_
+
+#include "bytecode.h"
+
+int run_chunk(const struct Chunk* chunk, int use_jit);
+
+#endif